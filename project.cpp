@@ -1,5 +1,58 @@
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <climits>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#include <immintrin.h>
+#define BOUNDS_AVX2
+#elif defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BOUNDS_SSE2
+#endif
 
 using namespace std;
 
@@ -13,6 +66,7 @@ private:
   T *dataPtr;
   Node<T> *next;
   Node<T> *prev;
+  const void *owner; //list that holds the node
 
 public:
   class Exception : public std::exception
@@ -35,6 +89,10 @@ public:
 
   Node();
   Node(const T &);
+  Node(T &&);
+  template <class... Args>
+  Node(in_place_t, Args &&...);
+  Node(const Node<T> &) = delete;
 
   ~Node();
 
@@ -42,24 +100,27 @@ public:
   T &getData() const;
   Node<T> *getNext() const;
   Node<T> *getPrev() const;
+  const void *getOwner() const;
 
   void setDataPtr(T *);
   void setData(const T &);
   void setNext(Node *);
   void setPrev(Node *);
+  void setOwner(const void *);
 };
 
 template <class T>
-Node<T>::Node() : next(nullptr), prev(nullptr), dataPtr(nullptr) {}
+Node<T>::Node() : dataPtr(nullptr), next(nullptr), prev(nullptr), owner(nullptr) {}
 
 template <class T>
-Node<T>::Node(const T &e) : dataPtr(new T(e)), prev(nullptr), next(nullptr)
-{
-  if (dataPtr == nullptr)
-  {
-    throw Exception("Memoria insuficiente, creando nodo");
-  }
-}
+Node<T>::Node(const T &e) : data(e), dataPtr(&data), next(nullptr), prev(nullptr), owner(nullptr) {} //payload stored inline
+
+template <class T>
+Node<T>::Node(T &&e) : data(std::move(e)), dataPtr(&data), next(nullptr), prev(nullptr), owner(nullptr) {}
+
+template <class T>
+template <class... Args>
+Node<T>::Node(in_place_t, Args &&...args) : data(std::forward<Args>(args)...), dataPtr(&data), next(nullptr), prev(nullptr), owner(nullptr) {}
 
 template <class T>
 T *&Node<T>::getDataPtr()
@@ -70,7 +131,10 @@ T *&Node<T>::getDataPtr()
 template <class T>
 Node<T>::~Node()
 {
-  delete dataPtr;
+  if (dataPtr != &data)
+  {
+    delete dataPtr;
+  }
   prev = nullptr;
   next = nullptr;
 }
@@ -97,6 +161,12 @@ Node<T> *Node<T>::getPrev() const
   return prev;
 }
 
+template <class T>
+const void *Node<T>::getOwner() const
+{
+  return owner;
+}
+
 template <class T>
 void Node<T>::setDataPtr(T *p)
 {
@@ -108,10 +178,8 @@ void Node<T>::setData(const T &e)
 {
   if (dataPtr == nullptr)
   {
-    if ((dataPtr = new T(e)) == nullptr)
-    {
-      throw Exception("Memoria no disponible, setData");
-    }
+    data = e;
+    dataPtr = &data;
   }
   else
   {
@@ -131,25 +199,225 @@ void Node<T>::setPrev(Node *p)
   prev = p;
 }
 
-//* -------- ------- ------ ----- List ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+template <class T>
+void Node<T>::setOwner(const void *p)
+{
+  owner = p;
+}
+
+//* -------- ------- ------ ----- Node Allocators ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
 
 // -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Allocation policies for List<T, Allocator>: create(args) builds a node whose payload is T(args), destroy(node) releases it
+
+template <class T>
+class NodePool //slabs of nodes with the payload inline, freed nodes are recycled
+{
+private:
+  static const size_t firstSlab{64};
+  static const size_t lastSlab{4096};
+
+  union Slot
+  {
+    Slot *next;
+    alignas(Node<T>) char node[sizeof(Node<T>)];
+  };
+
+  vector<Slot *> slabs;
+  Slot *freeSlots;
+  size_t used;
+  size_t capacity;
+  size_t allocations;
+
+public:
+  NodePool();
+  NodePool(const NodePool<T> &);
+  ~NodePool();
+
+  template <class... Args>
+  Node<T> *create(Args &&...);
+  void destroy(Node<T> *);
+
+  size_t getAllocations() const;
+
+  NodePool<T> &operator=(const NodePool<T> &);
+};
+
+template <class T>
+class NodeHeap //one heap block for the node and another one for the payload
+{
+private:
+  size_t allocations;
+
+public:
+  NodeHeap();
+
+  template <class... Args>
+  Node<T> *create(Args &&...);
+  void destroy(Node<T> *);
+
+  size_t getAllocations() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+template <class T>
+NodePool<T>::NodePool() : freeSlots(nullptr), used(0), capacity(0), allocations(0) {}
+
+template <class T>
+NodePool<T>::NodePool(const NodePool<T> &) : NodePool() {} //nodes are never shared between pools
+
+template <class T>
+NodePool<T>::~NodePool()
+{
+  for (Slot *slab : slabs)
+  {
+    ::operator delete(slab);
+  }
+}
+
+template <class T>
+template <class... Args>
+Node<T> *NodePool<T>::create(Args &&...args)
+{
+  Slot *slot;
+
+  if (freeSlots != nullptr)
+  {
+    slot = freeSlots;
+    freeSlots = freeSlots->next;
+  }
+  else
+  {
+    if (used == capacity)
+    {
+      capacity = slabs.empty() ? firstSlab : min(capacity * 2, lastSlab);
+      slabs.push_back(static_cast<Slot *>(::operator new(capacity * sizeof(Slot))));
+      allocations++;
+      used = 0;
+    }
+    slot = slabs.back() + used++;
+  }
+
+  try
+  {
+    return new (slot->node) Node<T>(in_place, std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    slot->next = freeSlots;
+    freeSlots = slot;
+    throw;
+  }
+}
+
+template <class T>
+void NodePool<T>::destroy(Node<T> *node)
+{
+  Slot *slot{reinterpret_cast<Slot *>(node)};
+
+  node->~Node<T>();
+  slot->next = freeSlots;
+  freeSlots = slot;
+}
+
+template <class T>
+size_t NodePool<T>::getAllocations() const
+{
+  return allocations;
+}
+
+template <class T>
+NodePool<T> &NodePool<T>::operator=(const NodePool<T> &)
+{
+  return *this;
+}
+
+template <class T>
+NodeHeap<T>::NodeHeap() : allocations(0) {}
+
+template <class T>
+template <class... Args>
+Node<T> *NodeHeap<T>::create(Args &&...args)
+{
+  Node<T> *node{new Node<T>()};
+  try
+  {
+    node->setDataPtr(new T(std::forward<Args>(args)...));
+  }
+  catch (...)
+  {
+    delete node;
+    throw;
+  }
+  allocations += 2;
+  return node;
+}
+
+template <class T>
+void NodeHeap<T>::destroy(Node<T> *node)
+{
+  delete node;
+}
 
 template <class T>
+size_t NodeHeap<T>::getAllocations() const
+{
+  return allocations;
+}
+
+//* -------- ------- ------ ----- List ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+
+template <class T, class Allocator = NodePool<T>>
 class List
 {
 private:
   Node<T> *anchor;
+  Node<T> *tail;
+  size_t count;
+  uint64_t version; //list instance in the high half, number of changes in the low half
+
+  static atomic<uint32_t> instances;
+
+  bool indexed;
+  unordered_multimap<string, Node<T> *> index; //name -> position
+  Allocator allocator;
+
+  mutable shared_mutex access; //never copied
+
+  void indexErase(Node<T> *);
 
   bool isValidPosition(Node<T> *);
-  void copyAll(const List<T> &);
-  void swapData(Node<T> *, Node<T> *);
+  Node<T> *link(Node<T> *, Node<T> *); //new node, position
+  void copyAll(const List<T, Allocator> &);
   Node<T> *getHalf(Node<T> *, Node<T> *);
   static int compare(const T &a, const T &b);
 
 public:
   typedef Node<T> *Position;
 
+  // What the listener is told after each change. REMOVED comes once the node is unlinked but before it is freed,
+  // RESET (with no node) when the whole content was replaced or deleted
+  enum Change
+  {
+    INSERTED,
+    UPDATED,
+    REMOVED,
+    SORTED,
+    RESET
+  };
+  typedef void (*Listener)(void *, const Change &, Node<T> *); //owner, change, position
+
+private:
+  Listener listener; //one per list, copies start without it
+  void *listenerOwner;
+
+  void notify(const Change &, Node<T> *);
+
+public:
+
   class Exception : public std::exception
   {
   private:
@@ -169,17 +437,33 @@ public:
   };
 
   List();
-  List(const List<T> &);
+  List(const List<T, Allocator> &);
 
   ~List();
 
   bool isEmpty() const;
+  size_t size() const;
+  uint64_t getVersion() const; //differs whenever nodes are added, removed, renamed, touched or reordered
 
-  void insert(const T &, Node<T> *); //data, positon
-  void remove(Node<T> *);
+  void setListener(Listener, void *); //listener, owner
+  void *getListenerOwner() const;
+  void touch(Node<T> *); //tells the listener that the data at position was edited in place
 
-  Node<T> *getFirst();
-  Node<T> *getLast();
+  // The list never takes it by itself: threads sharing a list hold it shared for walks and searches and unique for
+  // changes, positions handed out stay valid only while it is held
+  shared_mutex &getMutex() const;
+
+  void insert(const T &, Node<T> *); //data, positon
+  void insert(T &&, Node<T> *);
+  Node<T> *insertUnchecked(const T &, Node<T> *); //position must belong to this list
+  Node<T> *insertUnchecked(T &&, Node<T> *);
+  template <class... Args>
+  Node<T> *emplace(Node<T> *, Args &&...); //builds T(args) in place after position
+  void remove(Node<T> *); //the position is freed, it and every copy of it are invalid afterwards
+
+  Node<T> *getFirst() const;
+  Node<T> *getLast() const;
+  Node<T> *back();
   Node<T> *getPreviousPos(Node<T> *);
   Node<T> *getNextPos(Node<T> *);
 
@@ -187,30 +471,44 @@ public:
   Node<T> *binarySearch(const T &, int (*comp)(const T &, const T &) = List::compare);
   Node<T> *binarySearch(const T &, Node<T> *first, Node<T> *last, int (*comp)(const T &, const T &) = List::compare);
 
+  void setIndexed(const bool &);
+  bool isIndexed() const;
+  Node<T> *searchByName(const string &) const;
+  void rename(Node<T> *, const string &);
+
   T recover(Node<T> *);
 
-  void bubbleSort();
-  void bubbleSort(Node<T> *);
+  void sort(int (*comp)(const T &, const T &) = List::compare); //stable, relinks nodes
 
   std::string toString() const;
 
   void deleteAll();
 
-  List<T> &operator=(const List<T> &);
+  const Allocator &getAllocator() const;
+
+  List<T, Allocator> &operator=(const List<T, Allocator> &);
 };
 
 // -------- ------- ------ ----- Implementation ----- ------ ------- --------
 using namespace std;
 
-template <class T>
-bool List<T>::isValidPosition(Node<T> *position)
+// Tells the nodes of this list from null and from the nodes of other lists by reading the owner of the node, so the
+// position must be a live node. A removed position is freed memory and is not caught: its slot may already hold
+// another node of this list
+template <class T, class Allocator>
+bool List<T, Allocator>::isValidPosition(Node<T> *position)
 {
+#ifdef LIST_DEBUG_POSITIONS //full walk, reads the position only once it is found in the list
   Node<T> *aux{anchor};
 
   while (aux != nullptr)
   {
     if (aux == position)
     {
+      if (position->getOwner() != this)
+      {
+        throw Exception("Propietario inconsistente, isValidPosition");
+      }
       return true;
     }
 
@@ -218,10 +516,13 @@ bool List<T>::isValidPosition(Node<T> *position)
   }
 
   return false;
+#else
+  return position != nullptr and position->getOwner() == this;
+#endif
 }
 
-template <class T>
-void List<T>::copyAll(const List<T> &newList)
+template <class T, class Allocator>
+void List<T, Allocator>::copyAll(const List<T, Allocator> &newList)
 {
   Node<T> *aux{newList.anchor};
   Node<T> *last{nullptr};
@@ -229,12 +530,13 @@ void List<T>::copyAll(const List<T> &newList)
 
   while (aux != nullptr)
   {
-    newNode = new Node<T>(aux->getData());
+    newNode = allocator.create(aux->getData());
 
     if (newNode == nullptr)
     {
       throw Exception("Memoria no disponible, copyAll");
     }
+    newNode->setOwner(this);
 
     if (last == nullptr)
     {
@@ -248,18 +550,21 @@ void List<T>::copyAll(const List<T> &newList)
     last = newNode;
     aux = aux->getNext();
   }
-}
 
-template <class T>
-void List<T>::swapData(Node<T> *a, Node<T> *b)
-{
-  T aux{a->getData()};
-  a->setData(b->getData());
-  b->setData(aux);
+  tail = last;
+  count = newList.count;
+
+  if (indexed)
+  {
+    for (aux = anchor; aux != nullptr; aux = aux->getNext())
+    {
+      index.emplace(aux->getData().getName(), aux);
+    }
+  }
 }
 
-template <class T>
-Node<T> *List<T>::getHalf(Node<T> *first, Node<T> *last)
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::getHalf(Node<T> *first, Node<T> *last)
 {
   Node<T> *half{first};
   Node<T> *aux{first};
@@ -282,8 +587,8 @@ Node<T> *List<T>::getHalf(Node<T> *first, Node<T> *last)
   return half;
 }
 
-template <class T>
-int List<T>::compare(const T &a, const T &b)
+template <class T, class Allocator>
+int List<T, Allocator>::compare(const T &a, const T &b)
 {
   if (a > b)
     return 1;
@@ -293,48 +598,142 @@ int List<T>::compare(const T &a, const T &b)
     return -1;
 }
 
-template <class T>
-List<T>::List() : anchor(nullptr)
+template <class T, class Allocator>
+atomic<uint32_t> List<T, Allocator>::instances{0};
+
+template <class T, class Allocator>
+List<T, Allocator>::List() : anchor(nullptr), tail(nullptr), count(0), version(uint64_t(++instances) << 32), indexed(false), listener(nullptr), listenerOwner(nullptr)
 {
 }
 
-template <class T>
-List<T>::List(const List<T> &newList) : anchor(nullptr)
+template <class T, class Allocator>
+List<T, Allocator>::List(const List<T, Allocator> &newList) : anchor(nullptr), tail(nullptr), count(0), version(uint64_t(++instances) << 32), indexed(newList.indexed), listener(nullptr), listenerOwner(nullptr)
 {
   copyAll(newList);
 }
 
-template <class T>
-List<T>::~List()
+template <class T, class Allocator>
+List<T, Allocator>::~List()
 {
+  listener = nullptr; //the owner may be halfway destroyed
   deleteAll();
 }
 
-template <class T>
-bool List<T>::isEmpty() const
+template <class T, class Allocator>
+bool List<T, Allocator>::isEmpty() const
 {
   return anchor == nullptr;
 }
 
-template <class T>
-void List<T>::insert(const T &value, Node<T> *position)
+template <class T, class Allocator>
+size_t List<T, Allocator>::size() const
+{
+  return count;
+}
+
+template <class T, class Allocator>
+uint64_t List<T, Allocator>::getVersion() const
+{
+  return version;
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::setListener(Listener e, void *owner)
+{
+  listener = e;
+  listenerOwner = owner;
+}
+
+template <class T, class Allocator>
+void *List<T, Allocator>::getListenerOwner() const
+{
+  return listenerOwner;
+}
+
+template <class T, class Allocator>
+shared_mutex &List<T, Allocator>::getMutex() const
+{
+  return access;
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::notify(const Change &change, Node<T> *position)
+{
+  if (listener != nullptr)
+    listener(listenerOwner, change, position);
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::touch(Node<T> *position)
+{
+  if (!isValidPosition(position))
+  {
+    throw Exception("Posicion invalida, touch");
+  }
+
+  version++;
+  notify(UPDATED, position);
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::insert(const T &value, Node<T> *position)
 {
   if (anchor != nullptr and !isValidPosition(position))
   {
     throw Exception("Posicion invalida, insert");
   }
 
-  Node<T> *aux;
-  aux = new Node<T>(value);
+  insertUnchecked(value, position);
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::insert(T &&value, Node<T> *position)
+{
+  if (anchor != nullptr and !isValidPosition(position))
+  {
+    throw Exception("Posicion invalida, insert");
+  }
+
+  insertUnchecked(std::move(value), position);
+}
+
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::insertUnchecked(const T &value, Node<T> *position)
+{
+  return link(allocator.create(value), position);
+}
+
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::insertUnchecked(T &&value, Node<T> *position)
+{
+  return link(allocator.create(std::move(value)), position);
+}
+
+template <class T, class Allocator>
+template <class... Args>
+Node<T> *List<T, Allocator>::emplace(Node<T> *position, Args &&...args)
+{
+  if (anchor != nullptr and !isValidPosition(position))
+  {
+    throw Exception("Posicion invalida, emplace");
+  }
+
+  return link(allocator.create(std::forward<Args>(args)...), position);
+}
 
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::link(Node<T> *aux, Node<T> *position)
+{
   if (aux == nullptr)
   {
     throw Exception("Memoria no disponible, insert");
   }
+  aux->setOwner(this);
 
   if (position == nullptr)
   { //insert at the beginning
     aux->setPrev(nullptr);
+    aux->setNext(anchor);
     if (anchor != nullptr)
     {
       anchor->setPrev(aux);
@@ -351,10 +750,25 @@ void List<T>::insert(const T &value, Node<T> *position)
     }
     position->setNext(aux);
   }
+
+  if (aux->getNext() == nullptr)
+  {
+    tail = aux;
+  }
+  count++;
+  version++;
+
+  if (indexed)
+  {
+    index.emplace(aux->getData().getName(), aux);
+  }
+  notify(INSERTED, aux);
+
+  return aux;
 }
 
-template <class T>
-void List<T>::remove(Node<T> *position)
+template <class T, class Allocator>
+void List<T, Allocator>::remove(Node<T> *position)
 {
   if (!isValidPosition(position))
   {
@@ -376,34 +790,42 @@ void List<T>::remove(Node<T> *position)
     anchor = anchor->getNext();
   }
 
-  delete position;
+  if (position == tail)
+  { //delete last
+    tail = tail->getPrev();
+  }
+
+  if (indexed)
+  {
+    indexErase(position);
+  }
+
+  count--;
+  version++;
+  notify(REMOVED, position);
+  allocator.destroy(position);
 }
 
-template <class T>
-Node<T> *List<T>::getFirst()
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::getFirst() const
 {
   return anchor;
 }
 
-template <class T>
-Node<T> *List<T>::getLast()
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::getLast() const
 {
+  return tail;
+}
 
-  if (isEmpty())
-    return nullptr;
-
-  Node<T> *aux{anchor};
-
-  while (aux->getNext() != nullptr)
-  {
-    aux = aux->getNext();
-  }
-
-  return aux;
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::back()
+{
+  return tail;
 }
 
-template <class T>
-Node<T> *List<T>::getPreviousPos(Node<T> *position)
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::getPreviousPos(Node<T> *position)
 {
   if (!isValidPosition(position))
     return nullptr;
@@ -411,8 +833,8 @@ Node<T> *List<T>::getPreviousPos(Node<T> *position)
   return position->getPrev();
 }
 
-template <class T>
-Node<T> *List<T>::getNextPos(Node<T> *position)
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::getNextPos(Node<T> *position)
 {
   if (!isValidPosition(position))
     return nullptr;
@@ -420,8 +842,8 @@ Node<T> *List<T>::getNextPos(Node<T> *position)
   return position->getNext();
 }
 
-template <class T>
-Node<T> *List<T>::linearSearch(const T &value, int (*comp)(const T &, const T &))
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::linearSearch(const T &value, int (*comp)(const T &, const T &))
 {
   Node<T> *aux{anchor};
 
@@ -436,16 +858,16 @@ Node<T> *List<T>::linearSearch(const T &value, int (*comp)(const T &, const T &)
   return nullptr;
 }
 
-template <class T>
-Node<T> *List<T>::binarySearch(const T &value, int (*comp)(const T &, const T &))
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::binarySearch(const T &value, int (*comp)(const T &, const T &))
 {
   if (isEmpty())
     return nullptr;
   return binarySearch(value, anchor, getLast(), comp);
 }
 
-template <class T>
-Node<T> *List<T>::binarySearch(const T &value, Node<T> *first, Node<T> *last, int (*comp)(const T &, const T &))
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::binarySearch(const T &value, Node<T> *first, Node<T> *last, int (*comp)(const T &, const T &))
 {
 
   Node<T> *half{getHalf(first, last)};
@@ -466,53 +888,135 @@ Node<T> *List<T>::binarySearch(const T &value, Node<T> *first, Node<T> *last, in
   return binarySearch(value, first, last, comp);
 }
 
-template <class T>
-T List<T>::recover(Node<T> *position)
+template <class T, class Allocator>
+void List<T, Allocator>::indexErase(Node<T> *position)
 {
-  if (!isValidPosition(position))
+  auto range{index.equal_range(position->getData().getName())};
+
+  for (auto i{range.first}; i != range.second; ++i)
   {
-    throw Exception("Posicion invalida, recover");
+    if (i->second == position)
+    {
+      index.erase(i);
+      return;
+    }
   }
-
-  return position->getData();
-}
-
-template <class T>
-void List<T>::bubbleSort()
-{
-  if (isEmpty())
-    return;
-  bubbleSort(getLast());
 }
 
-template <class T>
-void List<T>::bubbleSort(Node<T> *last)
+template <class T, class Allocator>
+void List<T, Allocator>::setIndexed(const bool &e)
 {
-  Node<T> *aux{anchor};
-  bool flag{false};
+  indexed = e;
+  index.clear();
 
-  while (aux != last)
+  if (indexed)
   {
-    if (aux->getData() > aux->getNext()->getData())
+    index.reserve(count);
+    for (Node<T> *aux{anchor}; aux != nullptr; aux = aux->getNext())
     {
-      swapData(aux, aux->getNext());
-      flag = true;
+      index.emplace(aux->getData().getName(), aux);
     }
-    aux = aux->getNext();
   }
+}
 
-  last = last->getPrev();
-
-  if (aux == last or flag == false)
-    return;
-
-  bubbleSort(last);
+template <class T, class Allocator>
+bool List<T, Allocator>::isIndexed() const
+{
+  return indexed;
 }
 
-template <class T>
-string List<T>::toString() const
+template <class T, class Allocator>
+Node<T> *List<T, Allocator>::searchByName(const string &name) const
 {
-  if (isEmpty())
+  // Repeated names return the first one in list order either way; the index keeps no order, so only then the list is walked
+  if (indexed)
+  {
+    auto range{index.equal_range(name)};
+    if (range.first == range.second or std::next(range.first) == range.second)
+      return range.first == range.second ? nullptr : range.first->second;
+  }
+
+  for (Node<T> *aux{anchor}; aux != nullptr; aux = aux->getNext())
+  {
+    if (aux->getData().getName() == name)
+      return aux;
+  }
+  return nullptr;
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::rename(Node<T> *position, const string &name)
+{
+  if (!isValidPosition(position))
+  {
+    throw Exception("Posicion invalida, rename");
+  }
+
+  if (indexed)
+  {
+    indexErase(position);
+    index.emplace(name, position);
+  }
+  position->getDataPtr()->setName(name);
+  version++;
+  notify(UPDATED, position);
+}
+
+template <class T, class Allocator>
+T List<T, Allocator>::recover(Node<T> *position)
+{
+  if (!isValidPosition(position))
+  {
+    throw Exception("Posicion invalida, recover");
+  }
+
+  return position->getData();
+}
+
+template <class T, class Allocator>
+void List<T, Allocator>::sort(int (*comp)(const T &, const T &))
+{
+  if (count < 2)
+    return;
+
+  // merge sort over an array of (payload, position), payloads stay where they are and only the links change
+  vector<pair<T *, Node<T> *>> positions;
+  positions.reserve(count);
+  for (Node<T> *aux{anchor}; aux != nullptr; aux = aux->getNext())
+  {
+    positions.push_back(make_pair(aux->getDataPtr(), aux));
+  }
+
+  if (comp == List::compare)
+  { //a < b is b > a, one comparison instead of two
+    stable_sort(positions.begin(), positions.end(), [](const pair<T *, Node<T> *> &a, const pair<T *, Node<T> *> &b) {
+      return *b.first > *a.first;
+    });
+  }
+  else
+  {
+    stable_sort(positions.begin(), positions.end(), [comp](const pair<T *, Node<T> *> &a, const pair<T *, Node<T> *> &b) {
+      return comp(*a.first, *b.first) < 0;
+    });
+  }
+
+  anchor = positions.front().second;
+  anchor->setPrev(nullptr);
+  for (size_t i{1}; i < positions.size(); i++)
+  {
+    positions[i - 1].second->setNext(positions[i].second);
+    positions[i].second->setPrev(positions[i - 1].second);
+  }
+  tail = positions.back().second;
+  tail->setNext(nullptr);
+  version++;
+  notify(SORTED, nullptr);
+}
+
+template <class T, class Allocator>
+string List<T, Allocator>::toString() const
+{
+  if (isEmpty())
     return "";
 
   Node<T> *aux{anchor};
@@ -528,8 +1032,8 @@ string List<T>::toString() const
   return stringList + '\n';
 }
 
-template <class T>
-void List<T>::deleteAll()
+template <class T, class Allocator>
+void List<T, Allocator>::deleteAll()
 {
   Node<T> *aux;
 
@@ -537,1155 +1041,11968 @@ void List<T>::deleteAll()
   {
     aux = anchor;
     anchor = anchor->getNext();
-    delete aux;
+    allocator.destroy(aux);
   }
+
+  tail = nullptr;
+  count = 0;
+  version++;
+  index.clear();
+  notify(RESET, nullptr);
 }
 
-template <class T>
-List<T> &List<T>::operator=(const List<T> &newList)
+template <class T, class Allocator>
+const Allocator &List<T, Allocator>::getAllocator() const
+{
+  return allocator;
+}
+
+template <class T, class Allocator>
+List<T, Allocator> &List<T, Allocator>::operator=(const List<T, Allocator> &newList)
 {
+  if (this == &newList)
+    return *this;
+
   deleteAll();
+  indexed = newList.indexed;
   copyAll(newList);
+  notify(RESET, nullptr);
   return *this;
 }
 
-//* -------- ------- ------ ----- Reacciones ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+//* -------- ------- ------ ----- Lista Concurrente ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
 
-class Reaction
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Append only list for many writer threads, with no locks. An append takes the next index with one fetch_add and
+// builds the element in place; segment k holds (1 << firstBits) << k elements and never moves, so nothing appended
+// is ever relocated and readers of a ready index need no lock. A segment is installed with a CAS by the writer that
+// reaches the middle of the one before it, ahead of demand, or by the first writer that finds it missing; a writer
+// that loses the race frees its own, which no other thread saw. Elements and segments are only freed by clear(),
+// moveTo() or the destructor, which need every writer to be done
+template <class T>
+class AppendList
 {
 private:
-  int id;
-  string name;
-  string stoichiometry;
-  int lowerLimit;
-  int higherLimit;
-  string genReaction;
-  string metabolites;
+  static const int firstBits{10};
+  static const int segmentCount{48};
+
+  struct Slot //zero filled memory is an empty slot
+  {
+    atomic<bool> ready;
+    alignas(T) unsigned char data[sizeof(T)];
+  };
+
+  atomic<Slot *> segments[segmentCount];
+  atomic<size_t> count;
+
+  AppendList(const AppendList<T> &) = delete;
+  AppendList<T> &operator=(const AppendList<T> &) = delete;
+
+  static void locate(const size_t &, int &, size_t &); //index, segment, offset
+  Slot *getSegment(const int &);
+  Slot *getSlot(const size_t &) const;
 
 public:
-  Reaction();
-  Reaction(const Reaction &);
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
 
-  int getId() const;
-  string getName() const;
-  string getEstequiometria() const;
-  int getLowerLimit() const;
-  int getHigherLimit() const;
-  string getGenReaction() const;
-  string getMetabolites() const;
+  public:
+    explicit Exception(const char *message) : msg(message) {}
 
-  void setId(const int &);
-  void setName(const string &);
-  void setStoichiometry(const string &);
-  void setLowerLimit(const int &);
-  void setHigherLimit(const int &);
-  void setGenReaction(const string &);
-  void setMetabolites(const string &);
+    explicit Exception(const std::string &message) : msg(message) {}
 
-  string toString();
+    virtual ~Exception() throw() {}
 
-  bool operator==(const Reaction &) const;
-  bool operator>(const Reaction &) const;
-};
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
 
-Reaction::Reaction() {}
+  AppendList();
+  ~AppendList();
 
-Reaction::Reaction(const Reaction &r) : id(r.id), name(r.name), stoichiometry(r.stoichiometry), lowerLimit(r.lowerLimit), higherLimit(r.higherLimit), genReaction(r.genReaction), metabolites(r.metabolites) {}
+  size_t append(const T &); //returns the index
+  size_t append(T &&);
+  template <class... Args>
+  size_t emplace(Args &&...);
 
-int Reaction::getId() const
-{
-  return id;
-}
+  size_t size() const; //indexes taken, the last ones may still be under construction
+  bool isReady(const size_t &) const;
+  const T &get(const size_t &) const;
 
-string Reaction::getName() const
-{
-  return name;
-}
+  void moveTo(List<T> &); //appends the elements in index order at the end of the list and empties this one
+  void clear();
+};
 
-string Reaction::getEstequiometria() const
-{
-  return stoichiometry;
-}
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
 
-int Reaction::getLowerLimit() const
+template <class T>
+AppendList<T>::AppendList() : count(0)
 {
-  return lowerLimit;
+  for (atomic<Slot *> &e : segments)
+    e.store(nullptr, memory_order_relaxed);
 }
 
-int Reaction::getHigherLimit() const
+template <class T>
+AppendList<T>::~AppendList()
 {
-  return higherLimit;
+  clear();
 }
 
-string Reaction::getMetabolites() const
+// Index i is position i + 2^firstBits of a sequence whose segment k starts at 2^(firstBits + k)
+template <class T>
+void AppendList<T>::locate(const size_t &index, int &segment, size_t &offset)
 {
-  return metabolites;
+  uint64_t position{uint64_t(index) + (uint64_t(1) << firstBits)};
+  int bit{63 - __builtin_clzll(position)};
+
+  segment = bit - firstBits;
+  offset = size_t(position - (uint64_t(1) << bit));
 }
 
-string Reaction::getGenReaction() const
+template <class T>
+typename AppendList<T>::Slot *AppendList<T>::getSegment(const int &segment)
 {
-  return genReaction;
+  if (segment >= segmentCount)
+  {
+    throw Exception("Capacidad agotada, append");
+  }
+
+  Slot *found{segments[segment].load(memory_order_acquire)};
+  if (found != nullptr)
+    return found;
+
+  // calloc leaves fresh pages untouched until they are written, a segment costs nothing before its slots are used
+  Slot *created{static_cast<Slot *>(calloc(size_t(1) << (firstBits + segment), sizeof(Slot)))};
+  if (created == nullptr)
+  {
+    throw Exception("Memoria no disponible, append");
+  }
+  if (segments[segment].compare_exchange_strong(found, created, memory_order_acq_rel, memory_order_acquire))
+    return created;
+  free(created); //another writer installed it first
+  return found;
 }
 
-void Reaction::setId(const int &e)
+template <class T>
+typename AppendList<T>::Slot *AppendList<T>::getSlot(const size_t &index) const
 {
-  id = e;
+  int segment;
+  size_t offset;
+
+  locate(index, segment, offset);
+  Slot *found{segment < segmentCount ? segments[segment].load(memory_order_acquire) : nullptr};
+  return found == nullptr ? nullptr : found + offset;
 }
 
-void Reaction::setName(const string &e)
+template <class T>
+size_t AppendList<T>::append(const T &value)
 {
-  name = e;
+  return emplace(value);
 }
 
-void Reaction::setStoichiometry(const string &e)
+template <class T>
+size_t AppendList<T>::append(T &&value)
 {
-  stoichiometry = e;
+  return emplace(std::move(value));
 }
 
-void Reaction::setLowerLimit(const int &e)
+// An element whose constructor throws leaves its index never ready, moveTo skips it
+template <class T>
+template <class... Args>
+size_t AppendList<T>::emplace(Args &&...args)
 {
-  lowerLimit = e;
+  size_t index{count.fetch_add(1, memory_order_relaxed)};
+  int segment;
+  size_t offset;
+
+  locate(index, segment, offset);
+  Slot &slot{getSegment(segment)[offset]};
+  if (offset == (size_t(1) << (firstBits + segment - 1)) and segment + 1 < segmentCount)
+    getSegment(segment + 1);
+  new (slot.data) T(std::forward<Args>(args)...);
+  slot.ready.store(true, memory_order_release);
+  return index;
 }
 
-void Reaction::setHigherLimit(const int &e)
+template <class T>
+size_t AppendList<T>::size() const
 {
-  higherLimit = e;
+  return count.load(memory_order_acquire);
 }
 
-void Reaction::setMetabolites(const string &e)
+template <class T>
+bool AppendList<T>::isReady(const size_t &index) const
 {
-  metabolites = e;
+  Slot *slot{index < size() ? getSlot(index) : nullptr};
+  return slot != nullptr and slot->ready.load(memory_order_acquire);
 }
 
-void Reaction::setGenReaction(const string &e)
+template <class T>
+const T &AppendList<T>::get(const size_t &index) const
 {
-  genReaction = e;
+  if (!isReady(index))
+  {
+    throw Exception("Elemento no disponible: " + to_string(index));
+  }
+  return *reinterpret_cast<const T *>(getSlot(index)->data);
 }
 
-string Reaction::toString()
+template <class T>
+void AppendList<T>::moveTo(List<T> &list)
 {
-  string result{""};
-  result += "\nId: " + to_string(id);
-  result += "\nNombre: " + name;
-  result += "\nEstequiometria: " + stoichiometry;
-  result += "\nLimite Inferior: " + to_string(lowerLimit);
-  result += "\nLimite Superior: " + to_string(higherLimit);
-  result += "\nGen-Reaccion: " + genReaction;
-  result += "\nMetabolites: " + metabolites;
-
-  return result;
-};
+  size_t total{size()};
+  Node<T> *last{list.getLast()};
 
-bool Reaction::operator==(const Reaction &e) const
-{
-  return name == e.name;
+  for (size_t i{0}; i < total; i++)
+  {
+    Slot *slot{getSlot(i)};
+    if (slot != nullptr and slot->ready.load(memory_order_acquire))
+      last = list.insertUnchecked(std::move(*reinterpret_cast<T *>(slot->data)), last);
+  }
+  clear();
 }
 
-bool Reaction::operator>(const Reaction &e) const
+template <class T>
+void AppendList<T>::clear()
 {
-  return name > e.name;
+  size_t total{size()};
+
+  for (size_t i{0}; i < total; i++)
+  {
+    Slot *slot{getSlot(i)};
+    if (slot != nullptr and slot->ready.load(memory_order_relaxed))
+      reinterpret_cast<T *>(slot->data)->~T();
+  }
+  for (atomic<Slot *> &e : segments)
+  {
+    free(e.exchange(nullptr));
+  }
+  count.store(0);
 }
 
-//* -------- ------- ------ ----- Metabolitos ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+//* -------- ------- ------ ----- Simbolos ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
 
-class Metabolite
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Process wide table of interned strings. Each distinct text is stored once and is referred to by a 32 bit id;
+// texts live in fixed size chunks that never move, so reading an id needs no lock. The lookup is split in shards
+// by text hash, each with its own lock, so threads interning different texts rarely wait for each other. Every
+// symbol holds a reference on its entry; the last one to go removes the text and leaves the id for reuse
+class SymbolTable
 {
 private:
-  int id;
-  string name;
-  string chemicalForm;
-  string compartment;
+  static const uint32_t chunkBits{12};
+  static const uint32_t chunkSize{1u << chunkBits};
+  static const uint32_t maxChunks{1u << 16};
+  static const int shardBits{4};
+
+  struct Entry
+  {
+    string text;
+    atomic<uint32_t> references{0};
+    atomic<uint8_t> shard{0};
+    atomic<bool> live{false};
+  };
+
+  struct Shard
+  {
+    vector<uint32_t> slots; //open addressing on the text hash, empty slots hold UINT32_MAX
+    uint32_t used;
+    size_t heapBytes;
+    mutex lock;
+  };
+
+  atomic<Entry *> chunks[maxChunks];
+  atomic<uint32_t> count; //ids ever handed out
+  atomic<uint32_t> symbols; //entries in use
+  Shard shards[1 << shardBits];
+  vector<uint32_t> freeIds;
+  mutex freeLock;
+
+  SymbolTable();
+
+  static Shard &shardOf(Shard *, const size_t &); //shards, hash
+  void grow(Shard &);
+  void remove(Shard &, const uint32_t &);
+  Entry &allocate(uint32_t &); //new id
+  Entry &at(const uint32_t &) const;
 
 public:
-  Metabolite();
-  Metabolite(const Metabolite &);
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
 
-  int getId() const;
-  string getName() const;
-  string getChemicalForm() const;
-  string getCompartment() const;
+  public:
+    explicit Exception(const char *message) : msg(message) {}
 
-  void setId(const int &);
-  void setName(const string &);
-  void setChemicalForm(const string &);
-  void setCompartment(const string &);
+    explicit Exception(const std::string &message) : msg(message) {}
 
-  string toString();
+    virtual ~Exception() throw() {}
 
-  bool operator==(const Metabolite &) const;
-  bool operator>(const Metabolite &) const;
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+  ~SymbolTable();
+
+  static SymbolTable &global();
+
+  uint32_t intern(const string_view &); //the caller owns one reference on the result
+  uint32_t find(const string_view &); //UINT32_MAX when the text is not interned, takes no reference
+  const string &get(const uint32_t &) const;
+  void acquire(const uint32_t &);
+  void release(const uint32_t &);
+
+  uint32_t size() const;
+  size_t getBytes();
 };
 
-Metabolite::Metabolite() {}
+// Handle to an interned string; two symbols are equal exactly when their ids are
+class Symbol
+{
+private:
+  uint32_t id;
+
+public:
+  Symbol();
+  Symbol(const string &);
+  Symbol(const char *);
+  Symbol(const Symbol &);
+  Symbol(Symbol &&) noexcept;
+  ~Symbol();
+
+  Symbol &operator=(const Symbol &);
+  Symbol &operator=(Symbol &&) noexcept;
+
+  uint32_t getId() const;
+  const string &getText() const;
+
+  bool operator==(const Symbol &) const;
+  bool operator!=(const Symbol &) const;
+  bool operator>(const Symbol &) const;
+};
 
-Metabolite::Metabolite(const Metabolite &m) : id(m.id), name(m.name), chemicalForm(m.chemicalForm), compartment(m.compartment) {}
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
 
-int Metabolite::getId() const
+// id 0 is always the empty string, so default constructed symbols need no lookup; it is never released
+SymbolTable::SymbolTable() : count(0), symbols(0)
 {
-  return id;
+  for (atomic<Entry *> &e : chunks)
+    e.store(nullptr, memory_order_relaxed);
+  for (Shard &e : shards)
+  {
+    e.slots.assign(64, UINT32_MAX);
+    e.used = 0;
+    e.heapBytes = 0;
+  }
+  intern("");
 }
 
-string Metabolite::getName() const
+SymbolTable::~SymbolTable()
 {
-  return name;
+  for (atomic<Entry *> &e : chunks)
+    delete[] e.load(memory_order_relaxed);
 }
 
-string Metabolite::getChemicalForm() const
+// Never destroyed, symbols held by other statics still release into it at exit
+SymbolTable &SymbolTable::global()
 {
-  return chemicalForm;
+  static SymbolTable *table{new SymbolTable()};
+  return *table;
 }
 
-string Metabolite::getCompartment() const
+// The top bits of the hash pick the shard, the low ones the slot inside it
+SymbolTable::Shard &SymbolTable::shardOf(Shard *e, const size_t &hashed)
 {
-  return compartment;
+  return e[hashed >> (sizeof(size_t) * 8 - shardBits)];
 }
 
-void Metabolite::setId(const int &e)
+// Doubles the slot array of a shard once it is half full
+void SymbolTable::grow(Shard &shard)
 {
-  id = e;
+  vector<uint32_t> old(shard.slots.size() * 2, UINT32_MAX);
+  old.swap(shard.slots);
+
+  for (uint32_t id : old)
+  {
+    if (id == UINT32_MAX)
+      continue;
+    size_t slot{hash<string_view>()(get(id)) & (shard.slots.size() - 1)};
+    while (shard.slots[slot] != UINT32_MAX)
+      slot = (slot + 1) & (shard.slots.size() - 1);
+    shard.slots[slot] = id;
+  }
 }
 
-void Metabolite::setName(const string &e)
+// Takes the id out of its shard; later ids of the same probe run move back into the hole so lookups never stop
+// early at it
+void SymbolTable::remove(Shard &shard, const uint32_t &id)
 {
-  name = e;
+  size_t mask{shard.slots.size() - 1};
+  size_t hole{hash<string_view>()(get(id)) & mask};
+  while (shard.slots[hole] != id)
+  {
+    if (shard.slots[hole] == UINT32_MAX)
+      return;
+    hole = (hole + 1) & mask;
+  }
+
+  for (size_t next{(hole + 1) & mask}; shard.slots[next] != UINT32_MAX; next = (next + 1) & mask)
+  {
+    size_t home{hash<string_view>()(get(shard.slots[next])) & mask};
+    if (((next - home) & mask) >= ((next - hole) & mask))
+    {
+      shard.slots[hole] = shard.slots[next];
+      hole = next;
+    }
+  }
+  shard.slots[hole] = UINT32_MAX;
+  shard.used--;
 }
 
-void Metabolite::setChemicalForm(const string &e)
+// Reuses a released id when there is one, otherwise takes the next; the first shard to reach a chunk installs it,
+// a shard that loses the race frees its own
+SymbolTable::Entry &SymbolTable::allocate(uint32_t &id)
 {
-  chemicalForm = e;
+  {
+    lock_guard<mutex> guard(freeLock);
+    if (!freeIds.empty())
+    {
+      id = freeIds.back();
+      freeIds.pop_back();
+      return at(id);
+    }
+  }
+
+  id = count.fetch_add(1, memory_order_relaxed);
+  if ((id >> chunkBits) >= maxChunks)
+  {
+    throw Exception("Tabla de simbolos llena");
+  }
+
+  atomic<Entry *> &chunk{chunks[id >> chunkBits]};
+  Entry *found{chunk.load(memory_order_acquire)};
+  if (found == nullptr)
+  {
+    Entry *created{new Entry[chunkSize]};
+    if (chunk.compare_exchange_strong(found, created, memory_order_acq_rel, memory_order_acquire))
+      found = created;
+    else
+      delete[] created;
+  }
+  return found[id & (chunkSize - 1)];
 }
 
-void Metabolite::setCompartment(const string &e)
+SymbolTable::Entry &SymbolTable::at(const uint32_t &e) const
 {
-  compartment = e;
+  return chunks[e >> chunkBits].load(memory_order_acquire)[e & (chunkSize - 1)];
 }
 
-string Metabolite::toString()
+uint32_t SymbolTable::intern(const string_view &e)
 {
-  string result{""};
-  result += "\nId: " + to_string(id);
-  result += "\nNombre: " + name;
-  result += "\nFormula quimica: " + chemicalForm;
-  result += "\nCompartimiento: " + compartment;
+  size_t hashed{hash<string_view>()(e)};
+  Shard &shard{shardOf(shards, hashed)};
+  lock_guard<mutex> guard(shard.lock);
 
-  return result;
+  size_t slot{hashed & (shard.slots.size() - 1)};
+  while (shard.slots[slot] != UINT32_MAX)
+  {
+    uint32_t id{shard.slots[slot]};
+    if (get(id) == e)
+    {
+      acquire(id);
+      return id;
+    }
+    slot = (slot + 1) & (shard.slots.size() - 1);
+  }
+
+  // The reference count goes before the live flag, a release racing on a recycled id sees it and backs off
+  uint32_t id;
+  Entry &entry{allocate(id)};
+  entry.text.assign(e.data(), e.size());
+  if (entry.text.capacity() > string().capacity())
+    shard.heapBytes += entry.text.capacity() + 1;
+  entry.references.store(1);
+  entry.shard.store(uint8_t(&shard - shards));
+  entry.live.store(true);
+  symbols++;
+
+  shard.slots[slot] = id;
+  if (size_t(++shard.used) * 2 > shard.slots.size())
+    grow(shard);
+  return id;
 }
 
-bool Metabolite::operator==(const Metabolite &e) const
+uint32_t SymbolTable::find(const string_view &e)
 {
-  return name == e.name;
+  size_t hashed{hash<string_view>()(e)};
+  Shard &shard{shardOf(shards, hashed)};
+  lock_guard<mutex> guard(shard.lock);
+
+  size_t slot{hashed & (shard.slots.size() - 1)};
+  while (shard.slots[slot] != UINT32_MAX)
+  {
+    if (get(shard.slots[slot]) == e)
+      return shard.slots[slot];
+    slot = (slot + 1) & (shard.slots.size() - 1);
+  }
+  return UINT32_MAX;
 }
 
-bool Metabolite::operator>(const Metabolite &e) const
+const string &SymbolTable::get(const uint32_t &e) const
 {
-  return name > e.name;
+  return at(e).text;
 }
 
-//* -------- ------- ------ ----- Genes ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
-
-class Gen
+void SymbolTable::acquire(const uint32_t &e)
 {
-private:
-  int id;
-  string name;
-  string functional;
-  string genReaction;
+  if (e != 0)
+    at(e).references.fetch_add(1, memory_order_relaxed);
+}
 
-public:
-  Gen();
-  Gen(const Gen &);
+// The count can reach zero while another thread interns the same text again, or the id can be freed and handed
+// out again before the shard lock is taken, so the entry is only removed when it is still live, unreferenced and in
+// the shard that was locked
+void SymbolTable::release(const uint32_t &e)
+{
+  if (e == 0)
+    return;
+  Entry &entry{at(e)};
+  if (entry.references.fetch_sub(1, memory_order_acq_rel) != 1)
+    return;
 
-  int getId() const;
-  string getName() const;
-  string getFunctional() const;
-  string getGenReaction() const;
+  for (;;)
+  {
+    uint8_t index{entry.shard.load()};
+    Shard &shard{shards[index]};
+    lock_guard<mutex> guard(shard.lock);
+
+    if (!entry.live.load() or entry.references.load() != 0)
+      return;
+    if (entry.shard.load() != index)
+      continue;
+
+    remove(shard, e);
+    if (entry.text.capacity() > string().capacity())
+      shard.heapBytes -= entry.text.capacity() + 1;
+    string().swap(entry.text);
+    entry.live.store(false);
+    symbols--;
+
+    lock_guard<mutex> freeGuard(freeLock);
+    freeIds.push_back(e);
+    return;
+  }
+}
 
-  void setId(const int &);
-  void setName(const string &);
-  void setFunctional(const string &);
-  void setGenReaction(const string &);
+uint32_t SymbolTable::size() const
+{
+  return symbols.load(memory_order_acquire);
+}
 
-  string toString();
+// Chunks in use, string heap buffers, the slot arrays and the released ids
+size_t SymbolTable::getBytes()
+{
+  size_t chunksInUse{(size_t(count.load(memory_order_relaxed)) + chunkSize - 1) >> chunkBits};
+  size_t result{sizeof(SymbolTable) + chunksInUse * chunkSize * sizeof(Entry)};
 
-  bool operator==(const Gen &) const;
-  bool operator>(const Gen &) const;
-};
+  for (Shard &e : shards)
+  {
+    lock_guard<mutex> guard(e.lock);
+    result += e.heapBytes + e.slots.size() * sizeof(uint32_t);
+  }
+  lock_guard<mutex> guard(freeLock);
+  return result + freeIds.capacity() * sizeof(uint32_t);
+}
 
-Gen::Gen() {}
+Symbol::Symbol() : id(0) {}
 
-Gen::Gen(const Gen &g) : id(g.id), name(g.name), functional(g.functional), genReaction(g.genReaction) {}
+Symbol::Symbol(const string &e) : id(SymbolTable::global().intern(e)) {}
 
-int Gen::getId() const
-{
-  return id;
-}
+Symbol::Symbol(const char *e) : id(SymbolTable::global().intern(e)) {}
 
-string Gen::getName() const
+Symbol::Symbol(const Symbol &e) : id(e.id)
 {
-  return name;
+  SymbolTable::global().acquire(id);
 }
 
-string Gen::getFunctional() const
+Symbol::Symbol(Symbol &&e) noexcept : id(e.id)
 {
-  return functional;
+  e.id = 0;
 }
 
-string Gen::getGenReaction() const
+Symbol::~Symbol()
 {
-  return genReaction;
+  SymbolTable::global().release(id);
 }
 
-void Gen::setId(const int &e)
+Symbol &Symbol::operator=(const Symbol &e)
 {
-  id = e;
+  SymbolTable::global().acquire(e.id);
+  SymbolTable::global().release(id);
+  id = e.id;
+  return *this;
 }
 
-void Gen::setName(const string &e)
+Symbol &Symbol::operator=(Symbol &&e) noexcept
 {
-  name = e;
+  std::swap(id, e.id);
+  return *this;
 }
 
-void Gen::setFunctional(const string &e)
+uint32_t Symbol::getId() const
 {
-  functional = e;
+  return id;
 }
 
-void Gen::setGenReaction(const string &e)
+const string &Symbol::getText() const
 {
-  genReaction = e;
+  return SymbolTable::global().get(id);
 }
 
-string Gen::toString()
+bool Symbol::operator==(const Symbol &e) const
 {
-  string result{""};
-  result += "\nId: " + to_string(id);
-  result += "\nNombre: " + name;
-  result += "\nFuncional: " + functional;
-  result += "\nReaccion: " + genReaction;
-
-  return result;
+  return id == e.id;
 }
 
-bool Gen::operator==(const Gen &e) const
+bool Symbol::operator!=(const Symbol &e) const
 {
-  return name == e.name;
+  return id != e.id;
 }
 
-bool Gen::operator>(const Gen &e) const
+// Ids are handed out and reused in no particular order, so ordering still has to look at the text
+bool Symbol::operator>(const Symbol &e) const
 {
-  return name > e.name;
+  return id != e.id and getText() > e.getText();
 }
 
-//* -------- ------- ------ ----- Modelo Metabolico ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+//* -------- ------- ------ ----- Reacciones ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
 
-class Model
+class Reaction
 {
-private:
-  string name;
-  Node<Model> *memoryDirection;
-  int numberOfMetabolites;
-  int numberOfReactions;
-  string objetiveExpression;
-  string compartments;
+public:
+  // A metabolite taking part in the reaction, referenced by its id; reactants have negative coefficients
+  struct Participant
+  {
+    int metabolite;
+    double coefficient;
+  };
 
-  List<Reaction> reactionList;
-  List<Metabolite> metaboliteList;
-  List<Gen> genList;
+  enum Stoichiometry : uint8_t
+  {
+    FORWARD,
+    BACKWARD,
+    REVERSIBLE
+  };
 
-  int intAux;
-  string stringAux;
-  Reaction reactionAux;
-  Metabolite metaboliteAux;
-  Gen genAux;
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
 
-  Node<Reaction> *searchReaction();
-  Node<Metabolite> *searchMetabolite();
-  Node<Gen> *searchGen();
+  public:
+    explicit Exception(const char *message) : msg(message) {}
 
-  Node<Reaction> *insertReaction();
-  void insertMetabolite();
-  Node<Gen> *insertGen();
+    explicit Exception(const std::string &message) : msg(message) {}
 
-  void editReaction();
-  void editMetabolite();
-  void editGen();
+    virtual ~Exception() throw() {}
 
-  int optionList();
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+private:
+  int id;
+  Symbol name;
+  Stoichiometry stoichiometry;
+  int lowerLimit;
+  int higherLimit;
+  Symbol genReaction;
+  vector<Participant> participants;
 
 public:
-  Model();
-  Model(const Model &);
-  ~Model();
+  Reaction();
+  Reaction(const int &, const string &, const string &, const int &, const int &, const string &, vector<Participant>);
+  Reaction(const Reaction &);
+  Reaction(Reaction &&) noexcept;
 
-  string getName() const;
-  Node<Model> *getMemoryDirection() const;
-  int getNumberOfMetabolites() const;
-  int getNumberOfReactions() const;
-  string getObjetiveExpression() const;
-  string getCompartments() const;
+  static Stoichiometry toStoichiometry(const string &);
+  static const string &toString(const Stoichiometry &);
+
+  int getId() const;
+  const string &getName() const;
+  Stoichiometry getStoichiometry() const;
+  const string &getEstequiometria() const;
+  int getLowerLimit() const;
+  int getHigherLimit() const;
+  const string &getGenReaction() const;
+  const vector<Participant> &getParticipants() const;
+  string getParticipantsText() const;
 
+  void setId(const int &);
   void setName(const string &);
-  void setMemoryDirection(Node<Model> *);
-  void setNumberOfMetabolites(const int &);
-  void setNumberOfReactions(const int &);
-  void setObjetiveExpression(const string &);
-  void setCompartments(const string &);
+  void setStoichiometry(const string &);
+  void setStoichiometry(const Stoichiometry &);
+  void setLowerLimit(const int &);
+  void setHigherLimit(const int &);
+  void setGenReaction(const string &);
+  void setParticipants(const vector<Participant> &);
+  void setParticipants(vector<Participant> &&);
+  void addParticipant(const int &, const double &);
 
   string toString();
 
-  void chooseList();
+  Reaction &operator=(const Reaction &);
+  Reaction &operator=(Reaction &&) noexcept;
 
-  bool operator==(const Model &) const;
-  bool operator>(const Model &) const;
+  bool operator==(const Reaction &) const;
+  bool operator>(const Reaction &) const;
 };
 
-Model::Model() : memoryDirection(nullptr), numberOfMetabolites(0), numberOfReactions(0) {}
+Reaction::Reaction() : id(0), stoichiometry(FORWARD), lowerLimit(0), higherLimit(0) {}
 
-Model::Model(const Model &m) : name(m.name), memoryDirection(m.memoryDirection), numberOfMetabolites(m.numberOfMetabolites), numberOfReactions(m.numberOfReactions), objetiveExpression(m.objetiveExpression), compartments(m.compartments) {}
+Reaction::Reaction(const int &i, const string &n, const string &s, const int &l, const int &h, const string &g, vector<Participant> m) : id(i), name(n), stoichiometry(toStoichiometry(s)), lowerLimit(l), higherLimit(h), genReaction(g), participants(std::move(m)) {}
 
-Model::~Model()
+Reaction::Reaction(const Reaction &r) : id(r.id), name(r.name), stoichiometry(r.stoichiometry), lowerLimit(r.lowerLimit), higherLimit(r.higherLimit), genReaction(r.genReaction), participants(r.participants) {}
+
+Reaction::Reaction(Reaction &&r) noexcept : id(r.id), name(std::move(r.name)), stoichiometry(r.stoichiometry), lowerLimit(r.lowerLimit), higherLimit(r.higherLimit), genReaction(std::move(r.genReaction)), participants(std::move(r.participants)) {}
+
+// "->", "<-" and "<->" as written in the text format and the interface
+Reaction::Stoichiometry Reaction::toStoichiometry(const string &e)
 {
-  delete memoryDirection;
-  memoryDirection = nullptr;
+  if (e == "->")
+    return FORWARD;
+  if (e == "<-")
+    return BACKWARD;
+  if (e == "<->")
+    return REVERSIBLE;
+  throw Exception("Estequiometria invalida: " + e);
 }
 
-string Model::getName() const
+const string &Reaction::toString(const Stoichiometry &e)
 {
-  return name;
+  static const string texts[]{"->", "<-", "<->"};
+  return texts[e];
 }
 
-Node<Model> *Model::getMemoryDirection() const
+int Reaction::getId() const
 {
-  return memoryDirection;
+  return id;
 }
 
-int Model::getNumberOfMetabolites() const
+const string &Reaction::getName() const
 {
-  return numberOfMetabolites;
+  return name.getText();
 }
 
-int Model::getNumberOfReactions() const
+Reaction::Stoichiometry Reaction::getStoichiometry() const
 {
-  return numberOfReactions;
+  return stoichiometry;
 }
 
-string Model::getObjetiveExpression() const
+const string &Reaction::getEstequiometria() const
 {
-  return objetiveExpression;
+  return toString(stoichiometry);
 }
 
-string Model::getCompartments() const
+int Reaction::getLowerLimit() const
 {
-  return compartments;
+  return lowerLimit;
 }
 
-void Model::setName(const string &e) // e -> element
+int Reaction::getHigherLimit() const
 {
-  name = e;
+  return higherLimit;
 }
 
-void Model::setMemoryDirection(Node<Model> *e)
+const vector<Reaction::Participant> &Reaction::getParticipants() const
 {
-  memoryDirection = e;
+  return participants;
 }
 
-void Model::setNumberOfMetabolites(const int &e)
+// "id:coef id:coef ..." as stored in the text format
+string Reaction::getParticipantsText() const
 {
-  numberOfMetabolites = e;
+  string result{""};
+  char number[32];
+
+  // The shortest of 15 to 17 digits that reads back as the same double, so saving and replaying keep the coefficient
+  for (const Participant &e : participants)
+  {
+    for (int digits{15}; digits <= 17; digits++)
+    {
+      snprintf(number, sizeof(number), "%.*g", digits, e.coefficient);
+      if (strtod(number, nullptr) == e.coefficient)
+        break;
+    }
+    result += (result.empty() ? "" : " ") + to_string(e.metabolite) + ":" + number;
+  }
+  return result;
 }
 
-void Model::setNumberOfReactions(const int &e)
+const string &Reaction::getGenReaction() const
 {
-  numberOfReactions = e;
+  return genReaction.getText();
 }
 
-void Model::setObjetiveExpression(const string &e)
+void Reaction::setId(const int &e)
 {
-  objetiveExpression = e;
+  id = e;
 }
 
-void Model::setCompartments(const string &e)
+void Reaction::setName(const string &e)
 {
-  compartments = e;
+  name = e;
 }
 
-string Model::toString()
+void Reaction::setStoichiometry(const string &e)
 {
-  string result{""};
+  stoichiometry = toStoichiometry(e);
+}
 
-  result += "\nNombre: " + name;
-  // result += "\nDireccion de memoria: " + to_string(memoryDirection);
-  result += "\nNumero de Metabolitos: " + to_string(numberOfMetabolites);
-  result += "\nNumero de Reacciones: " + to_string(numberOfReactions);
-  result += "\nExpresion Objetivo: " + objetiveExpression;
-  result += "\nCompartimentos: " + compartments;
+void Reaction::setStoichiometry(const Stoichiometry &e)
+{
+  stoichiometry = e;
+}
 
-  return result;
+void Reaction::setLowerLimit(const int &e)
+{
+  lowerLimit = e;
 }
 
-int Model::optionList()
+void Reaction::setHigherLimit(const int &e)
 {
-  int option{0};
-  cout << "\n0.Salir\n";
-  cout << "1.Agregar\n";
-  cout << "2.Acceder\n";
-  cout << "3.Buscar\n";
-  cout << "4.Editar\n";
-  cout << "5.Eliminar\n";
-  cout << "6.Ordenar\n";
-  cin >> option;
-  return option;
+  higherLimit = e;
 }
 
-Node<Reaction> *Model::searchReaction()
+void Reaction::setParticipants(const vector<Participant> &e)
 {
-  Node<Reaction> *auxNodeReaction{nullptr};
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  reactionAux.setName(stringAux);
-  auxNodeReaction = reactionList.binarySearch(reactionAux);
-  if (auxNodeReaction == nullptr)
-  {
-    cout << "\nNo encontrado...\n";
-  }
-  return auxNodeReaction;
+  participants = e;
 }
 
-Node<Metabolite> *Model::searchMetabolite()
+void Reaction::setParticipants(vector<Participant> &&e)
 {
-  Node<Metabolite> *auxNodeMetabolite{nullptr};
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  metaboliteAux.setName(stringAux);
-  auxNodeMetabolite = metaboliteList.binarySearch(metaboliteAux);
-  if (auxNodeMetabolite == nullptr)
-  {
-    cout << "\nNo encontrado...\n";
-    return nullptr;
-  }
-  return auxNodeMetabolite;
+  participants = std::move(e);
 }
 
-Node<Gen> *Model::searchGen()
+// Adds a participant, merging it with an existing entry for the same metabolite
+void Reaction::addParticipant(const int &metabolite, const double &coefficient)
 {
-  Node<Gen> *auxNodeGen{nullptr};
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  genAux.setName(stringAux);
-  auxNodeGen = genList.binarySearch(genAux);
-  if (auxNodeGen == nullptr)
+  for (Participant &e : participants)
   {
-    cout << "\nNo encontrado...\n";
+    if (e.metabolite == metabolite)
+    {
+      e.coefficient += coefficient;
+      return;
+    }
   }
-  return auxNodeGen;
+  participants.push_back({metabolite, coefficient});
 }
 
-Node<Reaction> *Model::insertReaction()
+void Reaction::setGenReaction(const string &e)
 {
-  Node<Metabolite> *auxNodeMetabolite{nullptr};
-
-  cout << "Id: ";
-  cin >> intAux;
-  reactionAux.setId(intAux);
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  reactionAux.setName(stringAux);
-  cout << "Estequiometria: \n";
-  cout << "1. ->\n";
-  cout << "2. <-\n";
-  cout << "3. <->\n";
-  cin >> intAux;
-  if (intAux == 1)
-  {
-    stringAux = "->";
-  }
-  else if (intAux == 2)
-  {
-    stringAux = "<-";
-  }
-  else
-  {
-    stringAux = "<->";
-  }
-  reactionAux.setStoichiometry(stringAux);
-  cout << "Limite inferior: ";
-  cin >> intAux;
-  reactionAux.setLowerLimit(intAux);
-  cout << "Limite superior: ";
-  cin >> intAux;
-  reactionAux.setHigherLimit(intAux);
+  genReaction = e;
+}
 
-  cout << "\nMetabolitos\n";
-  string stringMetabolites{""};
+string Reaction::toString()
+{
+  string result{""};
+  result += "\nId: " + to_string(id);
+  result += "\nNombre: " + getName();
+  result += "\nEstequiometria: " + getEstequiometria();
+  result += "\nLimite Inferior: " + to_string(lowerLimit);
+  result += "\nLimite Superior: " + to_string(higherLimit);
+  result += "\nGen-Reaccion: " + getGenReaction();
+  result += "\nMetabolitos: " + getParticipantsText();
+
+  return result;
+};
+
+Reaction &Reaction::operator=(const Reaction &e)
+{
+  id = e.id;
+  name = e.name;
+  stoichiometry = e.stoichiometry;
+  lowerLimit = e.lowerLimit;
+  higherLimit = e.higherLimit;
+  genReaction = e.genReaction;
+  participants = e.participants;
+  return *this;
+}
+
+Reaction &Reaction::operator=(Reaction &&e) noexcept
+{
+  id = e.id;
+  name = std::move(e.name);
+  stoichiometry = e.stoichiometry;
+  lowerLimit = e.lowerLimit;
+  higherLimit = e.higherLimit;
+  genReaction = std::move(e.genReaction);
+  participants = std::move(e.participants);
+  return *this;
+}
+
+bool Reaction::operator==(const Reaction &e) const
+{
+  return name == e.name;
+}
+
+bool Reaction::operator>(const Reaction &e) const
+{
+  return name > e.name;
+}
+
+//* -------- ------- ------ ----- Metabolitos ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+class Metabolite
+{
+private:
+  int id;
+  Symbol name;
+  Symbol chemicalForm;
+  Symbol compartment;
+
+public:
+  Metabolite();
+  Metabolite(const int &, const string &, const string &, const string &);
+
+  int getId() const;
+  const string &getName() const;
+  const string &getChemicalForm() const;
+  const string &getCompartment() const;
+
+  void setId(const int &);
+  void setName(const string &);
+  void setChemicalForm(const string &);
+  void setCompartment(const string &);
+
+  string toString();
+
+  bool operator==(const Metabolite &) const;
+  bool operator>(const Metabolite &) const;
+};
+
+Metabolite::Metabolite() : id(0) {}
+
+Metabolite::Metabolite(const int &i, const string &n, const string &f, const string &c) : id(i), name(n), chemicalForm(f), compartment(c) {}
+
+int Metabolite::getId() const
+{
+  return id;
+}
+
+const string &Metabolite::getName() const
+{
+  return name.getText();
+}
+
+const string &Metabolite::getChemicalForm() const
+{
+  return chemicalForm.getText();
+}
+
+const string &Metabolite::getCompartment() const
+{
+  return compartment.getText();
+}
+
+void Metabolite::setId(const int &e)
+{
+  id = e;
+}
+
+void Metabolite::setName(const string &e)
+{
+  name = e;
+}
+
+void Metabolite::setChemicalForm(const string &e)
+{
+  chemicalForm = e;
+}
+
+void Metabolite::setCompartment(const string &e)
+{
+  compartment = e;
+}
+
+string Metabolite::toString()
+{
+  string result{""};
+  result += "\nId: " + to_string(id);
+  result += "\nNombre: " + getName();
+  result += "\nFormula quimica: " + getChemicalForm();
+  result += "\nCompartimiento: " + getCompartment();
+
+  return result;
+}
+
+bool Metabolite::operator==(const Metabolite &e) const
+{
+  return name == e.name;
+}
+
+bool Metabolite::operator>(const Metabolite &e) const
+{
+  return name > e.name;
+}
+
+//* -------- ------- ------ ----- Genes ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+class Gen
+{
+private:
+  int id;
+  Symbol name;
+  Symbol functional;
+  Symbol genReaction;
+
+public:
+  Gen();
+  Gen(const int &, const string &, const string &, const string &);
+
+  int getId() const;
+  const string &getName() const;
+  const string &getFunctional() const;
+  const string &getGenReaction() const;
+
+  void setId(const int &);
+  void setName(const string &);
+  void setFunctional(const string &);
+  void setGenReaction(const string &);
+
+  string toString();
+
+  bool operator==(const Gen &) const;
+  bool operator>(const Gen &) const;
+};
+
+Gen::Gen() : id(0) {}
+
+Gen::Gen(const int &i, const string &n, const string &f, const string &g) : id(i), name(n), functional(f), genReaction(g) {}
+
+int Gen::getId() const
+{
+  return id;
+}
+
+const string &Gen::getName() const
+{
+  return name.getText();
+}
+
+const string &Gen::getFunctional() const
+{
+  return functional.getText();
+}
+
+const string &Gen::getGenReaction() const
+{
+  return genReaction.getText();
+}
+
+void Gen::setId(const int &e)
+{
+  id = e;
+}
+
+void Gen::setName(const string &e)
+{
+  name = e;
+}
+
+void Gen::setFunctional(const string &e)
+{
+  functional = e;
+}
+
+void Gen::setGenReaction(const string &e)
+{
+  genReaction = e;
+}
+
+string Gen::toString()
+{
+  string result{""};
+  result += "\nId: " + to_string(id);
+  result += "\nNombre: " + getName();
+  result += "\nFuncional: " + getFunctional();
+  result += "\nReaccion: " + getGenReaction();
+
+  return result;
+}
+
+bool Gen::operator==(const Gen &e) const
+{
+  return name == e.name;
+}
+
+bool Gen::operator>(const Gen &e) const
+{
+  return name > e.name;
+}
+
+//* -------- ------- ------ ----- Regla Gen-Reaccion ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Boolean gene association such as "b0001 and (b0002 or b0003)", "and" binds tighter than "or"
+class GeneRule
+{
+public:
+  enum Type
+  {
+    GENE,
+    AND,
+    OR
+  };
+
+  struct Term
+  {
+    Type type;
+    string gene;
+    vector<int> operands;
+  };
+
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  GeneRule();
+  explicit GeneRule(const string &);
+
+  bool isEmpty() const;
+  int getRoot() const;
+  const Term &getTerm(const int &) const;
+  vector<string> getGenes() const;
+
+  bool evaluate(const function<bool(const string &)> &) const;
+
+  string toString() const;
+
+private:
+  vector<Term> terms;
+  int root;
+
+  vector<string> tokens;
+  size_t current;
+
+  int parseOr();
+  int parseAnd();
+  int parseTerm();
+  int add(const Type &, const string &, const vector<int> &);
+
+  bool evaluate(const int &, const function<bool(const string &)> &) const;
+  string toString(const int &, const bool &) const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+GeneRule::GeneRule() : root(-1), current(0) {}
+
+GeneRule::GeneRule(const string &e) : root(-1), current(0)
+{
+  string token;
+
+  for (char c : e + " ")
+  {
+    if (c == '(' or c == ')' or isspace(static_cast<unsigned char>(c)))
+    {
+      if (!token.empty())
+        tokens.push_back(token);
+      token.clear();
+      if (c == '(' or c == ')')
+        tokens.push_back(string(1, c));
+    }
+    else
+    {
+      token += c;
+    }
+  }
+
+  if (!tokens.empty())
+  {
+    root = parseOr();
+    if (current != tokens.size())
+    {
+      throw Exception("Regla invalida: " + e);
+    }
+  }
+  tokens.clear();
+}
+
+int GeneRule::add(const Type &type, const string &gene, const vector<int> &operands)
+{
+  Term term;
+  term.type = type;
+  term.gene = gene;
+  term.operands = operands;
+  terms.push_back(term);
+  return int(terms.size()) - 1;
+}
+
+int GeneRule::parseOr()
+{
+  vector<int> operands{parseAnd()};
+
+  while (current < tokens.size() and (tokens[current] == "or" or tokens[current] == "OR"))
+  {
+    current++;
+    operands.push_back(parseAnd());
+  }
+  return operands.size() == 1 ? operands[0] : add(OR, "", operands);
+}
+
+int GeneRule::parseAnd()
+{
+  vector<int> operands{parseTerm()};
+
+  while (current < tokens.size() and (tokens[current] == "and" or tokens[current] == "AND"))
+  {
+    current++;
+    operands.push_back(parseTerm());
+  }
+  return operands.size() == 1 ? operands[0] : add(AND, "", operands);
+}
+
+int GeneRule::parseTerm()
+{
+  if (current >= tokens.size())
+  {
+    throw Exception("Regla incompleta");
+  }
+
+  string token{tokens[current++]};
+
+  if (token == "(")
+  {
+    int result{parseOr()};
+    if (current >= tokens.size() or tokens[current++] != ")")
+    {
+      throw Exception("Falta ')' en la regla");
+    }
+    return result;
+  }
+  if (token == ")" or token == "and" or token == "or" or token == "AND" or token == "OR")
+  {
+    throw Exception("Token inesperado en la regla: " + token);
+  }
+  return add(GENE, token, vector<int>());
+}
+
+bool GeneRule::isEmpty() const
+{
+  return root < 0;
+}
+
+int GeneRule::getRoot() const
+{
+  return root;
+}
+
+const GeneRule::Term &GeneRule::getTerm(const int &e) const
+{
+  return terms[e];
+}
+
+vector<string> GeneRule::getGenes() const
+{
+  vector<string> result;
+
+  for (const Term &term : terms)
+  {
+    if (term.type == GENE)
+      result.push_back(term.gene);
+  }
+  return result;
+}
+
+bool GeneRule::evaluate(const int &index, const function<bool(const string &)> &active) const
+{
+  const Term &term{terms[index]};
+
+  if (term.type == GENE)
+    return active(term.gene);
+
+  for (int e : term.operands)
+  {
+    if (evaluate(e, active) != (term.type == AND))
+      return term.type != AND;
+  }
+  return term.type == AND;
+}
+
+// Whether the reaction can run given which genes are active. A reaction without a rule does not depend on genes
+bool GeneRule::evaluate(const function<bool(const string &)> &active) const
+{
+  return isEmpty() or evaluate(root, active);
+}
+
+string GeneRule::toString(const int &index, const bool &nested) const
+{
+  const Term &term{terms[index]};
+
+  if (term.type == GENE)
+    return term.gene;
+
+  string result{""};
+  for (size_t i{0}; i < term.operands.size(); i++)
+  {
+    result += (i == 0 ? "" : term.type == AND ? " and " : " or ") + toString(term.operands[i], true);
+  }
+  return nested ? "(" + result + ")" : result;
+}
+
+string GeneRule::toString() const
+{
+  return isEmpty() ? "" : toString(root, false);
+}
+
+//* -------- ------- ------ ----- Matriz Estequiometrica ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Sparse stoichiometric matrix S (metabolites x reactions) kept both column (CSC) and row (CSR) compressed.
+// Rows follow the metabolite list order and columns the reaction list order at the time it was built. Rows and
+// columns appended afterwards only reach the CSR side after transpose()
+class StoichiometricMatrix
+{
+private:
+  vector<Node<Metabolite> *> metabolites;
+  vector<Node<Reaction> *> reactions;
+  unordered_map<int, int> rowOf; //metabolite id -> row, the first metabolite wins
+
+  vector<int> columnStart;
+  vector<int> rowIndex;
+  vector<double> columnValue;
+
+  vector<int> rowStart;
+  vector<int> columnIndex;
+  vector<double> rowValue;
+
+  long unresolved;
+
+public:
+  StoichiometricMatrix();
+
+  void build(const List<Reaction> &, const List<Metabolite> &);
+  void appendMetabolite(Node<Metabolite> *);
+  void appendReaction(Node<Reaction> *);
+  void transpose();
+  void addRow(const vector<double> &);
+
+  int getRows() const;
+  int getColumns() const;
+  int getNonZeros() const;
+  long getUnresolved() const;
+  size_t getBytes() const;
+
+  Node<Metabolite> *getMetabolite(const int &) const;
+  Node<Reaction> *getReaction(const int &) const;
+
+  const vector<int> &getColumnStart() const;
+  const vector<int> &getRowIndex() const;
+  const vector<double> &getColumnValue() const;
+  const vector<int> &getRowStart() const;
+  const vector<int> &getColumnIndex() const;
+  const vector<double> &getRowValue() const;
+
+  double get(const int &, const int &) const; //row, column
+
+  void multiply(const vector<double> &, vector<double> &) const;
+  void multiplyTransposed(const vector<double> &, vector<double> &) const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+StoichiometricMatrix::StoichiometricMatrix() : columnStart(1, 0), rowStart(1, 0), unresolved(0) {}
+
+void StoichiometricMatrix::build(const List<Reaction> &reactionList, const List<Metabolite> &metaboliteList)
+{
+  metabolites.clear();
+  reactions.clear();
+  rowOf.clear();
+  columnStart.assign(1, 0);
+  rowIndex.clear();
+  columnValue.clear();
+  unresolved = 0;
+
+  for (Node<Metabolite> *aux{metaboliteList.getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    appendMetabolite(aux);
+  }
+  for (Node<Reaction> *aux{reactionList.getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    appendReaction(aux);
+  }
+  transpose();
+}
+
+// Adds an empty row, the columns already in the matrix keep their participants on this id unresolved
+void StoichiometricMatrix::appendMetabolite(Node<Metabolite> *position)
+{
+  rowOf.emplace(position->getDataPtr()->getId(), int(metabolites.size()));
+  metabolites.push_back(position);
+}
+
+void StoichiometricMatrix::appendReaction(Node<Reaction> *position)
+{
+  vector<pair<int, double>> column;
+
+  for (const Reaction::Participant &e : position->getDataPtr()->getParticipants())
+  {
+    auto found{rowOf.find(e.metabolite)};
+    if (found == rowOf.end())
+    {
+      unresolved++;
+      continue;
+    }
+    if (e.coefficient != 0)
+      column.push_back(make_pair(found->second, e.coefficient));
+  }
+  sort(column.begin(), column.end());
+
+  for (size_t i{0}; i < column.size(); i++)
+  {
+    if (i > 0 and column[i].first == column[i - 1].first)
+    {
+      columnValue.back() += column[i].second;
+      continue;
+    }
+    rowIndex.push_back(column[i].first);
+    columnValue.push_back(column[i].second);
+  }
+  columnStart.push_back(int(rowIndex.size()));
+  reactions.push_back(position);
+}
+
+// CSR is the transpose of CSC: count per row, prefix sum, then scatter in column order
+void StoichiometricMatrix::transpose()
+{
+  rowStart.assign(metabolites.size() + 1, 0);
+  columnIndex.resize(rowIndex.size());
+  rowValue.resize(rowIndex.size());
+  for (int row : rowIndex)
+  {
+    rowStart[row + 1]++;
+  }
+  for (size_t i{0}; i < metabolites.size(); i++)
+  {
+    rowStart[i + 1] += rowStart[i];
+  }
+  vector<int> next(rowStart.begin(), rowStart.end() - 1);
+  for (int j{0}; j < getColumns(); j++)
+  {
+    for (int k{columnStart[j]}; k < columnStart[j + 1]; k++)
+    {
+      int position{next[rowIndex[k]]++};
+      columnIndex[position] = j;
+      rowValue[position] = columnValue[k];
+    }
+  }
+}
+
+// Appends a row that belongs to no metabolite (getMetabolite returns nullptr), one coefficient per column. Used to
+// add linear constraints such as the objective to a copy of S
+void StoichiometricMatrix::addRow(const vector<double> &coefficients)
+{
+  int row{getRows()};
+  vector<int> start(1, 0);
+  vector<int> index;
+  vector<double> value;
+
+  index.reserve(rowIndex.size() + reactions.size());
+  value.reserve(rowIndex.size() + reactions.size());
+  for (int j{0}; j < getColumns(); j++)
+  {
+    index.insert(index.end(), rowIndex.begin() + columnStart[j], rowIndex.begin() + columnStart[j + 1]);
+    value.insert(value.end(), columnValue.begin() + columnStart[j], columnValue.begin() + columnStart[j + 1]);
+    if (j < int(coefficients.size()) and coefficients[j] != 0)
+    {
+      index.push_back(row);
+      value.push_back(coefficients[j]);
+      columnIndex.push_back(j);
+      rowValue.push_back(coefficients[j]);
+    }
+    start.push_back(int(index.size()));
+  }
+
+  columnStart.swap(start);
+  rowIndex.swap(index);
+  columnValue.swap(value);
+  rowStart.push_back(int(columnIndex.size()));
+  metabolites.push_back(nullptr);
+}
+
+int StoichiometricMatrix::getRows() const
+{
+  return int(metabolites.size());
+}
+
+int StoichiometricMatrix::getColumns() const
+{
+  return int(reactions.size());
+}
+
+int StoichiometricMatrix::getNonZeros() const
+{
+  return int(rowIndex.size());
+}
+
+// Participants whose metabolite id is not in the model, left out of the matrix
+long StoichiometricMatrix::getUnresolved() const
+{
+  return unresolved;
+}
+
+size_t StoichiometricMatrix::getBytes() const
+{
+  return (columnStart.size() + rowIndex.size() + rowStart.size() + columnIndex.size()) * sizeof(int) + (columnValue.size() + rowValue.size()) * sizeof(double);
+}
+
+Node<Metabolite> *StoichiometricMatrix::getMetabolite(const int &e) const
+{
+  return metabolites[e];
+}
+
+Node<Reaction> *StoichiometricMatrix::getReaction(const int &e) const
+{
+  return reactions[e];
+}
+
+const vector<int> &StoichiometricMatrix::getColumnStart() const
+{
+  return columnStart;
+}
+
+const vector<int> &StoichiometricMatrix::getRowIndex() const
+{
+  return rowIndex;
+}
+
+const vector<double> &StoichiometricMatrix::getColumnValue() const
+{
+  return columnValue;
+}
+
+const vector<int> &StoichiometricMatrix::getRowStart() const
+{
+  return rowStart;
+}
+
+const vector<int> &StoichiometricMatrix::getColumnIndex() const
+{
+  return columnIndex;
+}
+
+const vector<double> &StoichiometricMatrix::getRowValue() const
+{
+  return rowValue;
+}
+
+double StoichiometricMatrix::get(const int &row, const int &column) const
+{
+  auto begin{rowIndex.begin() + columnStart[column]};
+  auto end{rowIndex.begin() + columnStart[column + 1]};
+  auto found{lower_bound(begin, end, row)};
+
+  return found != end and *found == row ? columnValue[found - rowIndex.begin()] : 0;
+}
+
+// result = S * x, x has one value per reaction
+void StoichiometricMatrix::multiply(const vector<double> &x, vector<double> &result) const
+{
+  result.assign(metabolites.size(), 0);
+  for (int j{0}; j < getColumns(); j++)
+  {
+    if (x[j] == 0)
+      continue;
+    for (int k{columnStart[j]}; k < columnStart[j + 1]; k++)
+    {
+      result[rowIndex[k]] += columnValue[k] * x[j];
+    }
+  }
+}
+
+// result = S' * y, y has one value per metabolite
+void StoichiometricMatrix::multiplyTransposed(const vector<double> &y, vector<double> &result) const
+{
+  result.assign(reactions.size(), 0);
+  for (int i{0}; i < getRows(); i++)
+  {
+    if (y[i] == 0)
+      continue;
+    for (int k{rowStart[i]}; k < rowStart[i + 1]; k++)
+    {
+      result[columnIndex[k]] += rowValue[k] * y[i];
+    }
+  }
+}
+
+//* -------- ------- ------ ----- Kernels de Limites ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Batch operations over reaction bound columns. The vector path is picked at compile time (AVX2 with -mavx2 or
+// -march=native, SSE2 on any x86-64 with GCC or Clang); the scalar versions are the reference and handle the rows
+// left over
+class BoundKernels
+{
+public:
+  static const char *getInstructionSet();
+
+  static size_t findInverted(const int *, const int *, const size_t &, int *); //rows with lower > higher, returns how many
+  static void clamp(int *, const size_t &, const int &, const int &);
+  static void applyStoichiometry(const Reaction::Stoichiometry *, int *, int *, const size_t &);
+  static void scale(int *, const size_t &, const double &);
+  static size_t countOpen(const int *, const int *, const size_t &, const int &);
+
+  static size_t findInvertedScalar(const int *, const int *, const size_t &, int *);
+  static void clampScalar(int *, const size_t &, const int &, const int &);
+  static void applyStoichiometryScalar(const Reaction::Stoichiometry *, int *, int *, const size_t &);
+  static void scaleScalar(int *, const size_t &, const double &);
+  static size_t countOpenScalar(const int *, const int *, const size_t &, const int &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+const char *BoundKernels::getInstructionSet()
+{
+#if defined(BOUNDS_AVX2)
+  return "AVX2";
+#elif defined(BOUNDS_SSE2)
+  return "SSE2";
+#else
+  return "escalar";
+#endif
+}
+
+size_t BoundKernels::findInvertedScalar(const int *lower, const int *higher, const size_t &n, int *rows)
+{
+  size_t found{0};
+
+  for (size_t i{0}; i < n; i++)
+  {
+    if (lower[i] > higher[i])
+      rows[found++] = int(i);
+  }
+  return found;
+}
+
+void BoundKernels::clampScalar(int *values, const size_t &n, const int &minimum, const int &maximum)
+{
+  for (size_t i{0}; i < n; i++)
+    values[i] = values[i] < minimum ? minimum : values[i] > maximum ? maximum : values[i];
+}
+
+// Irreversible reactions get the sign their arrow implies: "->" cannot run backwards and "<-" cannot run forwards
+void BoundKernels::applyStoichiometryScalar(const Reaction::Stoichiometry *stoichiometries, int *lower, int *higher, const size_t &n)
+{
+  for (size_t i{0}; i < n; i++)
+  {
+    if (stoichiometries[i] == Reaction::FORWARD and lower[i] < 0)
+      lower[i] = 0;
+    if (stoichiometries[i] == Reaction::BACKWARD and higher[i] > 0)
+      higher[i] = 0;
+  }
+}
+
+// Rounds to nearest (ties to even, as the vector conversions do) and saturates to the int range
+void BoundKernels::scaleScalar(int *values, const size_t &n, const double &factor)
+{
+  for (size_t i{0}; i < n; i++)
+  {
+    double value{values[i] * factor};
+    value = value < INT_MIN ? INT_MIN : value > INT_MAX ? INT_MAX : value;
+    values[i] = int(nearbyint(value));
+  }
+}
+
+// Bounds at or beyond +-infinity count as open
+size_t BoundKernels::countOpenScalar(const int *lower, const int *higher, const size_t &n, const int &infinity)
+{
+  size_t result{0};
+
+  for (size_t i{0}; i < n; i++)
+    result += (lower[i] <= -infinity or higher[i] >= infinity) ? 1 : 0;
+  return result;
+}
+
+#if defined(BOUNDS_AVX2)
+
+size_t BoundKernels::findInverted(const int *lower, const int *higher, const size_t &n, int *rows)
+{
+  size_t found{0}, i{0};
+
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i inverted{_mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(lower + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(higher + i)))};
+    int mask{_mm256_movemask_ps(_mm256_castsi256_ps(inverted))};
+    for (; mask != 0; mask &= mask - 1)
+      rows[found++] = int(i) + __builtin_ctz(mask);
+  }
+
+  size_t tail{findInvertedScalar(lower + i, higher + i, n - i, rows + found)};
+  for (size_t k{found}; k < found + tail; k++)
+    rows[k] += int(i);
+  return found + tail;
+}
+
+void BoundKernels::clamp(int *values, const size_t &n, const int &minimum, const int &maximum)
+{
+  __m256i low{_mm256_set1_epi32(minimum)}, high{_mm256_set1_epi32(maximum)};
+  size_t i{0};
+
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i *at{reinterpret_cast<__m256i *>(values + i)};
+    _mm256_storeu_si256(at, _mm256_min_epi32(_mm256_max_epi32(_mm256_loadu_si256(at), low), high));
+  }
+  clampScalar(values + i, n - i, minimum, maximum);
+}
+
+void BoundKernels::applyStoichiometry(const Reaction::Stoichiometry *stoichiometries, int *lower, int *higher, const size_t &n)
+{
+  __m256i zero{_mm256_setzero_si256()};
+  __m256i forward{_mm256_set1_epi32(Reaction::FORWARD)}, backward{_mm256_set1_epi32(Reaction::BACKWARD)};
+  size_t i{0};
+
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i arrows{_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(stoichiometries + i)))};
+    __m256i *lowerAt{reinterpret_cast<__m256i *>(lower + i)};
+    __m256i *higherAt{reinterpret_cast<__m256i *>(higher + i)};
+    __m256i l{_mm256_loadu_si256(lowerAt)}, h{_mm256_loadu_si256(higherAt)};
+
+    _mm256_storeu_si256(lowerAt, _mm256_blendv_epi8(l, _mm256_max_epi32(l, zero), _mm256_cmpeq_epi32(arrows, forward)));
+    _mm256_storeu_si256(higherAt, _mm256_blendv_epi8(h, _mm256_min_epi32(h, zero), _mm256_cmpeq_epi32(arrows, backward)));
+  }
+  applyStoichiometryScalar(stoichiometries + i, lower + i, higher + i, n - i);
+}
+
+void BoundKernels::scale(int *values, const size_t &n, const double &factor)
+{
+  __m256d by{_mm256_set1_pd(factor)}, low{_mm256_set1_pd(INT_MIN)}, high{_mm256_set1_pd(INT_MAX)};
+  size_t i{0};
+
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i *at{reinterpret_cast<__m128i *>(values + i)};
+    __m256d scaled{_mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(at)), by)};
+    _mm_storeu_si128(at, _mm256_cvtpd_epi32(_mm256_min_pd(_mm256_max_pd(scaled, low), high)));
+  }
+  scaleScalar(values + i, n - i, factor);
+}
+
+size_t BoundKernels::countOpen(const int *lower, const int *higher, const size_t &n, const int &infinity)
+{
+  __m256i low{_mm256_set1_epi32(1 - infinity)}, high{_mm256_set1_epi32(infinity - 1)};
+  __m256i count{_mm256_setzero_si256()};
+  size_t i{0};
+
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i open{_mm256_or_si256(_mm256_cmpgt_epi32(low, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lower + i))),
+                                 _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(higher + i)), high))};
+    count = _mm256_sub_epi32(count, open); //matching lanes are -1
+  }
+
+  alignas(32) int lanes[8];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), count);
+  size_t result{0};
+  for (int e : lanes)
+    result += e;
+  return result + countOpenScalar(lower + i, higher + i, n - i, infinity);
+}
+
+#elif defined(BOUNDS_SSE2)
+
+size_t BoundKernels::findInverted(const int *lower, const int *higher, const size_t &n, int *rows)
+{
+  size_t found{0}, i{0};
+
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i inverted{_mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lower + i)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(higher + i)))};
+    int mask{_mm_movemask_ps(_mm_castsi128_ps(inverted))};
+    for (; mask != 0; mask &= mask - 1)
+      rows[found++] = int(i) + __builtin_ctz(mask);
+  }
+
+  size_t tail{findInvertedScalar(lower + i, higher + i, n - i, rows + found)};
+  for (size_t k{found}; k < found + tail; k++)
+    rows[k] += int(i);
+  return found + tail;
+}
+
+void BoundKernels::clamp(int *values, const size_t &n, const int &minimum, const int &maximum)
+{
+  __m128i low{_mm_set1_epi32(minimum)}, high{_mm_set1_epi32(maximum)};
+  size_t i{0};
+
+  // SSE2 has no 32 bit min or max, they are built from a compare and and/andnot/or
+  auto select{[](const __m128i &mask, const __m128i &a, const __m128i &b)
+              { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }};
+
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i *at{reinterpret_cast<__m128i *>(values + i)};
+    __m128i v{_mm_loadu_si128(at)};
+    v = select(_mm_cmplt_epi32(v, low), low, v);
+    _mm_storeu_si128(at, select(_mm_cmpgt_epi32(v, high), high, v));
+  }
+  clampScalar(values + i, n - i, minimum, maximum);
+}
+
+void BoundKernels::applyStoichiometry(const Reaction::Stoichiometry *stoichiometries, int *lower, int *higher, const size_t &n)
+{
+  __m128i zero{_mm_setzero_si128()};
+  __m128i forward{_mm_set1_epi32(Reaction::FORWARD)}, backward{_mm_set1_epi32(Reaction::BACKWARD)};
+  size_t i{0};
+
+  for (; i + 4 <= n; i += 4)
+  {
+    int packed;
+    memcpy(&packed, stoichiometries + i, sizeof(packed));
+    __m128i arrows{_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero)};
+    __m128i *lowerAt{reinterpret_cast<__m128i *>(lower + i)};
+    __m128i *higherAt{reinterpret_cast<__m128i *>(higher + i)};
+    __m128i l{_mm_loadu_si128(lowerAt)}, h{_mm_loadu_si128(higherAt)};
+
+    _mm_storeu_si128(lowerAt, _mm_andnot_si128(_mm_and_si128(_mm_cmpeq_epi32(arrows, forward), _mm_cmplt_epi32(l, zero)), l));
+    _mm_storeu_si128(higherAt, _mm_andnot_si128(_mm_and_si128(_mm_cmpeq_epi32(arrows, backward), _mm_cmpgt_epi32(h, zero)), h));
+  }
+  applyStoichiometryScalar(stoichiometries + i, lower + i, higher + i, n - i);
+}
+
+void BoundKernels::scale(int *values, const size_t &n, const double &factor)
+{
+  __m128d by{_mm_set1_pd(factor)}, low{_mm_set1_pd(INT_MIN)}, high{_mm_set1_pd(INT_MAX)};
+  size_t i{0};
+
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i *at{reinterpret_cast<__m128i *>(values + i)};
+    __m128i v{_mm_loadu_si128(at)};
+    __m128d first{_mm_mul_pd(_mm_cvtepi32_pd(v), by)};
+    __m128d second{_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))), by)};
+    first = _mm_min_pd(_mm_max_pd(first, low), high);
+    second = _mm_min_pd(_mm_max_pd(second, low), high);
+    _mm_storeu_si128(at, _mm_unpacklo_epi64(_mm_cvtpd_epi32(first), _mm_cvtpd_epi32(second)));
+  }
+  scaleScalar(values + i, n - i, factor);
+}
+
+size_t BoundKernels::countOpen(const int *lower, const int *higher, const size_t &n, const int &infinity)
+{
+  __m128i low{_mm_set1_epi32(1 - infinity)}, high{_mm_set1_epi32(infinity - 1)};
+  __m128i count{_mm_setzero_si128()};
+  size_t i{0};
+
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i open{_mm_or_si128(_mm_cmpgt_epi32(low, _mm_loadu_si128(reinterpret_cast<const __m128i *>(lower + i))),
+                              _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(higher + i)), high))};
+    count = _mm_sub_epi32(count, open); //matching lanes are -1
+  }
+
+  alignas(16) int lanes[4];
+  _mm_store_si128(reinterpret_cast<__m128i *>(lanes), count);
+  size_t result{0};
+  for (int e : lanes)
+    result += e;
+  return result + countOpenScalar(lower + i, higher + i, n - i, infinity);
+}
+
+#else
+
+size_t BoundKernels::findInverted(const int *lower, const int *higher, const size_t &n, int *rows)
+{
+  return findInvertedScalar(lower, higher, n, rows);
+}
+
+void BoundKernels::clamp(int *values, const size_t &n, const int &minimum, const int &maximum)
+{
+  clampScalar(values, n, minimum, maximum);
+}
+
+void BoundKernels::applyStoichiometry(const Reaction::Stoichiometry *stoichiometries, int *lower, int *higher, const size_t &n)
+{
+  applyStoichiometryScalar(stoichiometries, lower, higher, n);
+}
+
+void BoundKernels::scale(int *values, const size_t &n, const double &factor)
+{
+  scaleScalar(values, n, factor);
+}
+
+size_t BoundKernels::countOpen(const int *lower, const int *higher, const size_t &n, const int &infinity)
+{
+  return countOpenScalar(lower, higher, n, infinity);
+}
+
+#endif
+
+//* -------- ------- ------ ----- Tablas ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Column store for entities: one contiguous vector per field, rows addressed by position. Rows keep insertion
+// order so a List built from the table matches the List it came from
+class Table
+{
+protected:
+  static const size_t lanes{64};
+
+  vector<int> ids;
+  vector<Symbol> names;
+  unordered_map<uint32_t, int> index; //name symbol -> first row with that name
+
+  void append(const int &, const Symbol &);
+  void erase(const int &);
+  void reindex();
+  void check(const int &) const;
+
+  // Counts the rows matching a predicate; full blocks have a fixed trip count so the compiler vectorizes them
+  template <class Predicate>
+  static int countRows(const size_t &, const Predicate &);
+
+public:
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  int size() const;
+  int find(const string &) const; //-1 when absent
+  int getId(const int &) const;
+  const string &getName(const int &) const;
+  const vector<int> &getIds() const;
+
+  void setId(const int &, const int &);
+  void rename(const int &, const string &);
+};
+
+class ReactionTable : public Table
+{
+private:
+  vector<Reaction::Stoichiometry> stoichiometries;
+  vector<int> lowerLimits;
+  vector<int> higherLimits;
+  vector<Symbol> genReactions;
+  vector<vector<Reaction::Participant>> participants;
+
+public:
+  ReactionTable();
+  explicit ReactionTable(const List<Reaction> &);
+
+  int add(const Reaction &);
+  Reaction get(const int &) const;
+  void edit(const int &, const int &, const string &); //same options as Model::editReaction
+  void remove(const int &);
+  void toList(List<Reaction> &) const;
+  void writeBounds(List<Reaction> &) const; //into the nodes of the list the table was built from, row by row
+
+  const vector<Reaction::Stoichiometry> &getStoichiometries() const;
+  const vector<int> &getLowerLimits() const;
+  const vector<int> &getHigherLimits() const;
+
+  int countInverted() const; //lower limit above the upper one
+  int countWithin(const int &, const int &) const;
+  int countStoichiometry(const Reaction::Stoichiometry &) const;
+  vector<int> select(const Reaction::Stoichiometry &) const;
+
+  vector<int> findInverted() const; //ids of the reactions whose lower limit is above the upper one
+  int countOpen(const int &) const;
+  void clamp(const int &, const int &);
+  void applyStoichiometry();
+  void scale(const double &);
+};
+
+class MetaboliteTable : public Table
+{
+private:
+  vector<Symbol> chemicalForms;
+  vector<Symbol> compartments;
+
+public:
+  MetaboliteTable();
+  explicit MetaboliteTable(const List<Metabolite> &);
+
+  int add(const Metabolite &);
+  Metabolite get(const int &) const;
+  void edit(const int &, const int &, const string &); //same options as Model::editMetabolite
+  void remove(const int &);
+  void toList(List<Metabolite> &) const;
+
+  int countCompartment(const string &) const;
+  vector<int> select(const string &) const; //rows in a compartment
+};
+
+class GenTable : public Table
+{
+private:
+  vector<Symbol> functionals;
+  vector<Symbol> genReactions;
+
+public:
+  GenTable();
+  explicit GenTable(const List<Gen> &);
+
+  int add(const Gen &);
+  Gen get(const int &) const;
+  void edit(const int &, const int &, const string &); //same options as Model::editGen
+  void remove(const int &);
+  void toList(List<Gen> &) const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+template <class Predicate>
+int Table::countRows(const size_t &rows, const Predicate &matches)
+{
+  int result{0};
+  size_t i{0};
+
+  for (; i + lanes <= rows; i += lanes)
+  {
+    int block{0};
+    for (size_t j{i}; j < i + lanes; j++)
+      block += matches(j) ? 1 : 0;
+    result += block;
+  }
+  for (; i < rows; i++)
+    result += matches(i) ? 1 : 0;
+  return result;
+}
+
+void Table::append(const int &id, const Symbol &name)
+{
+  ids.push_back(id);
+  names.push_back(name);
+  index.emplace(name.getId(), int(names.size()) - 1);
+}
+
+void Table::erase(const int &row)
+{
+  ids.erase(ids.begin() + row);
+  names.erase(names.begin() + row);
+  reindex();
+}
+
+void Table::reindex()
+{
+  index.clear();
+  for (int i{0}; i < int(names.size()); i++)
+    index.emplace(names[i].getId(), i);
+}
+
+void Table::check(const int &row) const
+{
+  if (row < 0 or row >= int(ids.size()))
+  {
+    throw Exception("Fila invalida: " + to_string(row));
+  }
+}
+
+int Table::size() const
+{
+  return int(ids.size());
+}
+
+int Table::find(const string &name) const
+{
+  uint32_t symbol{SymbolTable::global().find(name)};
+  if (symbol == UINT32_MAX)
+    return -1;
+
+  auto found{index.find(symbol)};
+  return found == index.end() ? -1 : found->second;
+}
+
+int Table::getId(const int &row) const
+{
+  check(row);
+  return ids[row];
+}
+
+const string &Table::getName(const int &row) const
+{
+  check(row);
+  return names[row].getText();
+}
+
+const vector<int> &Table::getIds() const
+{
+  return ids;
+}
+
+void Table::setId(const int &row, const int &id)
+{
+  check(row);
+  ids[row] = id;
+}
+
+void Table::rename(const int &row, const string &name)
+{
+  check(row);
+  names[row] = name;
+  reindex();
+}
+
+ReactionTable::ReactionTable() {}
+
+ReactionTable::ReactionTable(const List<Reaction> &e)
+{
+  for (Node<Reaction> *aux{e.getFirst()}; aux != nullptr; aux = aux->getNext())
+    add(aux->getData());
+}
+
+int ReactionTable::add(const Reaction &e)
+{
+  append(e.getId(), e.getName());
+  stoichiometries.push_back(e.getStoichiometry());
+  lowerLimits.push_back(e.getLowerLimit());
+  higherLimits.push_back(e.getHigherLimit());
+  genReactions.push_back(e.getGenReaction());
+  participants.push_back(e.getParticipants());
+  return size() - 1;
+}
+
+Reaction ReactionTable::get(const int &row) const
+{
+  check(row);
+
+  Reaction result;
+  result.setId(ids[row]);
+  result.setName(names[row].getText());
+  result.setStoichiometry(stoichiometries[row]);
+  result.setLowerLimit(lowerLimits[row]);
+  result.setHigherLimit(higherLimits[row]);
+  result.setGenReaction(genReactions[row].getText());
+  result.setParticipants(participants[row]);
+  return result;
+}
+
+void ReactionTable::edit(const int &row, const int &option, const string &value)
+{
+  check(row);
+
+  switch (option)
+  {
+  case 1:
+    ids[row] = stoi(value);
+    break;
+  case 2:
+    rename(row, value);
+    break;
+  case 3:
+    stoichiometries[row] = Reaction::toStoichiometry(value);
+    break;
+  case 4:
+    lowerLimits[row] = stoi(value);
+    break;
+  case 5:
+    higherLimits[row] = stoi(value);
+    break;
+  default:
+    break;
+  }
+}
+
+void ReactionTable::remove(const int &row)
+{
+  check(row);
+  stoichiometries.erase(stoichiometries.begin() + row);
+  lowerLimits.erase(lowerLimits.begin() + row);
+  higherLimits.erase(higherLimits.begin() + row);
+  genReactions.erase(genReactions.begin() + row);
+  participants.erase(participants.begin() + row);
+  erase(row);
+}
+
+void ReactionTable::toList(List<Reaction> &e) const
+{
+  Node<Reaction> *last{nullptr};
+
+  e.deleteAll();
+  for (int i{0}; i < size(); i++)
+    last = e.insertUnchecked(get(i), last);
+}
+
+// Only the reactions whose limits changed are written and touched, the nodes and whatever points at them stay
+void ReactionTable::writeBounds(List<Reaction> &e) const
+{
+  if (e.size() != size_t(size()))
+  {
+    throw Exception("La tabla no corresponde a la lista: " + to_string(size()) + " filas, " + to_string(e.size()) + " reacciones");
+  }
+
+  int row{0};
+  for (Node<Reaction> *aux{e.getFirst()}; aux != nullptr; aux = aux->getNext(), row++)
+  {
+    if (aux->getData().getId() != ids[row])
+    {
+      throw Exception("La tabla no corresponde a la lista en la fila " + to_string(row));
+    }
+  }
+
+  row = 0;
+  for (Node<Reaction> *aux{e.getFirst()}; aux != nullptr; aux = aux->getNext(), row++)
+  {
+    Reaction &reaction{aux->getData()};
+    if (reaction.getLowerLimit() == lowerLimits[row] and reaction.getHigherLimit() == higherLimits[row])
+      continue;
+    reaction.setLowerLimit(lowerLimits[row]);
+    reaction.setHigherLimit(higherLimits[row]);
+    e.touch(aux);
+  }
+}
+
+const vector<Reaction::Stoichiometry> &ReactionTable::getStoichiometries() const
+{
+  return stoichiometries;
+}
+
+const vector<int> &ReactionTable::getLowerLimits() const
+{
+  return lowerLimits;
+}
+
+const vector<int> &ReactionTable::getHigherLimits() const
+{
+  return higherLimits;
+}
+
+int ReactionTable::countInverted() const
+{
+  const int *lower{lowerLimits.data()};
+  const int *higher{higherLimits.data()};
+
+  return countRows(lowerLimits.size(), [=](const size_t &i)
+                   { return lower[i] > higher[i]; });
+}
+
+// Rows whose bounds lie inside [lower, higher]
+int ReactionTable::countWithin(const int &lower, const int &higher) const
+{
+  const int *lowers{lowerLimits.data()};
+  const int *highers{higherLimits.data()};
+  int l{lower}, h{higher};
+
+  return countRows(lowerLimits.size(), [=](const size_t &i)
+                   { return (lowers[i] >= l) & (highers[i] <= h); });
+}
+
+int ReactionTable::countStoichiometry(const Reaction::Stoichiometry &e) const
+{
+  const Reaction::Stoichiometry *column{stoichiometries.data()};
+  Reaction::Stoichiometry value{e};
+
+  return countRows(stoichiometries.size(), [=](const size_t &i)
+                   { return column[i] == value; });
+}
+
+vector<int> ReactionTable::select(const Reaction::Stoichiometry &e) const
+{
+  vector<int> result;
+
+  result.reserve(countStoichiometry(e));
+  for (int i{0}; i < size(); i++)
+  {
+    if (stoichiometries[i] == e)
+      result.push_back(i);
+  }
+  return result;
+}
+
+vector<int> ReactionTable::findInverted() const
+{
+  vector<int> rows(size());
+  rows.resize(BoundKernels::findInverted(lowerLimits.data(), higherLimits.data(), lowerLimits.size(), rows.data()));
+
+  for (int &e : rows)
+    e = ids[e];
+  return rows;
+}
+
+// Reactions with a bound at or beyond +-infinity
+int ReactionTable::countOpen(const int &infinity) const
+{
+  if (infinity <= 0)
+  {
+    throw Exception("Infinito invalido: " + to_string(infinity));
+  }
+  return int(BoundKernels::countOpen(lowerLimits.data(), higherLimits.data(), lowerLimits.size(), infinity));
+}
+
+void ReactionTable::clamp(const int &minimum, const int &maximum)
+{
+  if (minimum > maximum)
+  {
+    throw Exception("Rango invalido: " + to_string(minimum) + " > " + to_string(maximum));
+  }
+  BoundKernels::clamp(lowerLimits.data(), lowerLimits.size(), minimum, maximum);
+  BoundKernels::clamp(higherLimits.data(), higherLimits.size(), minimum, maximum);
+}
+
+void ReactionTable::applyStoichiometry()
+{
+  BoundKernels::applyStoichiometry(stoichiometries.data(), lowerLimits.data(), higherLimits.data(), size());
+}
+
+// Unit change, a negative factor would also swap which bound is the lower one
+void ReactionTable::scale(const double &factor)
+{
+  if (!(factor > 0))
+  {
+    throw Exception("Factor invalido: " + to_string(factor));
+  }
+  BoundKernels::scale(lowerLimits.data(), lowerLimits.size(), factor);
+  BoundKernels::scale(higherLimits.data(), higherLimits.size(), factor);
+}
+
+MetaboliteTable::MetaboliteTable() {}
+
+MetaboliteTable::MetaboliteTable(const List<Metabolite> &e)
+{
+  for (Node<Metabolite> *aux{e.getFirst()}; aux != nullptr; aux = aux->getNext())
+    add(aux->getData());
+}
+
+int MetaboliteTable::add(const Metabolite &e)
+{
+  append(e.getId(), e.getName());
+  chemicalForms.push_back(e.getChemicalForm());
+  compartments.push_back(e.getCompartment());
+  return size() - 1;
+}
+
+Metabolite MetaboliteTable::get(const int &row) const
+{
+  check(row);
+  return Metabolite(ids[row], names[row].getText(), chemicalForms[row].getText(), compartments[row].getText());
+}
+
+void MetaboliteTable::edit(const int &row, const int &option, const string &value)
+{
+  check(row);
+
+  switch (option)
+  {
+  case 1:
+    ids[row] = stoi(value);
+    break;
+  case 2:
+    rename(row, value);
+    break;
+  case 3:
+    chemicalForms[row] = value;
+    break;
+  case 4:
+    compartments[row] = value;
+    break;
+  default:
+    break;
+  }
+}
+
+void MetaboliteTable::remove(const int &row)
+{
+  check(row);
+  chemicalForms.erase(chemicalForms.begin() + row);
+  compartments.erase(compartments.begin() + row);
+  erase(row);
+}
+
+void MetaboliteTable::toList(List<Metabolite> &e) const
+{
+  Node<Metabolite> *last{nullptr};
+
+  e.deleteAll();
+  for (int i{0}; i < size(); i++)
+    last = e.insertUnchecked(get(i), last);
+}
+
+// Compares symbol ids, the text is only looked up once
+int MetaboliteTable::countCompartment(const string &e) const
+{
+  uint32_t symbol{SymbolTable::global().find(e)};
+  if (symbol == UINT32_MAX)
+    return 0;
+
+  const Symbol *column{compartments.data()};
+  return countRows(compartments.size(), [=](const size_t &i)
+                   { return column[i].getId() == symbol; });
+}
+
+vector<int> MetaboliteTable::select(const string &e) const
+{
+  vector<int> result;
+  uint32_t symbol{SymbolTable::global().find(e)};
+
+  for (int i{0}; symbol != UINT32_MAX and i < size(); i++)
+  {
+    if (compartments[i].getId() == symbol)
+      result.push_back(i);
+  }
+  return result;
+}
+
+GenTable::GenTable() {}
+
+GenTable::GenTable(const List<Gen> &e)
+{
+  for (Node<Gen> *aux{e.getFirst()}; aux != nullptr; aux = aux->getNext())
+    add(aux->getData());
+}
+
+int GenTable::add(const Gen &e)
+{
+  append(e.getId(), e.getName());
+  functionals.push_back(e.getFunctional());
+  genReactions.push_back(e.getGenReaction());
+  return size() - 1;
+}
+
+Gen GenTable::get(const int &row) const
+{
+  check(row);
+  return Gen(ids[row], names[row].getText(), functionals[row].getText(), genReactions[row].getText());
+}
+
+void GenTable::edit(const int &row, const int &option, const string &value)
+{
+  check(row);
+
+  switch (option)
+  {
+  case 1:
+    ids[row] = stoi(value);
+    break;
+  case 2:
+    rename(row, value);
+    break;
+  case 3:
+    functionals[row] = value;
+    break;
+  default:
+    break;
+  }
+}
+
+void GenTable::remove(const int &row)
+{
+  check(row);
+  functionals.erase(functionals.begin() + row);
+  genReactions.erase(genReactions.begin() + row);
+  erase(row);
+}
+
+void GenTable::toList(List<Gen> &e) const
+{
+  Node<Gen> *last{nullptr};
+
+  e.deleteAll();
+  for (int i{0}; i < size(); i++)
+    last = e.insertUnchecked(get(i), last);
+}
+
+//* -------- ------- ------ ----- Consultas ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Secondary index over one text field of a list: exact match through a hash on the interned symbol, prefix through
+// the distinct texts kept in order, substring through trigram postings over those texts. Each bucket holds a
+// reference on its symbol; a text leaves the index, its postings and the symbol table with the last entity that had
+// it, and entities are kept per symbol and follow every change
+template <class T>
+class FieldIndex
+{
+public:
+  typedef const string &(T::*Field)() const;
+
+private:
+  struct Entry
+  {
+    uint32_t symbol;
+    uint32_t position; //inside the symbol's bucket
+  };
+
+  Field field;
+  unordered_map<Node<T> *, Entry> entries;
+  unordered_map<uint32_t, vector<Node<T> *>> buckets; //symbol -> entities, never empty
+  map<string_view, uint32_t> texts;
+  unordered_map<uint32_t, vector<uint32_t>> trigrams; //3 bytes -> symbols whose text contains them
+
+  static uint32_t toTrigram(const char *);
+  static vector<uint32_t> toTrigrams(const string &); //distinct, in order
+  void addText(const uint32_t &);
+  void removeText(const uint32_t &);
+  void collect(const uint32_t &, vector<Node<T> *> &) const;
+
+public:
+  explicit FieldIndex(Field);
+  FieldIndex(const FieldIndex &) = delete;
+  FieldIndex &operator=(const FieldIndex &) = delete;
+  ~FieldIndex();
+
+  void insert(Node<T> *);
+  void erase(Node<T> *); //uses the value seen when the node was indexed, so it works after the field changed
+  void update(Node<T> *);
+  void clear();
+
+  size_t size() const;
+  size_t getTexts() const;
+
+  vector<Node<T> *> equal(const string &) const;
+  vector<Node<T> *> prefix(const string &) const;
+  vector<Node<T> *> contains(const string &) const;
+};
+
+// The indexes of one model. Model keeps it in step with its own add, edit and remove calls and rebuilds it when a
+// list changed some other way
+class Query
+{
+private:
+  FieldIndex<Reaction> reactionNames;
+  FieldIndex<Metabolite> metaboliteNames;
+  FieldIndex<Metabolite> compartments;
+  FieldIndex<Metabolite> formulas;
+  FieldIndex<Gen> genNames;
+  FieldIndex<Gen> functionals;
+
+  uint64_t reactionVersion;
+  uint64_t metaboliteVersion;
+  uint64_t genVersion;
+
+public:
+  Query();
+
+  void build(const List<Reaction> &, const List<Metabolite> &, const List<Gen> &);
+  bool isCurrent(const List<Reaction> &, const List<Metabolite> &, const List<Gen> &) const;
+  void sync(const List<Reaction> &, const List<Metabolite> &, const List<Gen> &);
+
+  void insert(Node<Reaction> *);
+  void insert(Node<Metabolite> *);
+  void insert(Node<Gen> *);
+  void erase(Node<Reaction> *);
+  void erase(Node<Metabolite> *);
+  void erase(Node<Gen> *);
+  void update(Node<Reaction> *);
+  void update(Node<Metabolite> *);
+  void update(Node<Gen> *);
+
+  const FieldIndex<Reaction> &getReactionNames() const;
+  const FieldIndex<Metabolite> &getMetaboliteNames() const;
+  const FieldIndex<Metabolite> &getCompartments() const;
+  const FieldIndex<Metabolite> &getFormulas() const;
+  const FieldIndex<Gen> &getGenNames() const;
+  const FieldIndex<Gen> &getFunctionals() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+template <class T>
+FieldIndex<T>::FieldIndex(Field e) : field(e) {}
+
+template <class T>
+FieldIndex<T>::~FieldIndex()
+{
+  clear();
+}
+
+template <class T>
+uint32_t FieldIndex<T>::toTrigram(const char *e)
+{
+  return uint32_t(uint8_t(e[0])) << 16 | uint32_t(uint8_t(e[1])) << 8 | uint32_t(uint8_t(e[2]));
+}
+
+template <class T>
+vector<uint32_t> FieldIndex<T>::toTrigrams(const string &text)
+{
+  vector<uint32_t> codes;
+  for (size_t i{0}; i + 3 <= text.size(); i++)
+    codes.push_back(toTrigram(text.data() + i));
+  std::sort(codes.begin(), codes.end());
+  codes.erase(unique(codes.begin(), codes.end()), codes.end());
+  return codes;
+}
+
+template <class T>
+void FieldIndex<T>::addText(const uint32_t &symbol)
+{
+  const string &text{SymbolTable::global().get(symbol)};
+  texts.emplace(string_view(text), symbol);
+
+  for (uint32_t code : toTrigrams(text))
+    trigrams[code].push_back(symbol);
+}
+
+// Undoes addText and drops the reference of the bucket; the text is still interned while the postings are walked
+template <class T>
+void FieldIndex<T>::removeText(const uint32_t &symbol)
+{
+  const string &text{SymbolTable::global().get(symbol)};
+  texts.erase(string_view(text));
+
+  for (uint32_t code : toTrigrams(text))
+  {
+    auto posting{trigrams.find(code)};
+    if (posting == trigrams.end())
+      continue;
+    vector<uint32_t> &symbols{posting->second};
+    auto aux{find(symbols.begin(), symbols.end(), symbol)};
+    if (aux != symbols.end())
+    {
+      *aux = symbols.back();
+      symbols.pop_back();
+    }
+    if (symbols.empty())
+      trigrams.erase(posting);
+  }
+  SymbolTable::global().release(symbol);
+}
+
+template <class T>
+void FieldIndex<T>::insert(Node<T> *node)
+{
+  uint32_t symbol{SymbolTable::global().intern((node->getData().*field)())};
+  auto bucket{buckets.find(symbol)};
+
+  if (bucket == buckets.end())
+  {
+    addText(symbol);
+    bucket = buckets.emplace(symbol, vector<Node<T> *>()).first;
+  }
+  else
+    SymbolTable::global().release(symbol); //the bucket already holds one
+  entries[node] = Entry{symbol, uint32_t(bucket->second.size())};
+  bucket->second.push_back(node);
+}
+
+template <class T>
+void FieldIndex<T>::erase(Node<T> *node)
+{
+  auto found{entries.find(node)};
+  if (found == entries.end())
+    return;
+
+  // The last node of the bucket takes the erased slot; a bucket left empty takes its text with it
+  uint32_t symbol{found->second.symbol};
+  auto bucket{buckets.find(symbol)};
+  Node<T> *moved{bucket->second.back()};
+  bucket->second[found->second.position] = moved;
+  entries[moved].position = found->second.position;
+  bucket->second.pop_back();
+  entries.erase(found);
+
+  if (bucket->second.empty())
+  {
+    buckets.erase(bucket);
+    removeText(symbol);
+  }
+}
+
+template <class T>
+void FieldIndex<T>::update(Node<T> *node)
+{
+  erase(node);
+  insert(node);
+}
+
+template <class T>
+void FieldIndex<T>::clear()
+{
+  for (const auto &e : buckets)
+    SymbolTable::global().release(e.first);
+  entries.clear();
+  buckets.clear();
+  texts.clear();
+  trigrams.clear();
+}
+
+template <class T>
+size_t FieldIndex<T>::size() const
+{
+  return entries.size();
+}
+
+template <class T>
+size_t FieldIndex<T>::getTexts() const
+{
+  return texts.size();
+}
+
+template <class T>
+void FieldIndex<T>::collect(const uint32_t &symbol, vector<Node<T> *> &result) const
+{
+  auto bucket{buckets.find(symbol)};
+  if (bucket != buckets.end())
+    result.insert(result.end(), bucket->second.begin(), bucket->second.end());
+}
+
+template <class T>
+vector<Node<T> *> FieldIndex<T>::equal(const string &e) const
+{
+  vector<Node<T> *> result;
+  uint32_t symbol{SymbolTable::global().find(e)};
+
+  if (symbol != UINT32_MAX)
+    collect(symbol, result);
+  return result;
+}
+
+template <class T>
+vector<Node<T> *> FieldIndex<T>::prefix(const string &e) const
+{
+  vector<Node<T> *> result;
+
+  for (auto aux{texts.lower_bound(e)}; aux != texts.end() and aux->first.substr(0, e.size()) == e; ++aux)
+    collect(aux->second, result);
+  return result;
+}
+
+// Candidates come from the shortest posting list among the pattern's trigrams and are checked against the text
+template <class T>
+vector<Node<T> *> FieldIndex<T>::contains(const string &e) const
+{
+  vector<Node<T> *> result;
+
+  if (e.size() < 3)
+  {
+    for (const auto &text : texts)
+    {
+      if (text.first.find(e) != string_view::npos)
+        collect(text.second, result);
+    }
+    return result;
+  }
+
+  const vector<uint32_t> *shortest{nullptr};
+  for (size_t i{0}; i + 3 <= e.size(); i++)
+  {
+    auto posting{trigrams.find(toTrigram(e.data() + i))};
+    if (posting == trigrams.end())
+      return result;
+    if (shortest == nullptr or posting->second.size() < shortest->size())
+      shortest = &posting->second;
+  }
+
+  for (uint32_t symbol : *shortest)
+  {
+    if (SymbolTable::global().get(symbol).find(e) != string::npos)
+      collect(symbol, result);
+  }
+  return result;
+}
+
+Query::Query() : reactionNames(&Reaction::getName), metaboliteNames(&Metabolite::getName), compartments(&Metabolite::getCompartment), formulas(&Metabolite::getChemicalForm),
+                 genNames(&Gen::getName), functionals(&Gen::getFunctional), reactionVersion(0), metaboliteVersion(0), genVersion(0) {}
+
+void Query::build(const List<Reaction> &reactions, const List<Metabolite> &metabolites, const List<Gen> &genes)
+{
+  reactionNames.clear();
+  metaboliteNames.clear();
+  compartments.clear();
+  formulas.clear();
+  genNames.clear();
+  functionals.clear();
+
+  for (Node<Reaction> *aux{reactions.getFirst()}; aux != nullptr; aux = aux->getNext())
+    insert(aux);
+  for (Node<Metabolite> *aux{metabolites.getFirst()}; aux != nullptr; aux = aux->getNext())
+    insert(aux);
+  for (Node<Gen> *aux{genes.getFirst()}; aux != nullptr; aux = aux->getNext())
+    insert(aux);
+  sync(reactions, metabolites, genes);
+}
+
+bool Query::isCurrent(const List<Reaction> &reactions, const List<Metabolite> &metabolites, const List<Gen> &genes) const
+{
+  return reactionVersion == reactions.getVersion() and metaboliteVersion == metabolites.getVersion() and genVersion == genes.getVersion();
+}
+
+void Query::sync(const List<Reaction> &reactions, const List<Metabolite> &metabolites, const List<Gen> &genes)
+{
+  reactionVersion = reactions.getVersion();
+  metaboliteVersion = metabolites.getVersion();
+  genVersion = genes.getVersion();
+}
+
+void Query::insert(Node<Reaction> *e)
+{
+  reactionNames.insert(e);
+}
+
+void Query::insert(Node<Metabolite> *e)
+{
+  metaboliteNames.insert(e);
+  compartments.insert(e);
+  formulas.insert(e);
+}
+
+void Query::insert(Node<Gen> *e)
+{
+  genNames.insert(e);
+  functionals.insert(e);
+}
+
+void Query::erase(Node<Reaction> *e)
+{
+  reactionNames.erase(e);
+}
+
+void Query::erase(Node<Metabolite> *e)
+{
+  metaboliteNames.erase(e);
+  compartments.erase(e);
+  formulas.erase(e);
+}
+
+void Query::erase(Node<Gen> *e)
+{
+  genNames.erase(e);
+  functionals.erase(e);
+}
+
+void Query::update(Node<Reaction> *e)
+{
+  reactionNames.update(e);
+}
+
+void Query::update(Node<Metabolite> *e)
+{
+  metaboliteNames.update(e);
+  compartments.update(e);
+  formulas.update(e);
+}
+
+void Query::update(Node<Gen> *e)
+{
+  genNames.update(e);
+  functionals.update(e);
+}
+
+const FieldIndex<Reaction> &Query::getReactionNames() const
+{
+  return reactionNames;
+}
+
+const FieldIndex<Metabolite> &Query::getMetaboliteNames() const
+{
+  return metaboliteNames;
+}
+
+const FieldIndex<Metabolite> &Query::getCompartments() const
+{
+  return compartments;
+}
+
+const FieldIndex<Metabolite> &Query::getFormulas() const
+{
+  return formulas;
+}
+
+const FieldIndex<Gen> &Query::getGenNames() const
+{
+  return genNames;
+}
+
+const FieldIndex<Gen> &Query::getFunctionals() const
+{
+  return functionals;
+}
+
+//* -------- ------- ------ ----- Datos Derivados ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Figures that depend on the whole reaction and metabolite lists, kept up to date one change at a time: metabolites
+// per compartment, dead end metabolites and the stoichiometric matrix. A metabolite is a dead end when no reaction can
+// produce it or none can consume it; a reaction runs forward when its upper limit is positive and backward when its
+// lower limit is negative. The matrix takes appends at the tail of either list and is rebuilt lazily after anything else
+class DerivedData
+{
+private:
+  struct Contribution //one participant of a reaction as it was last seen
+  {
+    int metabolite;
+    double coefficient;
+    bool produces;
+    bool consumes;
+  };
+
+  struct Incidence //per metabolite id
+  {
+    int metabolites; //in the model with this id
+    int participants; //reaction participants that name it
+    int producers;
+    int consumers;
+  };
+
+  struct Species
+  {
+    int id;
+    Symbol compartment;
+  };
+
+  unordered_map<Node<Reaction> *, vector<Contribution>> reactions;
+  unordered_map<Node<Metabolite> *, Species> metabolites;
+  unordered_map<int, Incidence> incidence;
+  unordered_map<uint32_t, int> compartmentCounts; //compartment symbol -> metabolites
+  set<int> deadEnds;
+
+  StoichiometricMatrix matrix;
+  bool matrixValid;
+  bool matrixTransposed;
+
+  uint64_t reactionVersion;
+  uint64_t metaboliteVersion;
+
+  static vector<Contribution> toContributions(const Reaction &);
+  void apply(const vector<Contribution> &, const int &); //contributions, +1 or -1
+  void count(const Species &, const int &);
+  void refresh(const int &); //metabolite id
+
+public:
+  DerivedData();
+
+  void build(const List<Reaction> &, const List<Metabolite> &);
+  bool isCurrent(const List<Reaction> &, const List<Metabolite> &) const;
+  void sync(const List<Reaction> &, const List<Metabolite> &);
+
+  void insert(Node<Reaction> *);
+  void update(Node<Reaction> *);
+  void erase(Node<Reaction> *);
+  void insert(Node<Metabolite> *);
+  void update(Node<Metabolite> *);
+  void erase(Node<Metabolite> *);
+  void reorder(); //a list was sorted, only the matrix follows the order
+
+  int getCompartmentCount(const string &) const;
+  vector<pair<string, int>> getCompartmentCounts() const; //sorted by compartment
+  const set<int> &getDeadEnds() const;
+  const StoichiometricMatrix &getMatrix(const List<Reaction> &, const List<Metabolite> &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+DerivedData::DerivedData() : matrixValid(false), matrixTransposed(false), reactionVersion(0), metaboliteVersion(0) {}
+
+vector<DerivedData::Contribution> DerivedData::toContributions(const Reaction &e)
+{
+  vector<Contribution> result;
+  bool forward{e.getHigherLimit() > 0};
+  bool backward{e.getLowerLimit() < 0};
+
+  result.reserve(e.getParticipants().size());
+  for (const Reaction::Participant &p : e.getParticipants())
+  {
+    bool product{p.coefficient > 0}, reactant{p.coefficient < 0};
+    result.push_back({p.metabolite, p.coefficient, (product and forward) or (reactant and backward), (reactant and forward) or (product and backward)});
+  }
+  return result;
+}
+
+void DerivedData::apply(const vector<Contribution> &contributions, const int &sign)
+{
+  for (const Contribution &e : contributions)
+  {
+    Incidence &aux{incidence[e.metabolite]};
+    aux.participants += sign;
+    aux.producers += e.produces ? sign : 0;
+    aux.consumers += e.consumes ? sign : 0;
+    refresh(e.metabolite);
+  }
+}
+
+void DerivedData::count(const Species &e, const int &sign)
+{
+  if ((compartmentCounts[e.compartment.getId()] += sign) == 0)
+    compartmentCounts.erase(e.compartment.getId());
+  incidence[e.id].metabolites += sign;
+  refresh(e.id);
+}
+
+void DerivedData::refresh(const int &id)
+{
+  auto found{incidence.find(id)};
+  const Incidence &aux{found->second};
+
+  if (aux.metabolites > 0 and (aux.producers == 0 or aux.consumers == 0))
+    deadEnds.insert(id);
+  else
+    deadEnds.erase(id);
+
+  if (aux.metabolites == 0 and aux.participants == 0)
+    incidence.erase(found);
+}
+
+void DerivedData::build(const List<Reaction> &reactionList, const List<Metabolite> &metaboliteList)
+{
+  reactions.clear();
+  metabolites.clear();
+  incidence.clear();
+  compartmentCounts.clear();
+  deadEnds.clear();
+  matrixValid = false;
+
+  for (Node<Metabolite> *aux{metaboliteList.getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    insert(aux);
+  }
+  for (Node<Reaction> *aux{reactionList.getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    insert(aux);
+  }
+  matrixValid = false;
+  sync(reactionList, metaboliteList);
+}
+
+bool DerivedData::isCurrent(const List<Reaction> &reactionList, const List<Metabolite> &metaboliteList) const
+{
+  return reactionVersion == reactionList.getVersion() and metaboliteVersion == metaboliteList.getVersion();
+}
+
+void DerivedData::sync(const List<Reaction> &reactionList, const List<Metabolite> &metaboliteList)
+{
+  reactionVersion = reactionList.getVersion();
+  metaboliteVersion = metaboliteList.getVersion();
+}
+
+void DerivedData::insert(Node<Reaction> *position)
+{
+  vector<Contribution> &aux{reactions[position]};
+
+  aux = toContributions(position->getData());
+  apply(aux, 1);
+
+  // Only a new last column can be appended, anywhere else shifts the columns after it
+  if (matrixValid and position->getNext() == nullptr)
+  {
+    matrix.appendReaction(position);
+    matrixTransposed = false;
+  }
+  else
+  {
+    matrixValid = false;
+  }
+}
+
+void DerivedData::update(Node<Reaction> *position)
+{
+  vector<Contribution> &aux{reactions[position]};
+  vector<Contribution> contributions{toContributions(position->getData())};
+
+  apply(aux, -1);
+  apply(contributions, 1);
+
+  // Bounds only change the directions, the matrix holds the coefficients
+  bool same{aux.size() == contributions.size()};
+  for (size_t i{0}; same and i < aux.size(); i++)
+  {
+    same = aux[i].metabolite == contributions[i].metabolite and aux[i].coefficient == contributions[i].coefficient;
+  }
+  if (!same)
+    matrixValid = false;
+  aux.swap(contributions);
+}
+
+void DerivedData::erase(Node<Reaction> *position)
+{
+  auto found{reactions.find(position)};
+
+  if (found == reactions.end())
+    return;
+  apply(found->second, -1);
+  reactions.erase(found);
+  matrixValid = false;
+}
+
+void DerivedData::insert(Node<Metabolite> *position)
+{
+  Species &aux{metabolites[position]};
+  int id{position->getDataPtr()->getId()};
+
+  // An id some reaction already names would resolve participants of old columns, a repeated one keeps its first row
+  auto found{incidence.find(id)};
+  bool named{found != incidence.end() and found->second.participants > 0};
+  aux = {id, Symbol(position->getDataPtr()->getCompartment())};
+  count(aux, 1);
+
+  if (matrixValid and position->getNext() == nullptr and !named)
+  {
+    matrix.appendMetabolite(position);
+    matrixTransposed = false;
+  }
+  else
+  {
+    matrixValid = false;
+  }
+}
+
+void DerivedData::update(Node<Metabolite> *position)
+{
+  Species &aux{metabolites[position]};
+  Species species{position->getDataPtr()->getId(), Symbol(position->getDataPtr()->getCompartment())};
+
+  if (aux.id == species.id and aux.compartment == species.compartment)
+    return;
+  count(aux, -1);
+  count(species, 1);
+  if (aux.id != species.id)
+    matrixValid = false;
+  aux = species;
+}
+
+void DerivedData::erase(Node<Metabolite> *position)
+{
+  auto found{metabolites.find(position)};
+
+  if (found == metabolites.end())
+    return;
+  count(found->second, -1);
+  metabolites.erase(found);
+  matrixValid = false;
+}
+
+void DerivedData::reorder()
+{
+  matrixValid = false;
+}
+
+int DerivedData::getCompartmentCount(const string &e) const
+{
+  auto found{compartmentCounts.find(SymbolTable::global().find(e))};
+  return found == compartmentCounts.end() ? 0 : found->second;
+}
+
+vector<pair<string, int>> DerivedData::getCompartmentCounts() const
+{
+  vector<pair<string, int>> result;
+
+  for (const auto &e : compartmentCounts)
+  {
+    result.push_back(make_pair(SymbolTable::global().get(e.first), e.second));
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+const set<int> &DerivedData::getDeadEnds() const
+{
+  return deadEnds;
+}
+
+const StoichiometricMatrix &DerivedData::getMatrix(const List<Reaction> &reactionList, const List<Metabolite> &metaboliteList)
+{
+  if (!matrixValid)
+  {
+    matrix.build(reactionList, metaboliteList);
+    matrixValid = true;
+    matrixTransposed = true;
+  }
+  else if (!matrixTransposed)
+  {
+    matrix.transpose();
+    matrixTransposed = true;
+  }
+  return matrix;
+}
+
+//* -------- ------- ------ ----- Modelo Metabolico ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// The entity lists are shared between copies of a model and copied on the first write, so a copy costs a few
+// pointers until one of its lists changes. Every non-const access to a list (including find*, which hands out
+// positions meant for editing) makes that list private first and makes this model its listener, so the query
+// indexes and the derived data follow every later change of the list, whoever makes it.
+// Threads sharing a model hold getMutex() shared to read it (const access only, including the query, the derived
+// data and the matrix, which are built under a private lock) and unique to change it or to use its non-const lists.
+// Copying a model is a read of the original
+class Model
+{
+public:
+  typedef void (*Recorder)(void *, const Model &, const char &, const int &, const string &, const int &, const string &); //owner, model, kind, entity, element, option, value
+
+private:
+  Symbol name;
+  Node<Model> *memoryDirection; //not owned
+  Symbol objetiveExpression;
+  Symbol compartments;
+
+  shared_ptr<List<Reaction>> reactionList;
+  shared_ptr<List<Metabolite>> metaboliteList;
+  shared_ptr<List<Gen>> genList;
+
+  template <class T>
+  List<T> &detach(shared_ptr<List<T>> &);
+  template <class T>
+  void release(shared_ptr<List<T>> &);
+  template <class T>
+  static void listen(void *, const typename List<T>::Change &, Node<T> *);
+
+  mutable shared_mutex access; //never copied
+  mutable mutex building; //lazy builds from readers
+  static mutex sharing; //the copy on write bookkeeping of lists that other models may hold
+
+  mutable unique_ptr<Query> query; //built on first use, never shared between copies
+  mutable unique_ptr<DerivedData> derived;
+  void syncQuery();
+  void changed(const List<Reaction>::Change &, Node<Reaction> *);
+  void changed(const List<Metabolite>::Change &, Node<Metabolite> *);
+  void changed(const List<Gen>::Change &, Node<Gen> *);
+
+  static vector<pair<Recorder, void *>> recorders; //recorder, owner
+  static shared_mutex recording;
+
+  int intAux;
+  string stringAux;
+  Reaction reactionAux;
+  Metabolite metaboliteAux;
+  Gen genAux;
+
+  Node<Reaction> *searchReaction();
+  Node<Metabolite> *searchMetabolite();
+  Node<Gen> *searchGen();
+
+  Node<Reaction> *insertReaction();
+  void insertMetabolite();
+  Node<Gen> *insertGen();
+
+  void editReaction();
+  void editMetabolite();
+  void editGen();
+
+  int optionList();
+
+public:
+  Model();
+  Model(const Model &);
+  ~Model();
+  Model &operator=(const Model &);
+
+  const string &getName() const;
+  Node<Model> *getMemoryDirection() const;
+  int getNumberOfMetabolites() const;
+  int getNumberOfReactions() const;
+  int getNumberOfGens() const;
+  const string &getObjetiveExpression() const;
+  const string &getCompartments() const;
+
+  void setName(const string &);
+  void setMemoryDirection(Node<Model> *);
+  void setObjetiveExpression(const string &);
+  void setCompartments(const string &);
+
+  string toString() const;
+
+  List<Reaction> &getReactionList();
+  List<Metabolite> &getMetaboliteList();
+  List<Gen> &getGenList();
+  const List<Reaction> &getReactionList() const;
+  const List<Metabolite> &getMetaboliteList() const;
+  const List<Gen> &getGenList() const;
+  bool isShared() const;
+  shared_mutex &getMutex() const;
+  const Query &getQuery() const; //the first call after an outside change rebuilds it
+  const DerivedData &getDerivedData() const; //same as getQuery
+
+  Node<Reaction> *addReaction(const Reaction &);
+  Node<Reaction> *addReaction(Reaction &&);
+  Node<Metabolite> *addMetabolite(const Metabolite &);
+  Node<Metabolite> *addMetabolite(Metabolite &&);
+  Node<Gen> *addGen(const Gen &);
+  Node<Gen> *addGen(Gen &&);
+
+  Node<Reaction> *findReaction(const string &);
+  Node<Metabolite> *findMetabolite(const string &);
+  Node<Gen> *findGen(const string &);
+  Node<Reaction> *findReaction(const string &) const; //read only, the node may be shared with other copies
+  Node<Metabolite> *findMetabolite(const string &) const;
+  Node<Gen> *findGen(const string &) const;
+
+  void editReaction(Node<Reaction> *, const int &, const string &); //position, option, value
+  void editMetabolite(Node<Metabolite> *, const int &, const string &);
+  void editGen(Node<Gen> *, const int &, const string &);
+
+  void removeReaction(Node<Reaction> *);
+  void removeMetabolite(Node<Metabolite> *);
+  void removeGen(Node<Gen> *);
+
+  void sortReactions();
+  void sortMetabolites();
+  void sortGens();
+
+  StoichiometricMatrix getStoichiometricMatrix() const; //kept by the derived data
+
+  // Every recorder is told of each edit of any model before it is applied and keeps the ones of its own list, so a
+  // journal of scratch models never takes the place of the one of the live list
+  static void addRecorder(Recorder, void *);
+  static void removeRecorder(void *); //owner
+  static bool hasRecorders();
+  void tell(const char &, const int &, const string &, const int &, const string &) const; //kind, entity, element, option, value
+  void record(const int &, const string &, const int &, const string &) const; //entity (0 the model itself), element, option, value
+  void recordAdd() const; //the model itself
+  void recordAdd(const Reaction &) const;
+  void recordAdd(const Metabolite &) const;
+  void recordAdd(const Gen &) const;
+  void recordRemove(const int &, const string &) const; //entity, name
+  void recordSort(const int &) const; //entity, 0 sorts the list of models
+
+  void chooseList();
+
+  bool operator==(const Model &) const;
+  bool operator>(const Model &) const;
+};
+
+Model::Model() : memoryDirection(nullptr), reactionList(make_shared<List<Reaction>>()), metaboliteList(make_shared<List<Metabolite>>()), genList(make_shared<List<Gen>>())
+{
+  reactionList->setIndexed(true);
+  metaboliteList->setIndexed(true);
+  genList->setIndexed(true);
+  detach(reactionList);
+  detach(metaboliteList);
+  detach(genList);
+}
+
+// Shares the lists with m, the copy is not placed in any list so it has no memory direction. The lists keep m as
+// their listener until this copy writes to them
+Model::Model(const Model &m) : name(m.name), memoryDirection(nullptr), objetiveExpression(m.objetiveExpression), compartments(m.compartments), reactionList(m.reactionList), metaboliteList(m.metaboliteList), genList(m.genList) {}
+
+Model::~Model()
+{
+  release(reactionList);
+  release(metaboliteList);
+  release(genList);
+}
+
+Model &Model::operator=(const Model &m)
+{
+  if (this == &m)
+    return *this;
+
+  name = m.name;
+  objetiveExpression = m.objetiveExpression;
+  compartments = m.compartments;
+  release(reactionList);
+  release(metaboliteList);
+  release(genList);
+  reactionList = m.reactionList;
+  metaboliteList = m.metaboliteList;
+  genList = m.genList;
+  query.reset();
+  derived.reset();
+  return *this;
+}
+
+mutex Model::sharing;
+vector<pair<Model::Recorder, void *>> Model::recorders;
+shared_mutex Model::recording;
+
+// Gives this model its own copy of the list when another model still shares it, and listens to it. Whatever was
+// built while another model was listening may have missed changes, so it is dropped. A list held only by this
+// model and already listened to is the common case and takes no lock
+template <class T>
+List<T> &Model::detach(shared_ptr<List<T>> &e)
+{
+  if (e.use_count() == 1 and e->getListenerOwner() == this)
+    return *e;
+
+  lock_guard<mutex> guard(sharing);
+  if (e.use_count() > 1)
+  {
+    if (e->getListenerOwner() == this)
+      e->setListener(nullptr, nullptr);
+    e = make_shared<List<T>>(*e);
+  }
+  if (e->getListenerOwner() != this)
+  {
+    e->setListener(&Model::listen<T>, this);
+    query.reset();
+    derived.reset();
+  }
+  return *e;
+}
+
+template <class T>
+void Model::release(shared_ptr<List<T>> &e)
+{
+  lock_guard<mutex> guard(sharing);
+  if (e->getListenerOwner() == this)
+    e->setListener(nullptr, nullptr);
+}
+
+template <class T>
+void Model::listen(void *owner, const typename List<T>::Change &change, Node<T> *position)
+{
+  static_cast<Model *>(owner)->changed(change, position);
+}
+
+const string &Model::getName() const
+{
+  return name.getText();
+}
+
+Node<Model> *Model::getMemoryDirection() const
+{
+  return memoryDirection;
+}
+
+int Model::getNumberOfMetabolites() const
+{
+  return int(metaboliteList->size());
+}
+
+int Model::getNumberOfReactions() const
+{
+  return int(reactionList->size());
+}
+
+int Model::getNumberOfGens() const
+{
+  return int(genList->size());
+}
+
+const string &Model::getObjetiveExpression() const
+{
+  return objetiveExpression.getText();
+}
+
+const string &Model::getCompartments() const
+{
+  return compartments.getText();
+}
+
+void Model::setName(const string &e) // e -> element
+{
+  name = e;
+}
+
+void Model::setMemoryDirection(Node<Model> *e)
+{
+  memoryDirection = e;
+}
+
+void Model::setObjetiveExpression(const string &e)
+{
+  objetiveExpression = e;
+}
+
+void Model::setCompartments(const string &e)
+{
+  compartments = e;
+}
+
+string Model::toString() const
+{
+  string result{""};
+
+  result += "\nNombre: " + name.getText();
+  // result += "\nDireccion de memoria: " + to_string(memoryDirection);
+  result += "\nNumero de Metabolitos: " + to_string(getNumberOfMetabolites());
+  result += "\nNumero de Reacciones: " + to_string(getNumberOfReactions());
+  result += "\nNumero de Genes: " + to_string(getNumberOfGens());
+  result += "\nExpresion Objetivo: " + objetiveExpression.getText();
+  result += "\nCompartimentos: " + compartments.getText();
+
+  return result;
+}
+
+List<Reaction> &Model::getReactionList()
+{
+  return detach(reactionList);
+}
+
+List<Metabolite> &Model::getMetaboliteList()
+{
+  return detach(metaboliteList);
+}
+
+List<Gen> &Model::getGenList()
+{
+  return detach(genList);
+}
+
+const List<Reaction> &Model::getReactionList() const
+{
+  return *reactionList;
+}
+
+const List<Metabolite> &Model::getMetaboliteList() const
+{
+  return *metaboliteList;
+}
+
+const List<Gen> &Model::getGenList() const
+{
+  return *genList;
+}
+
+// Whether some list is still shared with another copy
+bool Model::isShared() const
+{
+  return reactionList.use_count() > 1 or metaboliteList.use_count() > 1 or genList.use_count() > 1;
+}
+
+shared_mutex &Model::getMutex() const
+{
+  return access;
+}
+
+Node<Reaction> *Model::addReaction(const Reaction &e)
+{
+  List<Reaction> &list{getReactionList()};
+  return list.insertUnchecked(e, list.back());
+}
+
+Node<Metabolite> *Model::addMetabolite(const Metabolite &e)
+{
+  List<Metabolite> &list{getMetaboliteList()};
+  return list.insertUnchecked(e, list.back());
+}
+
+Node<Gen> *Model::addGen(const Gen &e)
+{
+  List<Gen> &list{getGenList()};
+  return list.insertUnchecked(e, list.back());
+}
+
+Node<Reaction> *Model::addReaction(Reaction &&e)
+{
+  List<Reaction> &list{getReactionList()};
+  return list.insertUnchecked(std::move(e), list.back());
+}
+
+Node<Metabolite> *Model::addMetabolite(Metabolite &&e)
+{
+  List<Metabolite> &list{getMetaboliteList()};
+  return list.insertUnchecked(std::move(e), list.back());
+}
+
+Node<Gen> *Model::addGen(Gen &&e)
+{
+  List<Gen> &list{getGenList()};
+  return list.insertUnchecked(std::move(e), list.back());
+}
+
+Node<Reaction> *Model::findReaction(const string &e)
+{
+  return getReactionList().searchByName(e);
+}
+
+Node<Metabolite> *Model::findMetabolite(const string &e)
+{
+  return getMetaboliteList().searchByName(e);
+}
+
+Node<Gen> *Model::findGen(const string &e)
+{
+  return getGenList().searchByName(e);
+}
+
+Node<Reaction> *Model::findReaction(const string &e) const
+{
+  return reactionList->searchByName(e);
+}
+
+Node<Metabolite> *Model::findMetabolite(const string &e) const
+{
+  return metaboliteList->searchByName(e);
+}
+
+Node<Gen> *Model::findGen(const string &e) const
+{
+  return genList->searchByName(e);
+}
+
+void Model::editReaction(Node<Reaction> *position, const int &option, const string &value)
+{
+  // A position taken before this model was copied belongs to the shared list, editing it would change every copy
+  if (position == nullptr or position->getOwner() != &getReactionList())
+  {
+    throw List<Reaction>::Exception("Posicion invalida, editReaction");
+  }
+  if (option < 1 or option > 5)
+  {
+    return;
+  }
+
+  // A value that does not parse is refused before it is recorded, so every record replays
+  if (option == 1 or option == 4 or option == 5)
+    stoi(value);
+  else if (option == 3)
+    Reaction::toStoichiometry(value);
+  record(1, position->getDataPtr()->getName(), option, value);
+
+  switch (option)
+  {
+  case 1:
+    position->getDataPtr()->setId(stoi(value));
+    break;
+  case 2:
+    getReactionList().rename(position, value); //tells the listener itself
+    return;
+  case 3:
+    position->getDataPtr()->setStoichiometry(value);
+    break;
+  case 4:
+    position->getDataPtr()->setLowerLimit(stoi(value));
+    break;
+  case 5:
+    position->getDataPtr()->setHigherLimit(stoi(value));
+    break;
+  default:
+    return;
+  }
+
+  getReactionList().touch(position);
+}
+
+void Model::editMetabolite(Node<Metabolite> *position, const int &option, const string &value)
+{
+  // A position taken before this model was copied belongs to the shared list, editing it would change every copy
+  if (position == nullptr or position->getOwner() != &getMetaboliteList())
+  {
+    throw List<Metabolite>::Exception("Posicion invalida, editMetabolite");
+  }
+  if (option < 1 or option > 4)
+  {
+    return;
+  }
+
+  if (option == 1)
+    stoi(value);
+  record(2, position->getDataPtr()->getName(), option, value);
+
+  switch (option)
+  {
+  case 1:
+    position->getDataPtr()->setId(stoi(value));
+    break;
+  case 2:
+    getMetaboliteList().rename(position, value); //tells the listener itself
+    return;
+  case 3:
+    position->getDataPtr()->setChemicalForm(value);
+    break;
+  case 4:
+    position->getDataPtr()->setCompartment(value);
+    break;
+  default:
+    return;
+  }
+
+  getMetaboliteList().touch(position);
+}
+
+void Model::editGen(Node<Gen> *position, const int &option, const string &value)
+{
+  // A position taken before this model was copied belongs to the shared list, editing it would change every copy
+  if (position == nullptr or position->getOwner() != &getGenList())
+  {
+    throw List<Gen>::Exception("Posicion invalida, editGen");
+  }
+  if (option < 1 or option > 3)
+  {
+    return;
+  }
+
+  if (option == 1)
+    stoi(value);
+  record(3, position->getDataPtr()->getName(), option, value);
+
+  switch (option)
+  {
+  case 1:
+    position->getDataPtr()->setId(stoi(value));
+    break;
+  case 2:
+    getGenList().rename(position, value); //tells the listener itself
+    return;
+  case 3:
+    position->getDataPtr()->setFunctional(value);
+    break;
+  default:
+    return;
+  }
+
+  getGenList().touch(position);
+}
+
+void Model::removeReaction(Node<Reaction> *position)
+{
+  getReactionList().remove(position);
+}
+
+void Model::removeMetabolite(Node<Metabolite> *position)
+{
+  getMetaboliteList().remove(position);
+}
+
+void Model::removeGen(Node<Gen> *position)
+{
+  getGenList().remove(position);
+}
+
+void Model::sortReactions()
+{
+  getReactionList().sort();
+}
+
+void Model::sortMetabolites()
+{
+  getMetaboliteList().sort();
+}
+
+void Model::sortGens()
+{
+  getGenList().sort();
+}
+
+void Model::addRecorder(Recorder e, void *owner)
+{
+  unique_lock<shared_mutex> guard(recording);
+  recorders.emplace_back(e, owner);
+}
+
+void Model::removeRecorder(void *owner)
+{
+  unique_lock<shared_mutex> guard(recording);
+  recorders.erase(std::remove_if(recorders.begin(), recorders.end(), [owner](const pair<Recorder, void *> &e) { return e.second == owner; }), recorders.end());
+}
+
+bool Model::hasRecorders()
+{
+  shared_lock<shared_mutex> guard(recording);
+  return !recorders.empty();
+}
+
+void Model::tell(const char &kind, const int &entity, const string &element, const int &option, const string &value) const
+{
+  shared_lock<shared_mutex> guard(recording);
+  for (const pair<Recorder, void *> &e : recorders)
+    e.first(e.second, *this, kind, entity, element, option, value);
+}
+
+void Model::record(const int &entity, const string &element, const int &option, const string &value) const
+{
+  if (hasRecorders())
+    tell('E', entity, element, option, value);
+}
+
+// What the menus add is recorded as its Loader record, so replaying it reads the same fields the loader does
+void Model::recordAdd() const
+{
+  if (hasRecorders())
+    tell('A', 0, getName(), 0, "1\n" + getName() + '\n' + getObjetiveExpression() + '\n' + getCompartments() + '\n');
+}
+
+void Model::recordAdd(const Reaction &e) const
+{
+  if (hasRecorders())
+    tell('A', 1, e.getName(), 0,
+         "2\n" + to_string(e.getId()) + '\n' + e.getName() + '\n' + e.getEstequiometria() + '\n' + to_string(e.getLowerLimit()) + '\n' +
+             to_string(e.getHigherLimit()) + '\n' + e.getGenReaction() + '\n' + e.getParticipantsText() + '\n');
+}
+
+void Model::recordAdd(const Metabolite &e) const
+{
+  if (hasRecorders())
+    tell('A', 2, e.getName(), 0, "3\n" + to_string(e.getId()) + '\n' + e.getName() + '\n' + e.getChemicalForm() + '\n' + e.getCompartment() + '\n');
+}
+
+void Model::recordAdd(const Gen &e) const
+{
+  if (hasRecorders())
+    tell('A', 3, e.getName(), 0, "4\n" + to_string(e.getId()) + '\n' + e.getName() + '\n' + e.getFunctional() + '\n' + e.getGenReaction() + '\n');
+}
+
+void Model::recordRemove(const int &entity, const string &element) const
+{
+  if (hasRecorders())
+    tell('R', entity, element, 0, "");
+}
+
+void Model::recordSort(const int &entity) const
+{
+  if (hasRecorders())
+    tell('S', entity, "", 0, "");
+}
+
+void Model::syncQuery()
+{
+  query->sync(*reactionList, *metaboliteList, *genList);
+}
+
+// Listeners, called by the lists after each change. The query and derived data exist only once someone asked for
+// them, and stay current from then on while this model listens
+void Model::changed(const List<Reaction>::Change &change, Node<Reaction> *position)
+{
+  if (change == List<Reaction>::RESET)
+  {
+    query.reset();
+    derived.reset();
+    return;
+  }
+
+  if (query != nullptr)
+  {
+    if (change == List<Reaction>::INSERTED)
+      query->insert(position);
+    else if (change == List<Reaction>::UPDATED)
+      query->update(position);
+    else if (change == List<Reaction>::REMOVED)
+      query->erase(position);
+    syncQuery();
+  }
+
+  if (derived != nullptr)
+  {
+    if (change == List<Reaction>::INSERTED)
+      derived->insert(position);
+    else if (change == List<Reaction>::UPDATED)
+      derived->update(position);
+    else if (change == List<Reaction>::REMOVED)
+      derived->erase(position);
+    else
+      derived->reorder();
+    derived->sync(*reactionList, *metaboliteList);
+  }
+}
+
+void Model::changed(const List<Metabolite>::Change &change, Node<Metabolite> *position)
+{
+  if (change == List<Metabolite>::RESET)
+  {
+    query.reset();
+    derived.reset();
+    return;
+  }
+
+  if (query != nullptr)
+  {
+    if (change == List<Metabolite>::INSERTED)
+      query->insert(position);
+    else if (change == List<Metabolite>::UPDATED)
+      query->update(position);
+    else if (change == List<Metabolite>::REMOVED)
+      query->erase(position);
+    syncQuery();
+  }
+
+  if (derived != nullptr)
+  {
+    if (change == List<Metabolite>::INSERTED)
+      derived->insert(position);
+    else if (change == List<Metabolite>::UPDATED)
+      derived->update(position);
+    else if (change == List<Metabolite>::REMOVED)
+      derived->erase(position);
+    else
+      derived->reorder();
+    derived->sync(*reactionList, *metaboliteList);
+  }
+}
+
+void Model::changed(const List<Gen>::Change &change, Node<Gen> *position)
+{
+  if (change == List<Gen>::RESET)
+  {
+    query.reset();
+    return;
+  }
+
+  if (query != nullptr)
+  {
+    if (change == List<Gen>::INSERTED)
+      query->insert(position);
+    else if (change == List<Gen>::UPDATED)
+      query->update(position);
+    else if (change == List<Gen>::REMOVED)
+      query->erase(position);
+    syncQuery();
+  }
+}
+
+const Query &Model::getQuery() const
+{
+  lock_guard<mutex> guard(building);
+  if (query == nullptr)
+    query.reset(new Query());
+  if (!query->isCurrent(*reactionList, *metaboliteList, *genList))
+    query->build(*reactionList, *metaboliteList, *genList);
+  return *query;
+}
+
+const DerivedData &Model::getDerivedData() const
+{
+  lock_guard<mutex> guard(building);
+  if (derived == nullptr)
+    derived.reset(new DerivedData());
+  if (!derived->isCurrent(*reactionList, *metaboliteList))
+    derived->build(*reactionList, *metaboliteList);
+  return *derived;
+}
+
+StoichiometricMatrix Model::getStoichiometricMatrix() const
+{
+  getDerivedData();
+  lock_guard<mutex> guard(building);
+  return derived->getMatrix(*reactionList, *metaboliteList);
+}
+
+int Model::optionList()
+{
+  int option{0};
+  cout << "\n0.Salir\n";
+  cout << "1.Agregar\n";
+  cout << "2.Acceder\n";
+  cout << "3.Buscar\n";
+  cout << "4.Editar\n";
+  cout << "5.Eliminar\n";
+  cout << "6.Ordenar\n";
+  cin >> option;
+  return option;
+}
+
+Node<Reaction> *Model::searchReaction()
+{
+  Node<Reaction> *auxNodeReaction{nullptr};
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  auxNodeReaction = findReaction(stringAux);
+  if (auxNodeReaction == nullptr)
+  {
+    cout << "\nNo encontrado...\n";
+  }
+  return auxNodeReaction;
+}
+
+Node<Metabolite> *Model::searchMetabolite()
+{
+  Node<Metabolite> *auxNodeMetabolite{nullptr};
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  auxNodeMetabolite = findMetabolite(stringAux);
+  if (auxNodeMetabolite == nullptr)
+  {
+    cout << "\nNo encontrado...\n";
+    return nullptr;
+  }
+  return auxNodeMetabolite;
+}
+
+Node<Gen> *Model::searchGen()
+{
+  Node<Gen> *auxNodeGen{nullptr};
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  auxNodeGen = findGen(stringAux);
+  if (auxNodeGen == nullptr)
+  {
+    cout << "\nNo encontrado...\n";
+  }
+  return auxNodeGen;
+}
+
+Node<Reaction> *Model::insertReaction()
+{
+  Node<Metabolite> *auxNodeMetabolite{nullptr};
+
+  cout << "Id: ";
+  cin >> intAux;
+  reactionAux.setId(intAux);
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  reactionAux.setName(stringAux);
+  cout << "Estequiometria: \n";
+  cout << "1. ->\n";
+  cout << "2. <-\n";
+  cout << "3. <->\n";
+  cin >> intAux;
+  if (intAux == 1)
+  {
+    stringAux = "->";
+  }
+  else if (intAux == 2)
+  {
+    stringAux = "<-";
+  }
+  else
+  {
+    stringAux = "<->";
+  }
+  reactionAux.setStoichiometry(stringAux);
+  cout << "Limite inferior: ";
+  cin >> intAux;
+  reactionAux.setLowerLimit(intAux);
+  cout << "Limite superior: ";
+  cin >> intAux;
+  reactionAux.setHigherLimit(intAux);
+
+  cout << "\nMetabolitos\n";
+  double coefficient{0};
+  reactionAux.setParticipants(vector<Reaction::Participant>());
+  do
+  {
+    auxNodeMetabolite = searchMetabolite();
+    if (auxNodeMetabolite != nullptr)
+    {
+      cout << "Coeficiente (negativo si es reactivo): ";
+      cin >> coefficient;
+      reactionAux.addParticipant(auxNodeMetabolite->getDataPtr()->getId(), coefficient);
+    }
+    cout << "\n1. Ingresar otro\n";
+    cout << "2. Crear metabolito\n";
+    cout << "3. Salir\n";
+    cin >> intAux;
+    if (intAux == 2) {
+      insertMetabolite();
+      cout << "Coeficiente (negativo si es reactivo): ";
+      cin >> coefficient;
+      reactionAux.addParticipant(getMetaboliteList().back()->getDataPtr()->getId(), coefficient);
+    }
+  } while (intAux != 3 or reactionAux.getParticipants().empty());
+
+  try
+  {
+    return addReaction(reactionAux);
+  }
+  catch (List<Reaction>::Exception ex)
+  {
+    cout << "\n" << ex.what() << "\n";
+    return nullptr;
+  }
+}
+
+void Model::insertMetabolite()
+{
+  cout << "Id: ";
+  cin >> intAux;
+  metaboliteAux.setId(intAux);
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  metaboliteAux.setName(stringAux);
+  cout << "Formula quimica: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  metaboliteAux.setChemicalForm(stringAux);
+  cout << "Compartimiento: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  metaboliteAux.setCompartment(stringAux);
+
+  try
+  {
+    recordAdd(metaboliteAux);
+    addMetabolite(metaboliteAux);
+  }
+  catch (List<Metabolite>::Exception ex)
+  {
+    ex.what();
+  }
+}
+
+Node<Gen> *Model::insertGen()
+{
+  cout << "Id: ";
+  cin >> intAux;
+  genAux.setId(intAux);
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  genAux.setName(stringAux);
+  cout << "Funcional: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  genAux.setFunctional(stringAux);
+
+  try
+  {
+    return addGen(genAux);
+  }
+  catch (List<Gen>::Exception ex)
+  {
+    cout << "\n" << ex.what() << "\n";
+    return nullptr;
+  }
+}
+
+void Model::editReaction()
+{
+  Node<Reaction> *auxNodeReaction{nullptr};
+  auxNodeReaction = searchReaction();
+  if (auxNodeReaction == nullptr)
+    return;
+
+  cout << "\nEditar:\n";
+  cout << "1.Id\n";
+  cout << "2.Nombre\n";
+  cout << "3.Estequiometria\n";
+  cout << "4.Limite inferior\n";
+  cout << "5.Limite superior\n";
+
+  int option{0};
+  cin >> option;
+
+  switch (option)
+  {
+  case 1:
+  cout << "Id: ";
+  cin >> intAux;
+  stringAux = to_string(intAux);
+    break;
+  case 2:
+  cout << "Nombre: ";
+  cin.ignore();
+  getline(cin, stringAux);
+    break;
+  case 3:
+  cout << "Estequiometria: \n";
+  cout << "1. ->\n";
+  cout << "2. <-\n";
+  cout << "3. <->\n";
+  cin >> intAux;
+  if (intAux == 1)
+  {
+    stringAux = "->";
+  }
+  else if (intAux == 2)
+  {
+    stringAux = "<-";
+  }
+  else
+  {
+    stringAux = "<->";
+  }
+    break;
+  case 4:
+  cout << "Limite inferior: ";
+  cin >> intAux;
+  stringAux = to_string(intAux);
+    break;
+  case 5:
+  cout << "Limite superior: ";
+  cin >> intAux;
+  stringAux = to_string(intAux);
+    break;
+  default:
+    return;
+  }
+
+  editReaction(auxNodeReaction, option, stringAux);
+}
+
+void Model::editMetabolite()
+{
+  Node<Metabolite> *auxNodeMetabolite{nullptr};
+  auxNodeMetabolite = searchMetabolite();
+  if (auxNodeMetabolite == nullptr)
+    return;
+
+  cout << "\nEditar:\n";
+  cout << "1.Id\n";
+  cout << "2.Nombre\n";
+  cout << "3.Formula quimica\n";
+  cout << "4.Compartimento\n";
+
+  int option{0};
+  cin >> option;
+
+  switch (option)
+  {
+  case 1:
+    cout << "Id: ";
+    cin >> intAux;
+    stringAux = to_string(intAux);
+    break;
+  case 2:
+    cout << "Nombre: ";
+    cin.ignore();
+    getline(cin, stringAux);
+    break;
+  case 3:
+    cout << "Formula quimica: ";
+    cin.ignore();
+    getline(cin, stringAux);
+    break;
+  case 4:
+    cout << "Compartimiento: ";
+    cin.ignore();
+    getline(cin, stringAux);
+    break;
+  default:
+    return;
+  }
+
+  editMetabolite(auxNodeMetabolite, option, stringAux);
+}
+
+void Model::editGen()
+{
+  Node<Gen> *auxNodeGen{nullptr};
+  auxNodeGen = searchGen();
+  if (auxNodeGen == nullptr)
+    return;
+
+  cout << "\nEditar:\n";
+  cout << "1.Id\n";
+  cout << "2.Nombre\n";
+  cout << "3.Funcional\n";
+
+  int option{0};
+  cin >> option;
+
+  switch (option)
+  {
+  case 1:
+    cout << "Id: ";
+    cin >> intAux;
+    stringAux = to_string(intAux);
+    break;
+  case 2:
+    cout << "Nombre: ";
+    cin.ignore();
+    getline(cin, stringAux);
+    break;
+  case 3:
+    cout << "Funcional: ";
+    cin.ignore();
+    getline(cin, stringAux);
+    break;
+  default:
+    return;
+  }
+
+  editGen(auxNodeGen, option, stringAux);
+}
+
+void Model::chooseList()
+{
+  int objectOption{0};
+  int option{0};
+  Node<Reaction> *auxNodeReaction{nullptr};
+  Node<Metabolite> *auxNodeMetabolite{nullptr};
+  Node<Gen> *auxNodeGen{nullptr};
+
+  do
+  {
+    cout << "\n0.Salir\n";
+    cout << "\n1.Reacciones\n";
+    cout << "\n2.Metabolitos\n";
+    cout << "\n3.Genes\n";
+    cin >> objectOption;
+
+    do
+    {
+      option = optionList();
+
+      switch (option)
+      {
+      case 1:
+        cout << "\n1.-------- ------- ------ ----- Agregar ----- ------ ------- -------- \n";
+        if (objectOption == 1 or objectOption == 3)
+        {
+          cout << "\nGen\n\n";
+          auxNodeGen = insertGen();
+          if (auxNodeGen == nullptr)
+          {
+            cout << "\nGen no agregado...\n";
+            break;
+          }
+          cout << "\nReaccion\n\n";
+          auxNodeReaction = insertReaction();
+          if (auxNodeReaction == nullptr)
+          {
+            recordAdd(*auxNodeGen->getDataPtr());
+            cout << "\nReaccion no agregada...\n";
+            break;
+          }
+          // The reaction keeps a gene rule (the gene that catalyzes it) and the gene the reaction it belongs to; both
+          // are recorded once linked
+          auxNodeReaction->getDataPtr()->setGenReaction(auxNodeGen->getDataPtr()->getName());
+          auxNodeGen->getDataPtr()->setGenReaction(auxNodeReaction->getDataPtr()->getName());
+          recordAdd(*auxNodeGen->getDataPtr());
+          recordAdd(*auxNodeReaction->getDataPtr());
+        }
+        else
+        {
+          insertMetabolite();
+        }
+        break;
+      case 2:
+        cout << "\n2.-------- ------- ------ ----- Acceder ----- ------ ------- --------\n";
+        cout << "\nExistentes: \n";
+        if (objectOption == 1)
+        {
+          cout << reactionList->toString() << endl;
+        }
+        else if (objectOption == 2)
+        {
+          cout << metaboliteList->toString() << endl;
+        }
+        else
+        {
+          cout << genList->toString() << endl;
+        }
+        break;
+      case 3:
+        cout << "\n3.-------- ------- ------ ----- Buscar ----- ------ ------- -------- \n";
+        if (objectOption == 1)
+        {
+          auxNodeReaction = searchReaction();
+          if (auxNodeReaction != nullptr)
+          {
+            cout << "\nDato encontrado: " << auxNodeReaction << endl;
+            cout << auxNodeReaction->getDataPtr()->toString() << endl;
+          }
+        }
+        else if (objectOption == 2)
+        {
+          auxNodeMetabolite = searchMetabolite();
+          if (auxNodeMetabolite != nullptr)
+          {
+            cout << "\nDato encontrado: " << auxNodeMetabolite << endl;
+            cout << auxNodeMetabolite->getDataPtr()->toString() << endl;
+          }
+        }
+        else
+        {
+          auxNodeGen = searchGen();
+          if (auxNodeGen != nullptr)
+          {
+            cout << "\nDato encontrado: " << auxNodeGen << endl;
+            cout << auxNodeGen->getDataPtr()->toString() << endl;
+          }
+        }
+        break;
+      case 4:
+        cout << "\n4.-------- ------- ------ ----- Editar ----- ------ ------- -------- \n";
+        if (objectOption == 1)
+        {
+          editReaction();
+        }
+        else if (objectOption == 2)
+        {
+          editMetabolite();
+        }
+        else
+        {
+          editGen();
+        }
+        break;
+      case 5:
+        cout << "\n5.-------- ------- ------ ----- Eliminar ----- ------ ------- -------- \n";
+        try
+        {
+          if (objectOption == 1)
+          {
+            auxNodeReaction = searchReaction();
+            if (auxNodeReaction != nullptr)
+              recordRemove(1, auxNodeReaction->getDataPtr()->getName());
+            removeReaction(auxNodeReaction);
+          }
+          else if (objectOption == 2)
+          {
+            auxNodeMetabolite = searchMetabolite();
+            if (auxNodeMetabolite != nullptr)
+              recordRemove(2, auxNodeMetabolite->getDataPtr()->getName());
+            removeMetabolite(auxNodeMetabolite);
+          }
+          else
+          {
+            auxNodeGen = searchGen();
+            if (auxNodeGen != nullptr)
+              recordRemove(3, auxNodeGen->getDataPtr()->getName());
+            removeGen(auxNodeGen);
+          }
+          cout << "\nElemento eliminado\n";
+        }
+        catch (List<Model>::Exception ex)
+        {
+          ex.what();
+        }
+        break;
+      case 6:
+        cout << "\n6.-------- ------- ------ ----- Ordenar ----- ------ ------- --------\n";
+        recordSort(objectOption == 1 or objectOption == 2 ? objectOption : 3);
+        if (objectOption == 1)
+        {
+          sortReactions();
+        }
+        else if (objectOption == 2)
+        {
+          sortMetabolites();
+        }
+        else
+        {
+          sortGens();
+        }
+        cout << "\nElementos ordenados\n";
+        break;
+      default:
+        break;
+      }
+    } while (option != 0);
+  } while (objectOption != 0);
+}
+
+bool Model::operator==(const Model &e) const
+{
+  return name == e.name;
+}
+
+bool Model::operator>(const Model &e) const
+{
+  return name > e.name;
+}
+
+//* -------- ------- ------ ----- Interface ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+class Interface
+{
+private:
+  int option;
+  Model modelAux;
+
+  Node<Model> *search(List<Model> &);
+  void userInterface(List<Model> &);
+  int optionList();
+  void addModel(List<Model> &);
+
+public:
+  Interface(List<Model> &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Interface::Interface(List<Model> &modelList)
+{
+  userInterface(modelList);
+}
+
+int Interface::optionList()
+{
+  int option{0};
+  cout << "\n-------- ------- ------ ----- Modelo Metabolico ----- ------ ------- --------\n";
+  cout << "\n0.Salir\n";
+  cout << "1.Agregar\n";
+  cout << "2.Acceder\n";
+  cout << "3.Buscar\n";
+  cout << "4.Editar\n";
+  cout << "5.Eliminar\n";
+  cout << "6.Ordenar\n";
+  cin >> option;
+  return option;
+}
+
+void Interface::addModel(List<Model> &modelList)
+{
+  string stringAux{""};
+
+  cin.ignore();
+  cout << "\nNombre: ";
+  getline(cin, stringAux);
+  modelAux.setName(stringAux);
+
+  // cout << "Agregar Metabolito: ";
+  // cout << "Agregar Reaccion: ";
+
+  cout << "Expresion Objetivo: ";
+  getline(cin, stringAux);
+  modelAux.setObjetiveExpression(stringAux);
+
+  cout << "Compartimientos: ";
+  getline(cin, stringAux);
+  modelAux.setCompartments(stringAux);
+
+  modelList.insert(modelAux, modelList.back()); //insercion despues del punto de interes
+  // Recorded once it is in the list, which is what tells the journal it is one of its models
+  Node<Model> *added{modelList.getLast()};
+  try
+  {
+    added->getDataPtr()->recordAdd();
+  }
+  catch (...)
+  {
+    modelList.remove(added);
+    throw;
+  }
+
+  // cout << modelList.getLast();
+
+  // modelList.getLast()->getDataPtr()->setMemoryDirection(modelList.getFirst());
+}
+
+Node<Model> *Interface::search(List<Model> &modelList)
+{
+  string stringAux{""};
+  Node<Model> *auxNodeModel{nullptr};
+  cout << "Nombre del Modelo: ";
+  cin.ignore();
+  getline(cin, stringAux);
+  auxNodeModel = modelList.searchByName(stringAux);
+  if (auxNodeModel == nullptr)
+  {
+    cout << "\nModelo no encontrado...\n";
+  }
+  return auxNodeModel;
+}
+
+void Interface::userInterface(List<Model> &modelList)
+{
+  string stringAux{""};
+  Node<Model> *auxNodeModel;
+  cout << "Modelos metabolicos: \n";
   do
   {
-    auxNodeMetabolite = searchMetabolite();
-    if (auxNodeMetabolite != nullptr)
+    option = optionList();
+    switch (option)
+    {
+    case 1:
+      cout << "\n1.-------- ------- ------ ----- Agregar ----- ------ ------- -------- \n";
+      addModel(modelList);
+      break;
+    case 2:
+      cout << "\n2.-------- ------- ------ ----- Acceder ----- ------ ------- --------\n";
+      cout << "\nModelos Metabolicos Existentes: \n";
+      cout << modelList.toString() << endl;
+      auxNodeModel = search(modelList);
+      if (auxNodeModel != nullptr)
+      {
+        cout << "\nAcceso correcto: \n";
+        auxNodeModel->getDataPtr()->chooseList();
+      }
+      break;
+    case 3:
+      cout << "\n3.-------- ------- ------ ----- Buscar ----- ------ ------- -------- \n";
+      auxNodeModel = search(modelList);
+      if (auxNodeModel != nullptr)
+      {
+        cout << "\nDato encontrado: " << auxNodeModel << endl;
+        cout << auxNodeModel->getDataPtr()->toString() << endl;
+      }
+      break;
+    case 4:
+      cout << "\n4.-------- ------- ------ ----- Editar ----- ------ ------- -------- \n";
+      auxNodeModel = search(modelList);
+      if (auxNodeModel == nullptr)
+        break;
+      cout << "\n4.Editar: \n";
+      cout << "1.Nombre\n";
+      cout << "2.Expresion Objetivo: \n";
+      cout << "3.Compartimentos \n";
+      cin >> option;
+
+      cout << "\nNuevo: ";
+      cin.ignore();
+      getline(cin, stringAux);
+
+      if (option < 1 or option > 3)
+        option = 3;
+      auxNodeModel->getDataPtr()->record(0, "", option, stringAux);
+      if (option == 1)
+      {
+        modelList.rename(auxNodeModel, stringAux);
+      }
+      else if (option == 2)
+      {
+        auxNodeModel->getDataPtr()->setObjetiveExpression(stringAux);
+      }
+      else
+      {
+        auxNodeModel->getDataPtr()->setCompartments(stringAux);
+      }
+
+      break;
+    case 5:
+      cout << "\n5.-------- ------- ------ ----- Eliminar ----- ------ ------- -------- \n";
+      auxNodeModel = search(modelList);
+      if (auxNodeModel != nullptr)
+        auxNodeModel->getDataPtr()->recordRemove(0, auxNodeModel->getDataPtr()->getName());
+      try
+      {
+        modelList.remove(auxNodeModel);
+        cout << "\nElemento eliminado\n";
+      }
+      catch (List<Model>::Exception ex)
+      {
+        ex.what();
+      }
+      break;
+    case 6:
+      cout << "\n6.-------- ------- ------ ----- Ordenar ----- ------ ------- --------\n";
+      if (!modelList.isEmpty())
+        modelList.getFirst()->getDataPtr()->recordSort(0); //any model of the list tells the recorder
+      modelList.sort();
+      cout << "\nElementos ordenados\n";
+      break;
+    default:
+      break;
+    }
+  } while (option != 0);
+}
+
+//* -------- ------- ------ ----- Loader ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Record format: a type tag line followed by its field lines
+// 1 Model:      name, objective, compartments
+// 2 Reaction:   id, name, stoichiometry, lower, upper, gen-reaction, participants ("metaboliteId:coef ...")
+// 3 Metabolite: id, name, formula, compartment
+// 4 Gen:        id, name, functional, gen-reaction
+class Loader
+{
+private:
+  static const size_t chunkSize{1 << 20};
+
+  struct Part //the lines of one model record and the ones after it
+  {
+    size_t begin;
+    size_t end;
+    long line;
+  };
+
+  List<Model> &modelList;
+  Node<Model> *lastModel;
+  Model *model;
+  Node<Reaction> *lastReaction;
+  Node<Metabolite> *lastMetabolite;
+  Node<Gen> *lastGen;
+
+  int tag;
+  int fieldCount;
+  string fields[7];
+  size_t fieldOffsets[7]; //where each field line starts, for the errors found once the record is complete
+  long fieldLines[7];
+
+  long records;
+  size_t offset;
+  long lineNumber;
+
+  static int fieldsOf(const int &);
+
+  string where(const int &) const; //field
+  int toInt(const int &) const;
+  const string &toStoichiometry(const int &) const;
+  vector<Reaction::Participant> toParticipants(const int &) const;
+  void consume(const char *, size_t);
+  void commit();
+  void parse(const char *, const Part &);
+
+  static vector<Part> split(const char *, const size_t &);
+
+  friend class ParallelLoader;
+
+public:
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  Loader(List<Model> &);
+
+  void load(istream &);
+  void load(const string &);
+
+  long getRecords() const;
+
+  static void save(List<Model> &, ostream &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Loader::Loader(List<Model> &e) : modelList(e), lastModel(nullptr), model(nullptr), lastReaction(nullptr), lastMetabolite(nullptr), lastGen(nullptr), tag(0), fieldCount(0), records(0), offset(0), lineNumber(0) {}
+
+int Loader::fieldsOf(const int &e)
+{
+  static const int count[5] = {0, 3, 7, 4, 4};
+  return e >= 1 and e <= 4 ? count[e] : 0;
+}
+
+string Loader::where(const int &field) const
+{
+  return "en offset " + to_string(fieldOffsets[field]) + " (linea " + to_string(fieldLines[field]) + ")";
+}
+
+int Loader::toInt(const int &field) const
+{
+  const string &e{fields[field]};
+  const char *begin{e.c_str()};
+  char *end{nullptr};
+  errno = 0;
+  long result{strtol(begin, &end, 10)};
+
+  if (end == begin or *end != '\0')
+  {
+    throw Exception("Entero invalido '" + e + "' " + where(field));
+  }
+  if (errno == ERANGE or result < INT_MIN or result > INT_MAX)
+  {
+    throw Exception("Entero fuera de rango '" + e + "' " + where(field));
+  }
+  return int(result);
+}
+
+// Returns the text unchanged once it is known to be a valid arrow
+const string &Loader::toStoichiometry(const int &field) const
+{
+  const string &e{fields[field]};
+  try
+  {
+    Reaction::toStoichiometry(e);
+  }
+  catch (Reaction::Exception &)
+  {
+    throw Exception("Estequiometria invalida '" + e + "' " + where(field));
+  }
+  return e;
+}
+
+// "id:coef id:coef ...", a metabolite name in place of the id is resolved against the metabolites loaded so far
+vector<Reaction::Participant> Loader::toParticipants(const int &field) const
+{
+  const string &e{fields[field]};
+  vector<Reaction::Participant> result;
+  const char *cursor{e.c_str()};
+
+  while (*cursor != '\0')
+  {
+    while (*cursor == ' ')
+      cursor++;
+    if (*cursor == '\0')
+      break;
+
+    const char *colon{cursor};
+    while (*colon != ':' and *colon != ' ' and *colon != '\0')
+      colon++;
+    if (*colon != ':')
+    {
+      throw Exception("Participante invalido '" + string(cursor, colon) + "' " + where(field));
+    }
+
+    char *end{nullptr};
+    double coefficient{strtod(colon + 1, &end)};
+    if (end == colon + 1 or (*end != ' ' and *end != '\0'))
+    {
+      throw Exception("Coeficiente invalido " + where(field));
+    }
+
+    char *endId{nullptr};
+    long id{strtol(cursor, &endId, 10)};
+    if (endId != colon)
+    {
+      Node<Metabolite> *found{model->findMetabolite(string(cursor, colon))};
+      if (found == nullptr)
+      {
+        throw Exception("Metabolito desconocido '" + string(cursor, colon) + "' " + where(field));
+      }
+      id = found->getDataPtr()->getId();
+    }
+    result.push_back({int(id), coefficient});
+    cursor = end;
+  }
+  return result;
+}
+
+void Loader::consume(const char *line, size_t length)
+{
+  lineNumber++;
+  if (length > 0 and line[length - 1] == '\r')
+    length--;
+
+  if (tag == 0)
+  {
+    if (length == 0)
+      return;
+    tag = length == 1 ? line[0] - '0' : 0;
+    if (fieldsOf(tag) == 0)
+    {
+      throw Exception("Tipo de registro invalido en offset " + to_string(offset) + " (linea " + to_string(lineNumber) + ")");
+    }
+    if (tag != 1 and model == nullptr)
+    {
+      throw Exception("Registro sin modelo en offset " + to_string(offset) + " (linea " + to_string(lineNumber) + ")");
+    }
+    fieldCount = 0;
+    return;
+  }
+
+  fieldOffsets[fieldCount] = offset;
+  fieldLines[fieldCount] = lineNumber;
+  fields[fieldCount++].assign(line, length);
+
+  if (fieldCount == fieldsOf(tag))
+  {
+    commit();
+    tag = 0;
+  }
+}
+
+void Loader::commit()
+{
+  switch (tag)
+  {
+  case 1:
+  {
+    Model modelAux;
+    modelAux.setName(fields[0]);
+    modelAux.setObjetiveExpression(fields[1]);
+    modelAux.setCompartments(fields[2]);
+    lastModel = modelList.insertUnchecked(modelAux, lastModel);
+    model = lastModel->getDataPtr();
+    lastReaction = nullptr;
+    lastMetabolite = nullptr;
+    lastGen = nullptr;
+    break;
+  }
+  case 2:
+    lastReaction = model->getReactionList().insertUnchecked(Reaction(toInt(0), std::move(fields[1]), toStoichiometry(2), toInt(3), toInt(4), std::move(fields[5]), toParticipants(6)), lastReaction);
+    break;
+  case 3:
+    lastMetabolite = model->getMetaboliteList().insertUnchecked(Metabolite(toInt(0), std::move(fields[1]), std::move(fields[2]), std::move(fields[3])), lastMetabolite);
+    break;
+  case 4:
+    lastGen = model->getGenList().insertUnchecked(Gen(toInt(0), std::move(fields[1]), std::move(fields[2]), std::move(fields[3])), lastGen);
+    break;
+  default:
+    break;
+  }
+
+  records++;
+}
+
+void Loader::load(istream &input)
+{
+  vector<char> buffer(chunkSize);
+  string pending;
+  const char *begin;
+  const char *end;
+  const char *newLine;
+
+  lastModel = modelList.getLast();
+  model = nullptr;
+  tag = 0;
+  offset = 0;
+  lineNumber = 0;
+
+  while (input)
+  {
+    input.read(buffer.data(), chunkSize);
+    begin = buffer.data();
+    end = begin + input.gcount();
+
+    while ((newLine = static_cast<const char *>(memchr(begin, '\n', end - begin))) != nullptr)
+    {
+      if (pending.empty())
+      {
+        consume(begin, newLine - begin);
+        offset += newLine - begin + 1;
+      }
+      else
+      {
+        pending.append(begin, newLine - begin);
+        consume(pending.data(), pending.size());
+        offset += pending.size() + 1;
+        pending.clear();
+      }
+      begin = newLine + 1;
+    }
+    pending.append(begin, end - begin);
+  }
+
+  if (!pending.empty())
+  {
+    consume(pending.data(), pending.size());
+  }
+
+  if (tag != 0)
+  {
+    throw Exception("Registro incompleto al final del archivo (offset " + to_string(offset) + ")");
+  }
+}
+
+void Loader::load(const string &fileName)
+{
+  ifstream file(fileName, ios::binary);
+
+  if (!file)
+  {
+    throw Exception("No se pudo abrir " + fileName);
+  }
+  load(file);
+}
+
+// Walks the file once, reading only tag lines, to find where each model starts. A record cannot be told apart
+// from a field line by its text, so the fields of every record are skipped the same way consume() does
+vector<Loader::Part> Loader::split(const char *data, const size_t &size)
+{
+  vector<Part> result;
+  size_t position{0};
+  long line{0};
+  int remaining{0};
+
+  while (position < size)
+  {
+    const char *begin{data + position};
+    const char *newLine{static_cast<const char *>(memchr(begin, '\n', size - position))};
+    size_t length{size_t((newLine == nullptr ? data + size : newLine) - begin)};
+    size_t used{length > 0 and begin[length - 1] == '\r' ? length - 1 : length};
+    line++;
+
+    if (remaining > 0)
+    {
+      remaining--;
+    }
+    else if (used > 0)
+    {
+      int tag{used == 1 ? begin[0] - '0' : 0};
+      if (fieldsOf(tag) == 0)
+      {
+        throw Exception("Tipo de registro invalido en offset " + to_string(position) + " (linea " + to_string(line) + ")");
+      }
+      if (tag == 1)
+      {
+        if (!result.empty())
+          result.back().end = position;
+        result.push_back({position, size, line});
+      }
+      else if (result.empty())
+      {
+        throw Exception("Registro sin modelo en offset " + to_string(position) + " (linea " + to_string(line) + ")");
+      }
+      remaining = fieldsOf(tag);
+    }
+    position += length + 1;
+  }
+  return result;
+}
+
+void Loader::parse(const char *data, const Part &part)
+{
+  lastModel = modelList.getLast();
+  model = nullptr;
+  tag = 0;
+  offset = part.begin;
+  lineNumber = part.line - 1;
+
+  while (offset < part.end)
+  {
+    const char *begin{data + offset};
+    const char *newLine{static_cast<const char *>(memchr(begin, '\n', part.end - offset))};
+    size_t length{size_t((newLine == nullptr ? data + part.end : newLine) - begin)};
+    consume(begin, length);
+    offset += length + 1;
+  }
+
+  if (tag != 0)
+  {
+    throw Exception("Registro incompleto al final del archivo (offset " + to_string(min(offset, part.end)) + ")");
+  }
+}
+
+long Loader::getRecords() const
+{
+  return records;
+}
+
+void Loader::save(List<Model> &modelList, ostream &output)
+{
+  for (Node<Model> *auxNodeModel{modelList.getFirst()}; auxNodeModel != nullptr; auxNodeModel = auxNodeModel->getNext())
+  {
+    const Model &m{*auxNodeModel->getDataPtr()};
+    output << "1\n"
+           << m.getName() << '\n'
+           << m.getObjetiveExpression() << '\n'
+           << m.getCompartments() << '\n';
+
+    for (Node<Metabolite> *aux{m.getMetaboliteList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      Metabolite &e{*aux->getDataPtr()};
+      output << "3\n"
+             << e.getId() << '\n'
+             << e.getName() << '\n'
+             << e.getChemicalForm() << '\n'
+             << e.getCompartment() << '\n';
+    }
+
+    for (Node<Reaction> *aux{m.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      Reaction &e{*aux->getDataPtr()};
+      output << "2\n"
+             << e.getId() << '\n'
+             << e.getName() << '\n'
+             << e.getEstequiometria() << '\n'
+             << e.getLowerLimit() << '\n'
+             << e.getHigherLimit() << '\n'
+             << e.getGenReaction() << '\n'
+             << e.getParticipantsText() << '\n';
+    }
+
+    for (Node<Gen> *aux{m.getGenList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      Gen &e{*aux->getDataPtr()};
+      output << "4\n"
+             << e.getId() << '\n'
+             << e.getName() << '\n'
+             << e.getFunctional() << '\n'
+             << e.getGenReaction() << '\n';
+    }
+  }
+}
+
+//* -------- ------- ------ ----- Xml ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// SAX style reader, only the current tag is kept in memory
+class XmlReader
+{
+public:
+  typedef vector<pair<string, string>> Attributes;
+
+  class Handler
+  {
+  public:
+    virtual ~Handler() {}
+    virtual void startElement(const string &, const Attributes &) = 0;
+    virtual void endElement(const string &) = 0;
+  };
+
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  XmlReader(istream &, Handler &);
+
+  void parse();
+  size_t getBytes() const;
+
+  static string attribute(const Attributes &, const string &, const string &fallback = "");
+  static string escape(const string &);
+
+private:
+  static const size_t chunkSize{1 << 16};
+
+  istream &input;
+  Handler &handler;
+  vector<char> buffer;
+  size_t position;
+  size_t length;
+  size_t bytes;
+  string tag;
+  Attributes attributes;
+
+  bool next(char &);
+  void readUntil(const char *);
+  void readTag();
+  void parseTag();
+
+  static string decode(const string &);
+  static string localName(const string &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+XmlReader::XmlReader(istream &i, Handler &h) : input(i), handler(h), buffer(chunkSize), position(0), length(0), bytes(0) {}
+
+bool XmlReader::next(char &c)
+{
+  if (position == length)
+  {
+    if (!input)
+      return false;
+    input.read(buffer.data(), chunkSize);
+    length = input.gcount();
+    position = 0;
+    if (length == 0)
+      return false;
+  }
+  c = buffer[position++];
+  bytes++;
+  return true;
+}
+
+void XmlReader::readUntil(const char *terminator)
+{
+  size_t size{strlen(terminator)};
+  char c;
+
+  while (tag.size() < size or tag.compare(tag.size() - size, size, terminator) != 0)
+  {
+    if (!next(c))
+      throw Exception("Fin de archivo inesperado en offset " + to_string(bytes));
+    tag += c;
+    if (tag.size() > 2 * size)
+      tag.erase(0, tag.size() - size); //comments and CDATA are skipped, keep only the tail
+  }
+}
+
+void XmlReader::readTag()
+{
+  char c;
+  char quote{'\0'};
+
+  tag.clear();
+  while (next(c))
+  {
+    if (quote != '\0')
+    {
+      if (c == quote)
+        quote = '\0';
+    }
+    else if (c == '"' or c == '\'')
+    {
+      quote = c;
+    }
+    else if (c == '>')
+    {
+      return;
+    }
+
+    tag += c;
+
+    if (tag.size() == 3 and tag == "!--")
+    {
+      readUntil("-->");
+      tag = "!";
+      return;
+    }
+    if (tag.size() == 8 and tag == "![CDATA[")
+    {
+      readUntil("]]>");
+      tag = "!";
+      return;
+    }
+  }
+  throw Exception("Etiqueta sin cerrar en offset " + to_string(bytes));
+}
+
+void XmlReader::parseTag()
+{
+  if (tag.empty() or tag[0] == '!' or tag[0] == '?')
+    return;
+
+  if (tag[0] == '/')
+  {
+    size_t end{tag.find_last_not_of(" \t\r\n")};
+    handler.endElement(localName(tag.substr(1, end)));
+    return;
+  }
+
+  bool selfClosing{false};
+  size_t end{tag.find_last_not_of(" \t\r\n")};
+  if (end != string::npos and tag[end] == '/')
+  {
+    selfClosing = true;
+    tag.erase(end);
+  }
+
+  size_t i{tag.find_first_of(" \t\r\n")};
+  string name{localName(tag.substr(0, i))};
+
+  attributes.clear();
+  while (i != string::npos and (i = tag.find_first_not_of(" \t\r\n", i)) != string::npos)
+  {
+    size_t equal{tag.find('=', i)};
+    if (equal == string::npos)
+      break;
+    size_t open{tag.find_first_of("\"'", equal)};
+    if (open == string::npos)
+      break;
+    size_t close{tag.find(tag[open], open + 1)};
+    if (close == string::npos)
+      throw Exception("Atributo sin cerrar en offset " + to_string(bytes));
+
+    string key{tag.substr(i, equal - i)};
+    key.erase(key.find_last_not_of(" \t\r\n") + 1);
+    attributes.push_back(make_pair(localName(key), decode(tag.substr(open + 1, close - open - 1))));
+    i = close + 1;
+  }
+
+  handler.startElement(name, attributes);
+  if (selfClosing)
+    handler.endElement(name);
+}
+
+void XmlReader::parse()
+{
+  char c;
+
+  while (next(c))
+  {
+    if (c == '<')
+    {
+      readTag();
+      parseTag();
+    }
+  }
+}
+
+size_t XmlReader::getBytes() const
+{
+  return bytes;
+}
+
+string XmlReader::attribute(const Attributes &e, const string &key, const string &fallback)
+{
+  for (const pair<string, string> &a : e)
+  {
+    if (a.first == key)
+      return a.second;
+  }
+  return fallback;
+}
+
+string XmlReader::escape(const string &e)
+{
+  string result;
+  result.reserve(e.size());
+
+  for (char c : e)
+  {
+    switch (c)
+    {
+    case '&':
+      result += "&amp;";
+      break;
+    case '<':
+      result += "&lt;";
+      break;
+    case '>':
+      result += "&gt;";
+      break;
+    case '"':
+      result += "&quot;";
+      break;
+    case '\'':
+      result += "&apos;";
+      break;
+    default:
+      result += c;
+    }
+  }
+  return result;
+}
+
+string XmlReader::decode(const string &e)
+{
+  if (e.find('&') == string::npos)
+    return e;
+
+  string result;
+  size_t i{0}, end;
+
+  while (i < e.size())
+  {
+    if (e[i] != '&' or (end = e.find(';', i)) == string::npos)
+    {
+      result += e[i++];
+      continue;
+    }
+
+    string entity{e.substr(i + 1, end - i - 1)};
+    if (entity == "amp")
+      result += '&';
+    else if (entity == "lt")
+      result += '<';
+    else if (entity == "gt")
+      result += '>';
+    else if (entity == "quot")
+      result += '"';
+    else if (entity == "apos")
+      result += '\'';
+    else if (!entity.empty() and entity[0] == '#')
+    {
+      // Only code points XML allows in a document: no NUL, no surrogate halves, nothing past U+10FFFF
+      bool hexadecimal{entity.size() > 1 and entity[1] == 'x'};
+      const char *digits{entity.c_str() + (hexadecimal ? 2 : 1)};
+      char *last{nullptr};
+      errno = 0;
+      long code{isxdigit(static_cast<unsigned char>(*digits)) ? strtol(digits, &last, hexadecimal ? 16 : 10) : -1};
+      if (last == nullptr or *last != '\0' or errno == ERANGE or code <= 0 or code > 0x10FFFF or (code >= 0xD800 and code <= 0xDFFF))
+      {
+        throw Exception("Referencia de caracter invalida '&" + entity + ";'");
+      }
+
+      if (code < 0x80)
+      {
+        result += char(code);
+      }
+      else if (code < 0x800)
+      {
+        result += char(0xC0 | (code >> 6));
+        result += char(0x80 | (code & 0x3F));
+      }
+      else if (code < 0x10000)
+      {
+        result += char(0xE0 | (code >> 12));
+        result += char(0x80 | ((code >> 6) & 0x3F));
+        result += char(0x80 | (code & 0x3F));
+      }
+      else
+      {
+        result += char(0xF0 | (code >> 18));
+        result += char(0x80 | ((code >> 12) & 0x3F));
+        result += char(0x80 | ((code >> 6) & 0x3F));
+        result += char(0x80 | (code & 0x3F));
+      }
+    }
+    else
+      result += e.substr(i, end - i + 1);
+    i = end + 1;
+  }
+  return result;
+}
+
+string XmlReader::localName(const string &e)
+{
+  size_t colon{e.rfind(':')};
+  return colon == string::npos ? e : e.substr(colon + 1);
+}
+
+//* -------- ------- ------ ----- Sbml ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// species -> Metabolite, reaction -> Reaction, fbc:geneProduct -> Gen
+// Reaction metabolites are kept as "species:coefficient" pairs, reactants negative
+class SbmlReader : public XmlReader::Handler
+{
+private:
+  List<Model> &modelList;
+  Model *model;
+  Node<Reaction> *lastReaction;
+  Node<Metabolite> *lastMetabolite;
+  Node<Gen> *lastGen;
+
+  unordered_map<string, double> parameters;
+  string compartments;
+
+  bool inReaction;
+  Reaction reaction;
+  bool reversible;
+  double lowerValue;
+  double upperValue;
+  vector<Reaction::Participant> participants;
+  double side;
+  vector<pair<string, vector<string>>> rule;
+
+  string activeObjective;
+  bool inObjective;
+  string objective;
+
+  Metabolite metabolite;
+  Gen gen;
+
+  static int toBound(const double &);
+
+public:
+  SbmlReader(List<Model> &);
+
+  void startElement(const string &, const XmlReader::Attributes &);
+  void endElement(const string &);
+
+  size_t read(istream &);
+};
+
+class SbmlWriter
+{
+private:
+  ostream &output;
+
+  static string toSId(const string &);
+  static string boundId(const int &);
+
+  void writeTerm(const GeneRule &, const int &, const string &);
+  void writeRule(const string &, const unordered_set<string> &, const string &);
+
+public:
+  static const int openBound{1000};
+
+  static string formatNumber(const double &);
+
+  SbmlWriter(ostream &);
+
+  void write(const Model &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+SbmlReader::SbmlReader(List<Model> &e) : modelList(e), model(nullptr), lastReaction(nullptr), lastMetabolite(nullptr), lastGen(nullptr), inReaction(false), reversible(false), lowerValue(0), upperValue(0), side(0), inObjective(false) {}
+
+int SbmlReader::toBound(const double &e)
+{
+  if (e <= -SbmlWriter::openBound)
+    return e == -HUGE_VAL ? -SbmlWriter::openBound : int(max(e, double(INT_MIN)));
+  if (e >= SbmlWriter::openBound)
+    return e == HUGE_VAL ? SbmlWriter::openBound : int(min(e, double(INT_MAX)));
+  return int(lround(e));
+}
+
+void SbmlReader::startElement(const string &name, const XmlReader::Attributes &a)
+{
+  if (name == "model")
+  {
+    Model modelAux;
+    modelAux.setName(XmlReader::attribute(a, "name", XmlReader::attribute(a, "id")));
+    model = modelList.insertUnchecked(modelAux, modelList.getLast())->getDataPtr();
+  }
+  else if (model == nullptr)
+  {
+    return;
+  }
+  else if (name == "compartment")
+  {
+    compartments += (compartments.empty() ? "" : ",") + XmlReader::attribute(a, "id");
+  }
+  else if (name == "parameter" or name == "localParameter")
+  {
+    string id{XmlReader::attribute(a, "id")};
+    double value{strtod(XmlReader::attribute(a, "value", "0").c_str(), nullptr)};
+    if (!inReaction)
+      parameters[id] = value;
+    else if (id == "LOWER_BOUND")
+      lowerValue = value;
+    else if (id == "UPPER_BOUND")
+      upperValue = value;
+  }
+  else if (name == "species")
+  {
+    metabolite.setId(model->getNumberOfMetabolites() + 1);
+    metabolite.setName(XmlReader::attribute(a, "id"));
+    metabolite.setChemicalForm(XmlReader::attribute(a, "chemicalFormula"));
+    metabolite.setCompartment(XmlReader::attribute(a, "compartment"));
+    lastMetabolite = model->getMetaboliteList().insertUnchecked(metabolite, lastMetabolite);
+  }
+  else if (name == "reaction")
+  {
+    inReaction = true;
+    reversible = XmlReader::attribute(a, "reversible") == "true";
+    lowerValue = reversible ? -SbmlWriter::openBound : 0;
+    upperValue = SbmlWriter::openBound;
+
+    string bound{XmlReader::attribute(a, "lowerFluxBound")};
+    if (parameters.count(bound) > 0)
+      lowerValue = parameters[bound];
+    bound = XmlReader::attribute(a, "upperFluxBound");
+    if (parameters.count(bound) > 0)
+      upperValue = parameters[bound];
+
+    reaction.setId(model->getNumberOfReactions() + 1);
+    reaction.setName(XmlReader::attribute(a, "id"));
+    reaction.setGenReaction("");
+    participants.clear();
+  }
+  else if (name == "listOfReactants")
+  {
+    side = -1;
+  }
+  else if (name == "listOfProducts")
+  {
+    side = 1;
+  }
+  else if (name == "speciesReference" and inReaction)
+  {
+    double coefficient{strtod(XmlReader::attribute(a, "stoichiometry", "1").c_str(), nullptr)};
+    Node<Metabolite> *species{model->findMetabolite(XmlReader::attribute(a, "species"))};
+    if (species != nullptr and side != 0)
+      participants.push_back({species->getDataPtr()->getId(), side * coefficient});
+  }
+  else if (name == "geneProductAssociation" or name == "and" or name == "or")
+  {
+    rule.push_back(make_pair(name, vector<string>()));
+  }
+  else if (name == "geneProductRef" and !rule.empty())
+  {
+    rule.back().second.push_back(XmlReader::attribute(a, "geneProduct"));
+  }
+  else if (name == "listOfObjectives")
+  {
+    activeObjective = XmlReader::attribute(a, "activeObjective");
+  }
+  else if (name == "objective")
+  {
+    inObjective = activeObjective.empty() or XmlReader::attribute(a, "id") == activeObjective;
+    if (!objective.empty())
+      inObjective = false;
+  }
+  else if (name == "fluxObjective" and inObjective)
+  {
+    double coefficient{strtod(XmlReader::attribute(a, "coefficient", "1").c_str(), nullptr)};
+    objective += (objective.empty() ? "" : " + ") + SbmlWriter::formatNumber(coefficient) + " " + XmlReader::attribute(a, "reaction");
+  }
+  else if (name == "geneProduct")
+  {
+    gen.setId(int(model->getGenList().isEmpty() ? 1 : lastGen->getDataPtr()->getId() + 1));
+    gen.setName(XmlReader::attribute(a, "id"));
+    gen.setFunctional(XmlReader::attribute(a, "name", XmlReader::attribute(a, "label")));
+    gen.setGenReaction("");
+    lastGen = model->getGenList().insertUnchecked(gen, lastGen);
+  }
+}
+
+void SbmlReader::endElement(const string &name)
+{
+  if (model == nullptr)
+    return;
+
+  if (name == "reaction" and inReaction)
+  {
+    inReaction = false;
+    reaction.setStoichiometry(reversible ? Reaction::REVERSIBLE : Reaction::FORWARD);
+    reaction.setLowerLimit(toBound(lowerValue));
+    reaction.setHigherLimit(toBound(upperValue));
+    reaction.setParticipants(std::move(participants));
+    lastReaction = model->getReactionList().insertUnchecked(std::move(reaction), lastReaction);
+  }
+  else if (name == "listOfReactants" or name == "listOfProducts")
+  {
+    side = 0;
+  }
+  else if ((name == "and" or name == "or") and rule.size() > 1)
+  {
+    vector<string> &operands{rule.back().second};
+    string joined{""};
+    for (size_t i{0}; i < operands.size(); i++)
+    {
+      joined += (i == 0 ? "" : " " + name + " ") + operands[i];
+    }
+    if (operands.size() > 1)
+      joined = "(" + joined + ")";
+    rule.pop_back();
+    rule.back().second.push_back(joined);
+  }
+  else if (name == "geneProductAssociation" and !rule.empty())
+  {
+    string joined{rule.back().second.empty() ? "" : rule.back().second[0]};
+    if (joined.size() > 1 and joined[0] == '(' and joined[joined.size() - 1] == ')')
+      joined = joined.substr(1, joined.size() - 2);
+    reaction.setGenReaction(joined);
+    rule.clear();
+  }
+  else if (name == "objective")
+  {
+    inObjective = false;
+  }
+  else if (name == "model")
+  {
+    model->setCompartments(compartments);
+    model->setObjetiveExpression(objective);
+    model = nullptr;
+  }
+}
+
+size_t SbmlReader::read(istream &input)
+{
+  XmlReader reader(input, *this);
+  reader.parse();
+  return reader.getBytes();
+}
+
+SbmlWriter::SbmlWriter(ostream &o) : output(o) {}
+
+string SbmlWriter::toSId(const string &e)
+{
+  string result{e.empty() ? "_" : e};
+
+  for (char &c : result)
+  {
+    if (!isalnum(static_cast<unsigned char>(c)) and c != '_')
+      c = '_';
+  }
+  if (isdigit(static_cast<unsigned char>(result[0])))
+    result = "_" + result;
+  return result;
+}
+
+string SbmlWriter::formatNumber(const double &e)
+{
+  char text[32];
+  snprintf(text, sizeof(text), "%.15g", e);
+  return text;
+}
+
+string SbmlWriter::boundId(const int &e)
+{
+  return e < 0 ? "bound_neg_" + to_string(-long(e)) : "bound_" + to_string(e);
+}
+
+void SbmlWriter::writeTerm(const GeneRule &rule, const int &index, const string &indent)
+{
+  const GeneRule::Term &term{rule.getTerm(index)};
+
+  if (term.type == GeneRule::GENE)
+  {
+    output << indent << "<fbc:geneProductRef fbc:geneProduct=\"" << toSId(term.gene) << "\"/>\n";
+    return;
+  }
+
+  const char *op{term.type == GeneRule::AND ? "and" : "or"};
+  output << indent << "<fbc:" << op << ">\n";
+  for (int operand : term.operands)
+  {
+    writeTerm(rule, operand, indent + "  ");
+  }
+  output << indent << "</fbc:" << op << ">\n";
+}
+
+void SbmlWriter::writeRule(const string &e, const unordered_set<string> &genes, const string &indent)
+{
+  GeneRule rule;
+
+  try
+  {
+    rule = GeneRule(e);
+  }
+  catch (GeneRule::Exception &)
+  {
+    return;
+  }
+
+  if (rule.isEmpty())
+    return;
+
+  for (const string &gene : rule.getGenes())
+  {
+    if (genes.count(gene) == 0)
+      return;
+  }
+
+  output << indent << "<fbc:geneProductAssociation>\n";
+  writeTerm(rule, rule.getRoot(), indent + "  ");
+  output << indent << "</fbc:geneProductAssociation>\n";
+}
+
+void SbmlWriter::write(const Model &model)
+{
+  Node<Reaction> *auxNodeReaction;
+  Node<Metabolite> *auxNodeMetabolite;
+  Node<Gen> *auxNodeGen;
+  set<int> bounds;
+  unordered_set<string> genes;
+  unordered_map<int, const string *> speciesNames;
+
+  output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" xmlns:fbc=\"http://www.sbml.org/sbml/level3/version1/fbc/version2\" level=\"3\" version=\"1\" fbc:required=\"false\">\n"
+         << "  <model id=\"" << toSId(model.getName()) << "\" name=\"" << XmlReader::escape(model.getName()) << "\" fbc:strict=\"true\">\n";
+
+  // The ones of the model and then any other a species is in, the empty one included, so every species refers to a
+  // declared compartment; names that map to the same SId are declared once
+  output << "    <listOfCompartments>\n";
+  unordered_set<string> declared;
+  string compartments{model.getCompartments()};
+  size_t begin{0}, end;
+  while (begin <= compartments.size())
+  {
+    end = compartments.find(',', begin);
+    end = end == string::npos ? compartments.size() : end;
+    string id{compartments.substr(begin, end - begin)};
+    if (!id.empty() and declared.insert(toSId(id)).second)
+      output << "      <compartment id=\"" << toSId(id) << "\" constant=\"true\"/>\n";
+    begin = end + 1;
+  }
+  for (auxNodeMetabolite = model.getMetaboliteList().getFirst(); auxNodeMetabolite != nullptr; auxNodeMetabolite = auxNodeMetabolite->getNext())
+  {
+    string id{toSId(auxNodeMetabolite->getDataPtr()->getCompartment())};
+    if (declared.insert(id).second)
+      output << "      <compartment id=\"" << id << "\" constant=\"true\"/>\n";
+  }
+  output << "    </listOfCompartments>\n";
+
+  output << "    <listOfSpecies>\n";
+  for (auxNodeMetabolite = model.getMetaboliteList().getFirst(); auxNodeMetabolite != nullptr; auxNodeMetabolite = auxNodeMetabolite->getNext())
+  {
+    Metabolite &m{*auxNodeMetabolite->getDataPtr()};
+    speciesNames.emplace(m.getId(), &m.getName());
+    output << "      <species id=\"" << toSId(m.getName()) << "\" compartment=\"" << toSId(m.getCompartment())
+           << "\" hasOnlySubstanceUnits=\"false\" boundaryCondition=\"false\" constant=\"false\"";
+    if (!m.getChemicalForm().empty())
+      output << " fbc:chemicalFormula=\"" << XmlReader::escape(m.getChemicalForm()) << "\"";
+    output << "/>\n";
+  }
+  output << "    </listOfSpecies>\n";
+
+  for (auxNodeReaction = model.getReactionList().getFirst(); auxNodeReaction != nullptr; auxNodeReaction = auxNodeReaction->getNext())
+  {
+    bounds.insert(auxNodeReaction->getDataPtr()->getLowerLimit());
+    bounds.insert(auxNodeReaction->getDataPtr()->getHigherLimit());
+  }
+  output << "    <listOfParameters>\n";
+  for (int bound : bounds)
+  {
+    output << "      <parameter id=\"" << boundId(bound) << "\" value=\"" << bound << "\" constant=\"true\"/>\n";
+  }
+  output << "    </listOfParameters>\n";
+
+  for (auxNodeGen = model.getGenList().getFirst(); auxNodeGen != nullptr; auxNodeGen = auxNodeGen->getNext())
+  {
+    genes.insert(auxNodeGen->getDataPtr()->getName());
+  }
+
+  output << "    <listOfReactions>\n";
+  for (auxNodeReaction = model.getReactionList().getFirst(); auxNodeReaction != nullptr; auxNodeReaction = auxNodeReaction->getNext())
+  {
+    Reaction &r{*auxNodeReaction->getDataPtr()};
+    string reactants, products;
+
+    for (const Reaction::Participant &e : r.getParticipants())
+    {
+      auto found{speciesNames.find(e.metabolite)};
+      if (found == speciesNames.end() or e.coefficient == 0)
+        continue;
+      string reference{"          <speciesReference species=\"" + toSId(*found->second) + "\" stoichiometry=\"" + formatNumber(fabs(e.coefficient)) + "\" constant=\"true\"/>\n"};
+      (e.coefficient < 0 ? reactants : products) += reference;
+    }
+
+    output << "      <reaction id=\"" << toSId(r.getName()) << "\" reversible=\"" << (r.getStoichiometry() == Reaction::REVERSIBLE ? "true" : "false")
+           << "\" fast=\"false\" fbc:lowerFluxBound=\"" << boundId(r.getLowerLimit()) << "\" fbc:upperFluxBound=\"" << boundId(r.getHigherLimit()) << "\">\n";
+    if (!reactants.empty())
+      output << "        <listOfReactants>\n"
+             << reactants << "        </listOfReactants>\n";
+    if (!products.empty())
+      output << "        <listOfProducts>\n"
+             << products << "        </listOfProducts>\n";
+    writeRule(r.getGenReaction(), genes, "        ");
+    output << "      </reaction>\n";
+  }
+  output << "    </listOfReactions>\n";
+
+  output << "    <fbc:listOfObjectives fbc:activeObjective=\"obj\">\n"
+         << "      <fbc:objective fbc:id=\"obj\" fbc:type=\"maximize\">\n"
+         << "        <fbc:listOfFluxObjectives>\n";
+  istringstream terms(model.getObjetiveExpression());
+  string term;
+  while (getline(terms, term, '+'))
+  {
+    istringstream words(term);
+    string first, second;
+    words >> first >> second;
+    if (first.empty())
+      continue;
+    char *endNumber{nullptr};
+    double coefficient{strtod(first.c_str(), &endNumber)};
+    if (second.empty() or *endNumber != '\0')
+    {
+      second = first;
+      coefficient = 1;
+    }
+    output << "          <fbc:fluxObjective fbc:reaction=\"" << toSId(second) << "\" fbc:coefficient=\"" << formatNumber(coefficient) << "\"/>\n";
+  }
+  output << "        </fbc:listOfFluxObjectives>\n"
+         << "      </fbc:objective>\n"
+         << "    </fbc:listOfObjectives>\n";
+
+  output << "    <fbc:listOfGeneProducts>\n";
+  for (auxNodeGen = model.getGenList().getFirst(); auxNodeGen != nullptr; auxNodeGen = auxNodeGen->getNext())
+  {
+    Gen &g{*auxNodeGen->getDataPtr()};
+    output << "      <fbc:geneProduct fbc:id=\"" << toSId(g.getName()) << "\" fbc:label=\"" << XmlReader::escape(g.getName()) << "\"";
+    if (!g.getFunctional().empty())
+      output << " fbc:name=\"" << XmlReader::escape(g.getFunctional()) << "\"";
+    output << "/>\n";
+  }
+  output << "    </fbc:listOfGeneProducts>\n";
+
+  output << "  </model>\n"
+         << "</sbml>\n";
+}
+
+//* -------- ------- ------ ----- Snapshot ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Layout: Header | ModelRecord[] | ReactionRecord[] | MetaboliteRecord[] | GenRecord[] | uint64 stringOffsets[strings + 1] | string data
+// Records are read in place from the mapped file, strings are references into one interned table
+class Snapshot
+{
+public:
+  static const uint32_t version{2};
+
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianness;
+    uint64_t models;
+    uint64_t reactions;
+    uint64_t metabolites;
+    uint64_t gens;
+    uint64_t participants;
+    uint64_t strings;
+    uint64_t modelOffset;
+    uint64_t reactionOffset;
+    uint64_t metaboliteOffset;
+    uint64_t genOffset;
+    uint64_t participantOffset;
+    uint64_t stringOffset;
+    uint64_t textOffset;
+    uint64_t size;
+  };
+
+  struct ModelRecord
+  {
+    uint32_t name;
+    uint32_t objetiveExpression;
+    uint32_t compartments;
+    int32_t numberOfMetabolites;
+    int32_t numberOfReactions;
+    uint32_t padding;
+    uint64_t firstReaction;
+    uint64_t reactionCount;
+    uint64_t firstMetabolite;
+    uint64_t metaboliteCount;
+    uint64_t firstGen;
+    uint64_t genCount;
+  };
+
+  struct ReactionRecord
+  {
+    int32_t id;
+    uint32_t name;
+    uint32_t stoichiometry;
+    int32_t lowerLimit;
+    int32_t higherLimit;
+    uint32_t genReaction;
+    uint32_t participantCount;
+    uint64_t firstParticipant;
+  };
+
+  struct MetaboliteRecord
+  {
+    int32_t id;
+    uint32_t name;
+    uint32_t chemicalForm;
+    uint32_t compartment;
+  };
+
+  struct GenRecord
+  {
+    int32_t id;
+    uint32_t name;
+    uint32_t functional;
+    uint32_t genReaction;
+  };
+
+  struct ParticipantRecord
+  {
+    int32_t metabolite;
+    uint32_t padding;
+    double coefficient;
+  };
+
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  Snapshot();
+  ~Snapshot();
+
+  static void save(List<Model> &, const string &);
+
+  void open(const string &);
+  void close();
+
+  uint64_t getModelCount() const;
+  const ModelRecord &getModel(const uint64_t &) const;
+  const ReactionRecord &getReaction(const uint64_t &) const;
+  const MetaboliteRecord &getMetabolite(const uint64_t &) const;
+  const GenRecord &getGen(const uint64_t &) const;
+  const ParticipantRecord &getParticipant(const uint64_t &) const;
+  string_view getString(const uint32_t &) const;
+
+  void load(List<Model> &) const;
+
+private:
+  const char *data;
+  size_t size;
+  const Header *header;
+#ifdef _WIN32
+  vector<char> buffer;
+#endif
+
+  Snapshot(const Snapshot &) = delete;
+  Snapshot &operator=(const Snapshot &) = delete;
+
+  template <class R>
+  const R &record(const uint64_t &, const uint64_t &, const uint64_t &) const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Snapshot::Snapshot() : data(nullptr), size(0), header(nullptr) {}
+
+Snapshot::~Snapshot()
+{
+  close();
+}
+
+void Snapshot::save(List<Model> &modelList, const string &fileName)
+{
+  vector<ModelRecord> models;
+  vector<ReactionRecord> reactions;
+  vector<MetaboliteRecord> metabolites;
+  vector<GenRecord> gens;
+  vector<ParticipantRecord> participants;
+  vector<const string *> strings;
+  unordered_map<string, uint32_t> interned;
+
+  auto intern = [&](const string &e) -> uint32_t {
+    auto found{interned.find(e)};
+    if (found != interned.end())
+      return found->second;
+    found = interned.emplace(e, uint32_t(strings.size())).first;
+    strings.push_back(&found->first);
+    return found->second;
+  };
+
+  for (Node<Model> *auxNodeModel{modelList.getFirst()}; auxNodeModel != nullptr; auxNodeModel = auxNodeModel->getNext())
+  {
+    const Model &m{*auxNodeModel->getDataPtr()};
+    ModelRecord model{};
+    model.name = intern(m.getName());
+    model.objetiveExpression = intern(m.getObjetiveExpression());
+    model.compartments = intern(m.getCompartments());
+    model.numberOfMetabolites = m.getNumberOfMetabolites();
+    model.numberOfReactions = m.getNumberOfReactions();
+
+    model.firstReaction = reactions.size();
+    for (Node<Reaction> *aux{m.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      Reaction &e{*aux->getDataPtr()};
+      ReactionRecord r{};
+      r.id = e.getId();
+      r.name = intern(e.getName());
+      r.stoichiometry = intern(e.getEstequiometria());
+      r.lowerLimit = e.getLowerLimit();
+      r.higherLimit = e.getHigherLimit();
+      r.genReaction = intern(e.getGenReaction());
+      r.firstParticipant = participants.size();
+      r.participantCount = uint32_t(e.getParticipants().size());
+      for (const Reaction::Participant &p : e.getParticipants())
+      {
+        participants.push_back({p.metabolite, 0, p.coefficient});
+      }
+      reactions.push_back(r);
+    }
+    model.reactionCount = reactions.size() - model.firstReaction;
+
+    model.firstMetabolite = metabolites.size();
+    for (Node<Metabolite> *aux{m.getMetaboliteList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      Metabolite &e{*aux->getDataPtr()};
+      MetaboliteRecord r{};
+      r.id = e.getId();
+      r.name = intern(e.getName());
+      r.chemicalForm = intern(e.getChemicalForm());
+      r.compartment = intern(e.getCompartment());
+      metabolites.push_back(r);
+    }
+    model.metaboliteCount = metabolites.size() - model.firstMetabolite;
+
+    model.firstGen = gens.size();
+    for (Node<Gen> *aux{m.getGenList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      Gen &e{*aux->getDataPtr()};
+      GenRecord r{};
+      r.id = e.getId();
+      r.name = intern(e.getName());
+      r.functional = intern(e.getFunctional());
+      r.genReaction = intern(e.getGenReaction());
+      gens.push_back(r);
+    }
+    model.genCount = gens.size() - model.firstGen;
+
+    models.push_back(model);
+  }
+
+  Header h{};
+  memcpy(h.magic, "MMLSNAP", 8);
+  h.version = version;
+  h.endianness = 0x01020304;
+  h.models = models.size();
+  h.reactions = reactions.size();
+  h.metabolites = metabolites.size();
+  h.gens = gens.size();
+  h.participants = participants.size();
+  h.strings = strings.size();
+  h.modelOffset = sizeof(Header);
+  h.reactionOffset = h.modelOffset + models.size() * sizeof(ModelRecord);
+  h.metaboliteOffset = h.reactionOffset + reactions.size() * sizeof(ReactionRecord);
+  h.genOffset = h.metaboliteOffset + metabolites.size() * sizeof(MetaboliteRecord);
+  h.participantOffset = h.genOffset + gens.size() * sizeof(GenRecord);
+  h.stringOffset = h.participantOffset + participants.size() * sizeof(ParticipantRecord);
+  h.textOffset = h.stringOffset + (strings.size() + 1) * sizeof(uint64_t);
+
+  vector<uint64_t> offsets(strings.size() + 1, 0);
+  for (size_t i{0}; i < strings.size(); i++)
+  {
+    offsets[i + 1] = offsets[i] + strings[i]->size();
+  }
+  h.size = h.textOffset + offsets.back();
+
+  ofstream file(fileName, ios::binary | ios::trunc);
+  if (!file)
+  {
+    throw Exception("No se pudo crear " + fileName);
+  }
+  file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  file.write(reinterpret_cast<const char *>(models.data()), models.size() * sizeof(ModelRecord));
+  file.write(reinterpret_cast<const char *>(reactions.data()), reactions.size() * sizeof(ReactionRecord));
+  file.write(reinterpret_cast<const char *>(metabolites.data()), metabolites.size() * sizeof(MetaboliteRecord));
+  file.write(reinterpret_cast<const char *>(gens.data()), gens.size() * sizeof(GenRecord));
+  file.write(reinterpret_cast<const char *>(participants.data()), participants.size() * sizeof(ParticipantRecord));
+  file.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+  for (const string *e : strings)
+  {
+    file.write(e->data(), e->size());
+  }
+  if (!file)
+  {
+    throw Exception("Error escribiendo " + fileName);
+  }
+}
+
+void Snapshot::open(const string &fileName)
+{
+  close();
+
+#ifdef _WIN32
+  ifstream file(fileName, ios::binary | ios::ate);
+  if (!file)
+  {
+    throw Exception("No se pudo abrir " + fileName);
+  }
+  buffer.resize(size_t(file.tellg()));
+  file.seekg(0);
+  file.read(buffer.data(), buffer.size());
+  data = buffer.data();
+  size = buffer.size();
+#else
+  int descriptor{::open(fileName.c_str(), O_RDONLY)};
+  struct stat status;
+
+  if (descriptor < 0 or fstat(descriptor, &status) != 0)
+  {
+    if (descriptor >= 0)
+      ::close(descriptor);
+    throw Exception("No se pudo abrir " + fileName);
+  }
+
+  size = size_t(status.st_size);
+  void *mapped{size == 0 ? MAP_FAILED : mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0)};
+  ::close(descriptor);
+
+  if (mapped == MAP_FAILED)
+  {
+    size = 0;
+    throw Exception("No se pudo mapear " + fileName);
+  }
+  data = static_cast<const char *>(mapped);
+#endif
+
+  header = reinterpret_cast<const Header *>(data);
+  if (size < sizeof(Header) or memcmp(header->magic, "MMLSNAP", 8) != 0 or header->endianness != 0x01020304)
+  {
+    close();
+    throw Exception("Formato de snapshot invalido: " + fileName);
+  }
+  if (header->version != version)
+  {
+    close();
+    throw Exception("Version de snapshot no soportada: " + fileName);
+  }
+
+  // Every region has to follow the previous one inside the file; counts are bounded first so the products can not wrap
+  auto region = [this](const uint64_t &offset, const uint64_t &count, const size_t &recordSize, const uint64_t &next) {
+    return offset <= size and count <= (size - offset) / recordSize and offset + count * recordSize == next;
+  };
+  bool valid{header->size == size and header->modelOffset == sizeof(Header) and header->textOffset <= size and
+             region(header->modelOffset, header->models, sizeof(ModelRecord), header->reactionOffset) and
+             region(header->reactionOffset, header->reactions, sizeof(ReactionRecord), header->metaboliteOffset) and
+             region(header->metaboliteOffset, header->metabolites, sizeof(MetaboliteRecord), header->genOffset) and
+             region(header->genOffset, header->gens, sizeof(GenRecord), header->participantOffset) and
+             region(header->participantOffset, header->participants, sizeof(ParticipantRecord), header->stringOffset) and
+             header->strings < size and region(header->stringOffset, header->strings + 1, sizeof(uint64_t), header->textOffset)};
+
+  // and every range a model or a reaction points to has to stay inside its region
+  auto inside = [](const uint64_t &first, const uint64_t &count, const uint64_t &total) {
+    return first <= total and count <= total - first;
+  };
+  for (uint64_t i{0}; valid and i < header->models; i++)
+  {
+    const ModelRecord &m{reinterpret_cast<const ModelRecord *>(data + header->modelOffset)[i]};
+    valid = inside(m.firstReaction, m.reactionCount, header->reactions) and inside(m.firstMetabolite, m.metaboliteCount, header->metabolites) and
+            inside(m.firstGen, m.genCount, header->gens);
+  }
+  for (uint64_t i{0}; valid and i < header->reactions; i++)
+  {
+    const ReactionRecord &r{reinterpret_cast<const ReactionRecord *>(data + header->reactionOffset)[i]};
+    valid = inside(r.firstParticipant, r.participantCount, header->participants);
+  }
+
+  if (!valid)
+  {
+    close();
+    throw Exception("Snapshot truncado o corrupto: " + fileName);
+  }
+}
+
+void Snapshot::close()
+{
+#ifdef _WIN32
+  buffer.clear();
+#else
+  if (data != nullptr)
+  {
+    munmap(const_cast<char *>(data), size);
+  }
+#endif
+  data = nullptr;
+  size = 0;
+  header = nullptr;
+}
+
+template <class R>
+const R &Snapshot::record(const uint64_t &offset, const uint64_t &count, const uint64_t &index) const
+{
+  if (header == nullptr or index >= count)
+  {
+    throw Exception("Registro fuera de rango");
+  }
+  return reinterpret_cast<const R *>(data + offset)[index];
+}
+
+uint64_t Snapshot::getModelCount() const
+{
+  return header == nullptr ? 0 : header->models;
+}
+
+const Snapshot::ModelRecord &Snapshot::getModel(const uint64_t &e) const
+{
+  return record<ModelRecord>(header->modelOffset, header->models, e);
+}
+
+const Snapshot::ReactionRecord &Snapshot::getReaction(const uint64_t &e) const
+{
+  return record<ReactionRecord>(header->reactionOffset, header->reactions, e);
+}
+
+const Snapshot::MetaboliteRecord &Snapshot::getMetabolite(const uint64_t &e) const
+{
+  return record<MetaboliteRecord>(header->metaboliteOffset, header->metabolites, e);
+}
+
+const Snapshot::GenRecord &Snapshot::getGen(const uint64_t &e) const
+{
+  return record<GenRecord>(header->genOffset, header->gens, e);
+}
+
+const Snapshot::ParticipantRecord &Snapshot::getParticipant(const uint64_t &e) const
+{
+  return record<ParticipantRecord>(header->participantOffset, header->participants, e);
+}
+
+string_view Snapshot::getString(const uint32_t &e) const
+{
+  const uint64_t *offsets{reinterpret_cast<const uint64_t *>(data + header->stringOffset)};
+  uint64_t textSize{size - header->textOffset};
+
+  if (e >= header->strings or offsets[e] > offsets[e + 1] or offsets[e + 1] > textSize)
+  {
+    throw Exception("Cadena fuera de rango");
+  }
+  return string_view(data + header->textOffset + offsets[e], offsets[e + 1] - offsets[e]);
+}
+
+// Models are built in a list of their own and only linked into modelList once all of them were read, so a snapshot
+// that fails halfway leaves modelList as it was
+void Snapshot::load(List<Model> &modelList) const
+{
+  List<Model> loaded;
+  Node<Model> *lastModel{nullptr};
+
+  for (uint64_t i{0}; i < getModelCount(); i++)
+  {
+    const ModelRecord &m{getModel(i)};
+    Model modelAux;
+    modelAux.setName(string(getString(m.name)));
+    modelAux.setObjetiveExpression(string(getString(m.objetiveExpression)));
+    modelAux.setCompartments(string(getString(m.compartments)));
+    lastModel = loaded.insertUnchecked(modelAux, lastModel);
+    Model &model{*lastModel->getDataPtr()};
+
+    Node<Reaction> *lastReaction{nullptr};
+    for (uint64_t j{m.firstReaction}; j < m.firstReaction + m.reactionCount; j++)
+    {
+      const ReactionRecord &r{getReaction(j)};
+      vector<Reaction::Participant> participants(r.participantCount);
+      for (uint32_t k{0}; k < r.participantCount; k++)
+      {
+        const ParticipantRecord &p{getParticipant(r.firstParticipant + k)};
+        participants[k] = {p.metabolite, p.coefficient};
+      }
+      lastReaction = model.getReactionList().emplace(lastReaction, r.id, string(getString(r.name)), string(getString(r.stoichiometry)), r.lowerLimit, r.higherLimit,
+                                                     string(getString(r.genReaction)), std::move(participants));
+    }
+
+    Node<Metabolite> *lastMetabolite{nullptr};
+    for (uint64_t j{m.firstMetabolite}; j < m.firstMetabolite + m.metaboliteCount; j++)
+    {
+      const MetaboliteRecord &r{getMetabolite(j)};
+      lastMetabolite = model.getMetaboliteList().emplace(lastMetabolite, r.id, string(getString(r.name)), string(getString(r.chemicalForm)), string(getString(r.compartment)));
+    }
+
+    Node<Gen> *lastGen{nullptr};
+    for (uint64_t j{m.firstGen}; j < m.firstGen + m.genCount; j++)
+    {
+      const GenRecord &r{getGen(j)};
+      lastGen = model.getGenList().emplace(lastGen, r.id, string(getString(r.name)), string(getString(r.functional)), string(getString(r.genReaction)));
+    }
+  }
+
+  lastModel = modelList.getLast();
+  for (Node<Model> *aux{loaded.getFirst()}; aux != nullptr; aux = aux->getNext())
+    lastModel = modelList.insertUnchecked(*aux->getDataPtr(), lastModel); //the copy shares the entity lists
+}
+
+//* -------- ------- ------ ----- Hilos ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Fixed pool of worker threads that runs a batch of numbered tasks with work stealing. Each run splits the tasks in
+// contiguous ranges, one per worker; a worker takes from the front of its own range and, once empty, steals from
+// the back of the others. The calling thread works as worker 0, so a pool of one thread runs everything inline
+class ThreadPool
+{
+private:
+  struct Queue
+  {
+    mutex lock;
+    deque<int> tasks;
+  };
+
+  vector<thread> workers;
+  vector<Queue> queues;
+  const function<void(const int &, const int &)> *job;
+
+  mutex lock;
+  condition_variable wake;
+  condition_variable done;
+  long generation;
+  int running;
+  bool stopping;
+  atomic<bool> failed;
+  exception_ptr failure;
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  bool take(const int &, int &);
+  void work(const int &);
+  void loop(const int &);
+
+public:
+  explicit ThreadPool(const int & = 0); //0 uses every hardware thread
+  ~ThreadPool();
+
+  int getThreads() const;
+
+  void run(const int &, const function<void(const int &, const int &)> &); //job(task, worker)
+
+  static int hardwareThreads();
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+ThreadPool::ThreadPool(const int &threads) : queues(threads > 0 ? threads : hardwareThreads()), job(nullptr), generation(0), running(0), stopping(false), failed(false)
+{
+  for (int w{1}; w < int(queues.size()); w++)
+  {
+    workers.emplace_back(&ThreadPool::loop, this, w);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (thread &e : workers)
+  {
+    e.join();
+  }
+}
+
+int ThreadPool::hardwareThreads()
+{
+  return max(1, int(thread::hardware_concurrency()));
+}
+
+int ThreadPool::getThreads() const
+{
+  return int(queues.size());
+}
+
+// Next task for a worker: its own queue first, then the back of the others starting with its neighbour
+bool ThreadPool::take(const int &worker, int &task)
+{
+  int threads{getThreads()};
+
+  for (int k{0}; k < threads; k++)
+  {
+    Queue &queue{queues[(worker + k) % threads]};
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.tasks.empty())
+      continue;
+    if (k == 0)
+    {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+    }
+    else
+    {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+// Runs tasks until every queue is empty. After the first exception the remaining tasks are only drained
+void ThreadPool::work(const int &worker)
+{
+  int task;
+
+  while (take(worker, task))
+  {
+    if (failed.load(memory_order_relaxed))
+      continue;
+    try
+    {
+      (*job)(task, worker);
+    }
+    catch (...)
+    {
+      lock_guard<mutex> guard(lock);
+      if (!failed.exchange(true))
+        failure = current_exception();
+    }
+  }
+}
+
+void ThreadPool::loop(const int &worker)
+{
+  long seen{0};
+  unique_lock<mutex> guard(lock);
+
+  while (true)
+  {
+    wake.wait(guard, [&]() { return stopping or generation != seen; });
+    if (stopping)
+      return;
+    seen = generation;
+
+    guard.unlock();
+    work(worker);
+    guard.lock();
+
+    if (--running == 0)
+      done.notify_one();
+  }
+}
+
+// Runs job(task, worker) for every task in [0, tasks) and returns when all of them finished. The worker index is
+// below getThreads(), so jobs can keep per-worker state. The first exception thrown by a job is rethrown here
+void ThreadPool::run(const int &tasks, const function<void(const int &, const int &)> &e)
+{
+  int threads{getThreads()};
+
+  for (int w{0}; w < threads; w++)
+  {
+    lock_guard<mutex> guard(queues[w].lock);
+    for (int task{int(long(tasks) * w / threads)}; task < int(long(tasks) * (w + 1) / threads); task++)
+    {
+      queues[w].tasks.push_back(task);
+    }
+  }
+
+  {
+    lock_guard<mutex> guard(lock);
+    job = &e;
+    failed = false;
+    failure = nullptr;
+    running = threads - 1;
+    generation++;
+  }
+  wake.notify_all();
+
+  work(0);
+
+  unique_lock<mutex> guard(lock);
+  done.wait(guard, [&]() { return running == 0; });
+  job = nullptr;
+  if (failure)
+    rethrow_exception(failure);
+}
+
+//* -------- ------- ------ ----- Carga Paralela ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Loads files in the Loader format holding many models. One pass over the tag lines splits the file where model
+// records start, then every model is parsed by its own Loader into a private list on a pool thread, and the models
+// are linked after the last one of the list in file order. Offsets and lines in the errors are those of the file
+class ParallelLoader
+{
+private:
+  List<Model> &modelList;
+  ThreadPool &pool;
+  long records;
+  long modelCount;
+
+public:
+  ParallelLoader(List<Model> &, ThreadPool &);
+
+  void load(const string &);
+
+  long getRecords() const;
+  long getModelCount() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+ParallelLoader::ParallelLoader(List<Model> &e, ThreadPool &p) : modelList(e), pool(p), records(0), modelCount(0) {}
+
+// All or nothing: when a model fails nothing is linked and the error of the first failing model in the file is
+// thrown, so a failed load leaves the list as it was
+void ParallelLoader::load(const string &fileName)
+{
+  const char *data{nullptr};
+  size_t size{0};
+
+#ifdef _WIN32
+  vector<char> buffer;
+  ifstream file(fileName, ios::binary | ios::ate);
+  if (!file)
+  {
+    throw Loader::Exception("No se pudo abrir " + fileName);
+  }
+  buffer.resize(size_t(file.tellg()));
+  file.seekg(0);
+  file.read(buffer.data(), buffer.size());
+  data = buffer.data();
+  size = buffer.size();
+#else
+  int descriptor{::open(fileName.c_str(), O_RDONLY)};
+  struct stat status;
+
+  if (descriptor < 0 or fstat(descriptor, &status) != 0)
+  {
+    if (descriptor >= 0)
+      ::close(descriptor);
+    throw Loader::Exception("No se pudo abrir " + fileName);
+  }
+
+  size = size_t(status.st_size);
+  void *mapped{size == 0 ? nullptr : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+  ::close(descriptor);
+
+  if (mapped == MAP_FAILED)
+  {
+    throw Loader::Exception("No se pudo mapear " + fileName);
+  }
+  data = static_cast<const char *>(mapped);
+  unique_ptr<void, function<void(void *)>> unmap(mapped, [size](void *e) { munmap(e, size); });
+#endif
+
+  vector<Loader::Part> parts{Loader::split(data, size)};
+  vector<unique_ptr<List<Model>>> models(parts.size());
+  vector<long> counts(parts.size(), 0);
+  vector<string> errors(parts.size());
+
+  pool.run(int(parts.size()), [&](const int &task, const int &)
+           {
+             models[task].reset(new List<Model>());
+             try
+             {
+               Loader loader(*models[task]);
+               loader.parse(data, parts[task]);
+               counts[task] = loader.records;
+             }
+             catch (Loader::Exception &ex)
+             {
+               errors[task] = ex.what();
+             }
+           });
+
+  for (size_t i{0}; i < parts.size(); i++)
+  {
+    if (!errors[i].empty())
+    {
+      throw Loader::Exception(errors[i]);
+    }
+  }
+
+  Node<Model> *lastModel{modelList.getLast()};
+  for (size_t i{0}; i < parts.size(); i++)
+  {
+    for (Node<Model> *aux{models[i]->getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      lastModel = modelList.insertUnchecked(*aux->getDataPtr(), lastModel); //the copy shares the entity lists
+      modelCount++;
+    }
+    records += counts[i];
+  }
+}
+
+long ParallelLoader::getRecords() const
+{
+  return records;
+}
+
+long ParallelLoader::getModelCount() const
+{
+  return modelCount;
+}
+
+//* -------- ------- ------ ----- Bitacora ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// Write-ahead log of the changes to a list of models, "<base>.wal", on top of its last checkpoint "<base>.<G>.snap".
+// The log starts with "MMWAL <G>\n" naming that checkpoint, followed by records framed as "<bytes> <crc32>\n<data>".
+// Writers append under a short lock and wait in commit: the first one to get there writes and syncs everything
+// pending, so concurrent commits share one fsync. A checkpoint writes a new snapshot and switches to an empty log
+// naming it with a rename, a crash before that rename leaves the old pair. On recovery the log is replayed up to the
+// first incomplete or damaged record and cut there. A write or sync that fails breaks the journal: the file is in an
+// unknown state, so every later append, commit and checkpoint throws instead of acknowledging records after a hole.
+// A record that fails to replay is reported and copied to "<base>.rejected" before the next checkpoint drops it
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+class Journal
+{
+public:
+  struct Record
+  {
+    char kind; //'E' edit of a model or one of its elements; 'A' add, 'R' remove, 'S' sort from the menus; 'C' Batch command
+    string model;
+    int entity; //0 model, 1 reaction, 2 metabolite, 3 gen
+    string element;
+    int option;
+    string value; //the command line of a 'C' record, the Loader record of an 'A' one
+  };
+
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  Journal(List<Model> &);
+  ~Journal();
+
+  void open(const string &); //base name
+  bool hasCheckpoint() const;
+  uint64_t getGeneration() const; //of the checkpoint the log starts from
+  long recover(const function<void(const Record &)> &); //loads the checkpoint into the list and replays the log
+
+  uint64_t append(const Record &);
+  void commit(const uint64_t &); //returns once that record is on disk
+  void log(const Record &); //appends and commits, or only appends inside a group
+  void beginGroup(); //records logged by this thread until endGroup are only appended
+  uint64_t endGroup(); //the last of them, to commit once the caller let go of its locks
+  void checkpoint(); //the caller keeps the list from changing
+  bool isFull() const;
+  bool isBroken() const;
+
+  void setSync(const bool &);
+  void setCheckpointBytes(const uint64_t &);
+  uint64_t getSyncs() const;
+  uint64_t getCheckpoints() const;
+  long getFailures() const;
+  const string &getFailure() const; //the first record that failed to replay, kept in "<base>.rejected"
+  uint64_t getTruncated() const;
+
+  static void apply(List<Model> &, const Record &); //every kind but 'C'
+  static void record(void *, const Model &, const char &, const int &, const string &, const int &, const string &); //Model::Recorder
+
+private:
+  List<Model> &modelList;
+  string base;
+  int fd;
+  uint64_t generation;
+  size_t headerBytes;
+
+  mutable mutex lock;
+  condition_variable flushed;
+  string pending;
+  uint64_t appended;
+  uint64_t durable;
+  bool flushing;
+  bool syncing;
+  uint64_t bytes; //in the log since the checkpoint
+  uint64_t checkpointBytes;
+  uint64_t syncs;
+  uint64_t checkpoints;
+  long failures;
+  string failure;
+  string broken; //why the journal stopped accepting records
+  uint64_t truncated;
+
+  static thread_local Journal *group;
+  static thread_local uint64_t grouped;
+
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  string snapshotName(const uint64_t &) const;
+  int create(const uint64_t &) const; //empty log naming that checkpoint, synced and in place
+  void write(const string &) const;
+
+  static void sync(const int &);
+  static void syncFile(const string &);
+  static void syncDirectory(const string &);
+  static uint32_t crc(const char *, const size_t &);
+  static string encode(const Record &);
+  static bool decode(const char *, const size_t &, Record &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+thread_local Journal *Journal::group{nullptr};
+thread_local uint64_t Journal::grouped{0};
+
+Journal::Journal(List<Model> &e) : modelList(e), base(""), fd(-1), generation(0), headerBytes(0), appended(0), durable(0), flushing(false), syncing(true), bytes(0),
+                                   checkpointBytes(64 << 20), syncs(0), checkpoints(0), failures(0), failure(""), broken(""), truncated(0) {}
+
+Journal::~Journal()
+{
+  Model::removeRecorder(this);
+#ifndef _WIN32
+  if (fd >= 0)
+    ::close(fd);
+#endif
+}
+
+string Journal::snapshotName(const uint64_t &e) const
+{
+  return base + "." + to_string(e) + ".snap";
+}
+
+bool Journal::hasCheckpoint() const
+{
+  return generation > 0;
+}
+
+uint64_t Journal::getGeneration() const
+{
+  return generation;
+}
+
+// A journal that can not checkpoint is never full, or every command would try and fail
+bool Journal::isFull() const
+{
+  lock_guard<mutex> guard(lock);
+  return broken.empty() and bytes >= checkpointBytes;
+}
+
+bool Journal::isBroken() const
+{
+  lock_guard<mutex> guard(lock);
+  return !broken.empty();
+}
+
+void Journal::setSync(const bool &e)
+{
+  syncing = e;
+}
+
+void Journal::setCheckpointBytes(const uint64_t &e)
+{
+  checkpointBytes = e;
+}
+
+uint64_t Journal::getSyncs() const
+{
+  lock_guard<mutex> guard(lock);
+  return syncs;
+}
+
+uint64_t Journal::getCheckpoints() const
+{
+  return checkpoints;
+}
+
+long Journal::getFailures() const
+{
+  return failures;
+}
+
+const string &Journal::getFailure() const
+{
+  return failure;
+}
+
+uint64_t Journal::getTruncated() const
+{
+  return truncated;
+}
+
+uint32_t Journal::crc(const char *data, const size_t &size)
+{
+  static uint32_t table[256];
+  static bool filled{[]() {
+    for (uint32_t i{0}; i < 256; i++)
+    {
+      uint32_t c{i};
+      for (int k{0}; k < 8; k++)
+        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+    return true;
+  }()};
+  uint32_t c{0xFFFFFFFFu};
+
+  (void)filled;
+  for (size_t i{0}; i < size; i++)
+    c = table[(c ^ uint8_t(data[i])) & 0xFF] ^ (c >> 8);
+  return c ^ 0xFFFFFFFFu;
+}
+
+// Kind, then every field as "<bytes>:<text>"
+string Journal::encode(const Record &record)
+{
+  string result(1, record.kind);
+  for (const string &e : {record.model, to_string(record.entity), record.element, to_string(record.option), record.value})
+    result += to_string(e.size()) + ":" + e;
+  return result;
+}
+
+bool Journal::decode(const char *data, const size_t &size, Record &record)
+{
+  string fields[5];
+  size_t at{1};
+
+  if (size == 0 or string("EARSC").find(data[0]) == string::npos)
+    return false;
+  for (string &e : fields)
+  {
+    size_t length{0};
+    while (at < size and isdigit(static_cast<unsigned char>(data[at])))
+      length = length * 10 + size_t(data[at++] - '0');
+    if (at >= size or data[at] != ':' or size - at - 1 < length)
+      return false;
+    e.assign(data + at + 1, length);
+    at += length + 1;
+  }
+
+  record.kind = data[0];
+  record.model = fields[0];
+  record.entity = atoi(fields[1].c_str());
+  record.element = fields[2];
+  record.option = atoi(fields[3].c_str());
+  record.value = fields[4];
+  return at == size;
+}
+
+#ifndef _WIN32
+
+void Journal::sync(const int &e)
+{
+  if (fsync(e) < 0)
+    throw Exception("No se pudo sincronizar la bitacora: " + string(strerror(errno)));
+}
+
+void Journal::syncFile(const string &name)
+{
+  int e{::open(name.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (e < 0)
+    throw Exception("No se pudo abrir " + name);
+  int synced{fsync(e)};
+  int error{errno};
+  ::close(e);
+  if (synced < 0)
+    throw Exception("No se pudo sincronizar " + name + ": " + strerror(error));
+}
+
+void Journal::syncDirectory(const string &name)
+{
+  string::size_type slash{name.rfind('/')};
+  string directory{slash == string::npos ? "." : slash == 0 ? "/" : name.substr(0, slash)};
+  int e{::open(directory.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (e < 0)
+    throw Exception("No se pudo abrir " + directory + ": " + strerror(errno));
+  int synced{fsync(e)};
+  int error{errno};
+  ::close(e);
+  if (synced < 0)
+    throw Exception("No se pudo sincronizar " + directory + ": " + strerror(error));
+}
+
+void Journal::write(const string &data) const
+{
+  for (size_t done{0}; done < data.size();)
+  {
+    ssize_t written{::write(fd, data.data() + done, data.size() - done)};
+    if (written < 0 and errno == EINTR)
+      continue;
+    if (written < 0)
+      throw Exception("No se pudo escribir la bitacora: " + string(strerror(errno)));
+    done += size_t(written);
+  }
+}
+
+int Journal::create(const uint64_t &e) const
+{
+  string name{base + ".wal"};
+  string temporary{name + ".tmp"};
+  string header{"MMWAL " + to_string(e) + "\n"};
+  int created{::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+
+  if (created < 0)
+    throw Exception("No se pudo crear " + temporary + ": " + strerror(errno));
+  if (::write(created, header.data(), header.size()) != ssize_t(header.size()) or fsync(created) < 0 or rename(temporary.c_str(), name.c_str()) < 0)
+  {
+    ::close(created);
+    throw Exception("No se pudo crear " + name + ": " + strerror(errno));
+  }
+  try
+  {
+    syncDirectory(name);
+  }
+  catch (Exception &)
+  {
+    ::close(created);
+    throw;
+  }
+  return created;
+}
+
+void Journal::open(const string &e)
+{
+  char header[64];
+  ssize_t read;
+
+  if (fd >= 0)
+    throw Exception("La bitacora ya esta abierta");
+
+  base = e;
+  string name{base + ".wal"};
+  if ((fd = ::open(name.c_str(), O_RDWR | O_CLOEXEC)) < 0)
+  {
+    if (errno != ENOENT)
+      throw Exception("No se pudo abrir " + name + ": " + strerror(errno));
+    fd = create(0);
+  }
+
+  read = pread(fd, header, sizeof(header) - 1, 0);
+  header[read > 0 ? read : 0] = '\0';
+  const char *end{strchr(header, '\n')};
+  if (strncmp(header, "MMWAL ", 6) != 0 or end == nullptr or !isdigit(static_cast<unsigned char>(header[6])))
+    throw Exception("Bitacora invalida: " + name);
+  generation = strtoull(header + 6, nullptr, 10);
+  headerBytes = size_t(end - header + 1);
+  lseek(fd, off_t(headerBytes), SEEK_SET);
+}
+
+long Journal::recover(const function<void(const Record &)> &replay)
+{
+  struct stat status;
+  long records{0};
+  Record record;
+
+  if (fd < 0)
+    throw Exception("La bitacora no esta abierta");
+
+  if (generation > 0)
+  {
+    Snapshot snapshot;
+    snapshot.open(snapshotName(generation));
+    snapshot.load(modelList);
+  }
+
+  fstat(fd, &status);
+  string data(size_t(status.st_size), '\0');
+  if (pread(fd, &data[0], data.size(), 0) != ssize_t(data.size()))
+    throw Exception("No se pudo leer la bitacora");
+
+  size_t offset{headerBytes};
+  string rejected;
+  while (offset < data.size())
+  {
+    size_t newline{data.find('\n', offset)};
+    if (newline == string::npos or newline - offset > 32)
+      break;
+    char *end{nullptr};
+    unsigned long long size{strtoull(data.c_str() + offset, &end, 10)};
+    unsigned long checksum{*end == ' ' ? strtoul(end + 1, &end, 16) : 0};
+    if (*end != '\n' or size > data.size() - newline - 1 or crc(data.data() + newline + 1, size_t(size)) != checksum or !decode(data.data() + newline + 1, size_t(size), record))
+      break;
+
+    records++;
+    try
+    {
+      replay(record);
+    }
+    catch (std::exception &ex)
+    {
+      if (failures++ == 0)
+        failure = "Registro " + to_string(records) + " de la bitacora no aplicado, guardado en " + base + ".rejected: " + ex.what();
+      rejected.append(data, offset, newline + 1 + size_t(size) - offset);
+    }
+    offset = newline + 1 + size_t(size);
+  }
+
+  // Records that do not replay are set aside with their frame, so a checkpoint can go on without losing them
+  if (!rejected.empty())
+  {
+    string name{base + ".rejected"};
+    int e{::open(name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)};
+    if (e < 0)
+      throw Exception("No se pudo abrir " + name + ": " + strerror(errno));
+    bool written{::write(e, rejected.data(), rejected.size()) == ssize_t(rejected.size()) and fsync(e) == 0};
+    int error{errno};
+    ::close(e);
+    if (!written)
+      throw Exception("No se pudo escribir " + name + ": " + strerror(error));
+  }
+
+  truncated = data.size() - offset;
+  if (truncated > 0)
+  {
+    if (ftruncate(fd, off_t(offset)) < 0)
+      throw Exception("No se pudo cortar la bitacora: " + string(strerror(errno)));
+    sync(fd);
+  }
+  lseek(fd, off_t(offset), SEEK_SET);
+  bytes = offset - headerBytes;
+  return records;
+}
+
+void Journal::commit(const uint64_t &sequence)
+{
+  unique_lock<mutex> guard(lock);
+
+  while (durable < sequence)
+  {
+    if (!broken.empty())
+      throw Exception(broken);
+    if (flushing)
+    {
+      flushed.wait(guard);
+      continue;
+    }
+
+    string group;
+    group.swap(pending);
+    uint64_t last{appended};
+    flushing = true;
+    guard.unlock();
+    try
+    {
+      write(group);
+      if (syncing and fdatasync(fd) < 0)
+        throw Exception("No se pudo sincronizar la bitacora: " + string(strerror(errno)));
+    }
+    catch (Exception &ex)
+    {
+      guard.lock();
+      broken = ex.what();
+      flushing = false;
+      flushed.notify_all();
+      throw;
+    }
+    guard.lock();
+    flushing = false;
+    durable = max(durable, last);
+    bytes += group.size();
+    syncs++;
+    flushed.notify_all();
+  }
+}
+
+// Writes the snapshot, then switches to an empty log that names it; records still pending are in the snapshot
+void Journal::checkpoint()
+{
+  unique_lock<mutex> guard(lock);
+  while (flushing)
+    flushed.wait(guard);
+  if (!broken.empty())
+    throw Exception(broken);
+
+  uint64_t next{generation + 1};
+  Snapshot::save(modelList, snapshotName(next));
+  syncFile(snapshotName(next));
+  int created{create(next)};
+  ::close(fd);
+  fd = created;
+  if (generation > 0)
+    std::remove(snapshotName(generation).c_str());
+
+  generation = next;
+  headerBytes = ("MMWAL " + to_string(next) + "\n").size();
+  pending.clear();
+  durable = appended;
+  bytes = 0;
+  checkpoints++;
+  flushed.notify_all();
+}
+
+#else
+
+void Journal::open(const string &)
+{
+  throw Exception("Bitacora no disponible en esta plataforma");
+}
+
+long Journal::recover(const function<void(const Record &)> &)
+{
+  throw Exception("Bitacora no disponible en esta plataforma");
+}
+
+void Journal::commit(const uint64_t &) {}
+
+void Journal::checkpoint() {}
+
+#endif
+
+uint64_t Journal::append(const Record &record)
+{
+  string data{encode(record)};
+  char header[32];
+  snprintf(header, sizeof(header), "%zu %08x\n", data.size(), crc(data.data(), data.size()));
+
+  lock_guard<mutex> guard(lock);
+  if (!broken.empty())
+    throw Exception(broken);
+  pending += header;
+  pending += data;
+  return ++appended;
+}
+
+void Journal::log(const Record &record)
+{
+  uint64_t sequence{append(record)};
+  if (group == this)
+    grouped = sequence;
+  else
+    commit(sequence);
+}
+
+void Journal::beginGroup()
+{
+  group = this;
+  grouped = 0;
+}
+
+uint64_t Journal::endGroup()
+{
+  group = nullptr;
+  return grouped;
+}
+
+void Journal::apply(List<Model> &modelList, const Record &record)
+{
+  // Adds are read by the Loader into a scratch list, an element under an empty model record
+  List<Model> parsed;
+  if (record.kind == 'A')
+  {
+    istringstream text(record.entity == 0 ? record.value : "1\n\n\n\n" + record.value);
+    Loader(parsed).load(text);
+    if (parsed.isEmpty())
+      throw Exception("Registro invalido: " + record.value);
+  }
+
+  if (record.kind == 'A' and record.entity == 0)
+  {
+    modelList.insert(*parsed.getFirst()->getDataPtr(), modelList.back());
+    return;
+  }
+  if (record.kind == 'S' and record.entity == 0)
+  {
+    modelList.sort();
+    return;
+  }
+
+  Node<Model> *auxNodeModel{modelList.searchByName(record.model)};
+  if (auxNodeModel == nullptr)
+    throw Exception("Modelo no encontrado: " + record.model);
+  Model &model{*auxNodeModel->getDataPtr()};
+
+  if (record.kind == 'A')
+  {
+    Model &source{*parsed.getFirst()->getDataPtr()};
+    if (record.entity == 1 and !source.getReactionList().isEmpty())
+      model.addReaction(*source.getReactionList().getFirst()->getDataPtr());
+    else if (record.entity == 2 and !source.getMetaboliteList().isEmpty())
+      model.addMetabolite(*source.getMetaboliteList().getFirst()->getDataPtr());
+    else if (record.entity == 3 and !source.getGenList().isEmpty())
+      model.addGen(*source.getGenList().getFirst()->getDataPtr());
+    else
+      throw Exception("Registro invalido: " + record.value);
+  }
+  else if (record.kind == 'R' and record.entity == 0)
+    modelList.remove(auxNodeModel);
+  else if (record.kind == 'R')
+  {
+    Node<Reaction> *reaction{record.entity == 1 ? model.findReaction(record.element) : nullptr};
+    Node<Metabolite> *metabolite{record.entity == 2 ? model.findMetabolite(record.element) : nullptr};
+    Node<Gen> *gen{record.entity == 3 ? model.findGen(record.element) : nullptr};
+    if (reaction == nullptr and metabolite == nullptr and gen == nullptr)
+      throw Exception("No encontrado: " + record.element);
+    if (reaction != nullptr)
+      model.removeReaction(reaction);
+    else if (metabolite != nullptr)
+      model.removeMetabolite(metabolite);
+    else
+      model.removeGen(gen);
+  }
+  else if (record.kind == 'S')
+  {
+    if (record.entity == 1)
+      model.sortReactions();
+    else if (record.entity == 2)
+      model.sortMetabolites();
+    else
+      model.sortGens();
+  }
+  else if (record.entity == 0)
+  {
+    if (record.option == 1)
+      modelList.rename(auxNodeModel, record.value);
+    else if (record.option == 2)
+      model.setObjetiveExpression(record.value);
+    else
+      model.setCompartments(record.value);
+  }
+  else if (record.entity == 1)
+  {
+    Node<Reaction> *position{model.findReaction(record.element)};
+    if (position == nullptr)
+      throw Exception("Reaccion no encontrada: " + record.element);
+    model.editReaction(position, record.option, record.value);
+  }
+  else if (record.entity == 2)
+  {
+    Node<Metabolite> *position{model.findMetabolite(record.element)};
+    if (position == nullptr)
+      throw Exception("Metabolito no encontrado: " + record.element);
+    model.editMetabolite(position, record.option, record.value);
+  }
+  else
+  {
+    Node<Gen> *position{model.findGen(record.element)};
+    if (position == nullptr)
+      throw Exception("Gen no encontrado: " + record.element);
+    model.editGen(position, record.option, record.value);
+  }
+}
+
+// Only the models of the journaled list are recorded, copies and scratch models are not
+void Journal::record(void *owner, const Model &model, const char &kind, const int &entity, const string &element, const int &option, const string &value)
+{
+  Journal &journal{*static_cast<Journal *>(owner)};
+  Node<Model> *aux{journal.modelList.getFirst()};
+
+  while (aux != nullptr and aux->getDataPtr() != &model)
+    aux = aux->getNext();
+  if (aux != nullptr)
+    journal.log(Record{kind, model.getName(), entity, element, option, value});
+}
+
+//* -------- ------- ------ ----- Simplex ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Bounded revised primal simplex for max c'x subject to S x = 0 and l <= x <= u.
+// Every row i has an artificial column a_i with S_i x + a_i = 0, fixed at zero unless setRowBounds gives the row a
+// range, so the identity is always a valid starting basis. The basis is
+// kept as a sparse LU factorization updated Forrest-Tomlin style (row etas on L, the new column moved to the end of
+// U) and rebuilt every refactorInterval pivots. Phase 1 minimizes the sum of infeasibilities, so a solve can warm
+// start from the basis the previous one left even after the bounds change
+class Simplex
+{
+public:
+  enum Status
+  {
+    OPTIMAL,
+    INFEASIBLE,
+    UNBOUNDED,
+    ITERATION_LIMIT
+  };
+
+private:
+  enum State
+  {
+    BASIC,
+    LOWER,
+    UPPER,
+    ZERO //nonbasic at zero between its bounds
+  };
+
+  static const int refactorInterval{100};
+  static const int degenerateLimit{1000};
+  static constexpr double feasibilityTolerance{1e-7};
+  static constexpr double optimalityTolerance{1e-7};
+  static constexpr double pivotTolerance{1e-9};
+
+  const StoichiometricMatrix *matrix;
+  int rows;
+  int columns;
+
+  vector<double> lower;
+  vector<double> upper;
+  vector<double> cost;
+  vector<double> value;
+  vector<State> state;
+  vector<int> basis; //variable in each basis row
+  bool factored;
+  bool cold;
+  int updates;
+
+  // L^-1 as column etas from the factorization (x_i -= value * x_row) followed by the row etas of the updates
+  // (x_row -= value * x_i)
+  vector<int> lowerRow;
+  vector<int> lowerStart;
+  vector<int> lowerIndex;
+  vector<double> lowerValue;
+  vector<int> updateRow;
+  vector<int> updateStart;
+  vector<int> updateIndex;
+  vector<double> updateValue;
+
+  // U by columns, one per basis row, upper triangular in the order given by pivotOrder (-1 marks moved columns).
+  // Column r lives in upperIndex/upperValue between upperStart[r] and upperEnd[r]; replaced columns are appended
+  // and entries eliminated by an update are zeroed in place until the next refactor
+  vector<int> upperStart;
+  vector<int> upperEnd;
+  vector<int> upperIndex;
+  vector<double> upperValue;
+  vector<double> upperDiagonal;
+  vector<vector<int>> upperRowColumns; //columns that may hold an entry in each row
+  vector<int> pivotOrder;
+  vector<int> pivotPosition;
+
+  vector<double> dual;
+  vector<double> direction;
+  vector<double> spike;
+
+  Status status;
+  long iterations;
+  double objectiveValue;
+
+  void column(const int &, vector<double> &) const;
+  double dot(const vector<double> &, const int &) const;
+  void ftran(vector<double> &, vector<double> * = nullptr) const;
+  void btran(vector<double> &) const;
+  bool update(const int &);
+  void setNonbasic(const int &);
+  void crash();
+  void refactor();
+  void computeBasicValues();
+  bool isFeasible() const;
+  Status run(const bool &);
+
+public:
+  explicit Simplex(const StoichiometricMatrix &);
+
+  int getColumns() const;
+  double getLower(const int &) const;
+  double getUpper(const int &) const;
+  void setBounds(const int &, const double &, const double &);
+  void setRowBounds(const int &, const double &, const double &);
+  void setObjective(const vector<double> &);
+  void reset();
+
+  Status solve();
+
+  Status getStatus() const;
+  double getObjectiveValue() const;
+  double getValue(const int &) const;
+  vector<double> getValues() const;
+  long getIterations() const;
+
+  static string toString(const Status &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Simplex::Simplex(const StoichiometricMatrix &e) : matrix(&e), rows(e.getRows()), columns(e.getColumns()), factored(false), cold(true), updates(0), status(OPTIMAL), iterations(0), objectiveValue(0)
+{
+  lower.assign(columns + rows, 0);
+  upper.assign(columns + rows, 0);
+  cost.assign(columns + rows, 0);
+  value.assign(columns + rows, 0);
+  state.assign(columns + rows, ZERO);
+  reset();
+}
+
+// Scatters column j (structural or artificial) into a dense vector
+void Simplex::column(const int &j, vector<double> &result) const
+{
+  result.assign(rows, 0);
+  if (j >= columns)
+  {
+    result[j - columns] = 1;
+    return;
+  }
+  const vector<int> &start{matrix->getColumnStart()};
+  const vector<int> &index{matrix->getRowIndex()};
+  const vector<double> &coefficient{matrix->getColumnValue()};
+  for (int k{start[j]}; k < start[j + 1]; k++)
+  {
+    result[index[k]] = coefficient[k];
+  }
+}
+
+double Simplex::dot(const vector<double> &y, const int &j) const
+{
+  if (j >= columns)
+    return y[j - columns];
+
+  const vector<int> &start{matrix->getColumnStart()};
+  const vector<int> &index{matrix->getRowIndex()};
+  const vector<double> &coefficient{matrix->getColumnValue()};
+  double result{0};
+  for (int k{start[j]}; k < start[j + 1]; k++)
+  {
+    result += y[index[k]] * coefficient[k];
+  }
+  return result;
+}
+
+// x = B^-1 x. When asked, L^-1 x is kept as the spike for the next update
+void Simplex::ftran(vector<double> &x, vector<double> *partial) const
+{
+  for (size_t k{0}; k < lowerRow.size(); k++)
+  {
+    double pivotValue{x[lowerRow[k]]};
+    if (pivotValue == 0)
+      continue;
+    for (int p{lowerStart[k]}; p < lowerStart[k + 1]; p++)
+    {
+      x[lowerIndex[p]] -= lowerValue[p] * pivotValue;
+    }
+  }
+  for (size_t k{0}; k < updateRow.size(); k++)
+  {
+    double sum{x[updateRow[k]]};
+    for (int p{updateStart[k]}; p < updateStart[k + 1]; p++)
+    {
+      sum -= updateValue[p] * x[updateIndex[p]];
+    }
+    x[updateRow[k]] = sum;
+  }
+  if (partial != nullptr)
+    *partial = x;
+
+  for (size_t t{pivotOrder.size()}; t-- > 0;)
+  {
+    int r{pivotOrder[t]};
+    if (r < 0 or x[r] == 0)
+      continue;
+    x[r] /= upperDiagonal[r];
+    double pivotValue{x[r]};
+    for (int p{upperStart[r]}; p < upperEnd[r]; p++)
+    {
+      x[upperIndex[p]] -= upperValue[p] * pivotValue;
+    }
+  }
+}
+
+// w' = w' B^-1
+void Simplex::btran(vector<double> &w) const
+{
+  for (int r : pivotOrder)
+  {
+    if (r < 0)
+      continue;
+    double sum{w[r]};
+    for (int p{upperStart[r]}; p < upperEnd[r]; p++)
+    {
+      sum -= upperValue[p] * w[upperIndex[p]];
+    }
+    w[r] = sum / upperDiagonal[r];
+  }
+  for (size_t k{updateRow.size()}; k-- > 0;)
+  {
+    double pivotValue{w[updateRow[k]]};
+    if (pivotValue == 0)
+      continue;
+    for (int p{updateStart[k]}; p < updateStart[k + 1]; p++)
+    {
+      w[updateIndex[p]] -= updateValue[p] * pivotValue;
+    }
+  }
+  for (size_t k{lowerRow.size()}; k-- > 0;)
+  {
+    double sum{w[lowerRow[k]]};
+    for (int p{lowerStart[k]}; p < lowerStart[k + 1]; p++)
+    {
+      sum -= lowerValue[p] * w[lowerIndex[p]];
+    }
+    w[lowerRow[k]] = sum;
+  }
+}
+
+// Replaces the U column of basis row r with the spike of the entering column: row r is eliminated from the columns
+// after it with a row eta and the column moves to the end of the pivot order. False when the new diagonal is too
+// small, the caller then refactors
+bool Simplex::update(const int &r)
+{
+  vector<double> row(rows, 0);
+  vector<int> seen(rows, -1);
+  vector<pair<int, int>> heap; //(position, column), smallest position first
+  auto later = [](const pair<int, int> &a, const pair<int, int> &b) { return a.first > b.first; };
+
+  upperEnd[r] = upperStart[r];
+
+  for (int c : upperRowColumns[r])
+  {
+    for (int p{upperStart[c]}; p < upperEnd[c]; p++)
+    {
+      if (upperIndex[p] != r or upperValue[p] == 0)
+        continue;
+      if (row[c] == 0)
+        heap.push_back(make_pair(pivotPosition[c], c));
+      row[c] += upperValue[p];
+      upperValue[p] = 0;
+      break;
+    }
+  }
+  upperRowColumns[r].clear();
+  make_heap(heap.begin(), heap.end(), later);
+
+  double diagonal{spike[r]};
+  size_t first{updateIndex.size()};
+  while (!heap.empty())
+  {
+    pop_heap(heap.begin(), heap.end(), later);
+    int c{heap.back().second};
+    heap.pop_back();
+    if (row[c] == 0)
+      continue;
+
+    double multiplier{row[c] / upperDiagonal[c]};
+    row[c] = 0;
+    updateIndex.push_back(c);
+    updateValue.push_back(multiplier);
+    diagonal -= multiplier * spike[c];
+
+    for (int k : upperRowColumns[c])
+    {
+      if (seen[k] == c)
+        continue;
+      seen[k] = c;
+      for (int p{upperStart[k]}; p < upperEnd[k]; p++)
+      {
+        if (upperIndex[p] != c or upperValue[p] == 0)
+          continue;
+        if (row[k] == 0)
+        {
+          heap.push_back(make_pair(pivotPosition[k], k));
+          push_heap(heap.begin(), heap.end(), later);
+        }
+        row[k] -= multiplier * upperValue[p];
+        break;
+      }
+    }
+  }
+  if (updateIndex.size() > first)
+  {
+    updateRow.push_back(r);
+    updateStart.push_back(int(updateIndex.size()));
+  }
+
+  upperStart[r] = int(upperIndex.size());
+  for (int i{0}; i < rows; i++)
+  {
+    if (i != r and fabs(spike[i]) > 1e-12)
+    {
+      upperIndex.push_back(i);
+      upperValue.push_back(spike[i]);
+      upperRowColumns[i].push_back(r);
+    }
+  }
+  upperEnd[r] = int(upperIndex.size());
+  upperDiagonal[r] = diagonal;
+  pivotOrder[pivotPosition[r]] = -1;
+  pivotPosition[r] = int(pivotOrder.size());
+  pivotOrder.push_back(r);
+  updates++;
+
+  return fabs(diagonal) > pivotTolerance;
+}
+
+// Places a nonbasic variable at zero when its bounds allow it, otherwise at the nearest bound
+void Simplex::setNonbasic(const int &j)
+{
+  if (lower[j] <= 0 and upper[j] >= 0)
+  {
+    state[j] = lower[j] == 0 ? LOWER : upper[j] == 0 ? UPPER : ZERO;
+    value[j] = 0;
+  }
+  else if (lower[j] > 0)
+  {
+    state[j] = LOWER;
+    value[j] = lower[j];
+  }
+  else
+  {
+    state[j] = UPPER;
+    value[j] = upper[j];
+  }
+}
+
+// Triangular crash basis: structural columns replace artificials in order of preference (wide bounds around zero
+// first), each pivoting on a row no earlier column touches, so the result is triangular and needs no elimination.
+// Starting from many structurals instead of only artificials saves roughly one pivot per row taken
+void Simplex::crash()
+{
+  const vector<int> &start{matrix->getColumnStart()};
+  const vector<int> &index{matrix->getRowIndex()};
+  const vector<double> &coefficient{matrix->getColumnValue()};
+  vector<char> touched(rows, 0);
+  vector<int> candidates;
+
+  for (int j{0}; j < columns; j++)
+  {
+    if (state[j] != BASIC and value[j] == 0 and lower[j] < upper[j] and start[j + 1] > start[j])
+      candidates.push_back(j);
+  }
+  auto preference = [&](const int &j) { return make_pair(lower[j] < 0 and upper[j] > 0, upper[j] - lower[j]); };
+  std::stable_sort(candidates.begin(), candidates.end(), [&](const int &a, const int &b) { return preference(a) > preference(b); });
+
+  for (int j : candidates)
+  {
+    double largest{0};
+    for (int k{start[j]}; k < start[j + 1]; k++)
+    {
+      largest = max(largest, fabs(coefficient[k]));
+    }
+    int r{-1};
+    for (int k{start[j]}; k < start[j + 1] and r < 0; k++)
+    {
+      if (!touched[index[k]] and basis[index[k]] == columns + index[k] and fabs(coefficient[k]) >= 0.5 * largest)
+        r = index[k];
+    }
+    if (r < 0)
+      continue;
+
+    for (int k{start[j]}; k < start[j + 1]; k++)
+    {
+      touched[index[k]] = 1;
+    }
+    setNonbasic(columns + r);
+    basis[r] = j;
+    state[j] = BASIC;
+  }
+}
+
+// Factorizes the current basis as B = L U. Row and column singletons are pivoted first without any elimination,
+// which covers most of a metabolic basis; the remaining nucleus is eliminated left-looking with threshold pivoting
+// on the sparsest rows. Columns that turn out dependent are dropped from the basis and their rows given back to the
+// artificials
+void Simplex::refactor()
+{
+  const vector<int> &start{matrix->getColumnStart()};
+  const vector<int> &index{matrix->getRowIndex()};
+  const vector<double> &coefficient{matrix->getColumnValue()};
+  const vector<int> &rowStart{matrix->getRowStart()};
+  const vector<int> &columnIndex{matrix->getColumnIndex()};
+
+  vector<int> newBasis(rows, -1);
+  vector<int> position(columns, -1); //index in structural, -1 when not a basic structural
+  vector<int> structural;
+  vector<int> rowCount(rows, 0);
+  vector<int> columnCount;
+  vector<char> active;
+  vector<int> rowQueue, columnQueue;
+
+  lowerRow.clear();
+  lowerStart.assign(1, 0);
+  lowerIndex.clear();
+  lowerValue.clear();
+  updateRow.clear();
+  updateStart.assign(1, 0);
+  updateIndex.clear();
+  updateValue.clear();
+  upperStart.assign(rows, 0);
+  upperEnd.assign(rows, 0);
+  upperIndex.clear();
+  upperValue.clear();
+  upperDiagonal.assign(rows, 1);
+  upperRowColumns.assign(rows, vector<int>());
+  pivotOrder.clear();
+  pivotPosition.assign(rows, -1);
+  updates = 0;
+
+  for (int r{0}; r < rows; r++)
+  {
+    if (basis[r] >= columns)
+    {
+      int row{basis[r] - columns};
+      newBasis[row] = basis[r];
+      pivotPosition[row] = int(pivotOrder.size());
+      pivotOrder.push_back(row);
+    }
+  }
+  for (int r{0}; r < rows; r++)
+  {
+    if (basis[r] < columns)
+    {
+      position[basis[r]] = int(structural.size());
+      structural.push_back(basis[r]);
+    }
+  }
+  columnCount.assign(structural.size(), 0);
+  active.assign(structural.size(), 1);
+  for (size_t c{0}; c < structural.size(); c++)
+  {
+    for (int k{start[structural[c]]}; k < start[structural[c] + 1]; k++)
+    {
+      if (newBasis[index[k]] < 0)
+      {
+        rowCount[index[k]]++;
+        columnCount[c]++;
+      }
+    }
+    if (columnCount[c] <= 1)
+      columnQueue.push_back(int(c));
+  }
+  for (int r{0}; r < rows; r++)
+  {
+    if (newBasis[r] < 0 and rowCount[r] == 1)
+      rowQueue.push_back(r);
+  }
+
+  // Pivots column c on row r: entries on rows not pivoted yet go to an L eta, the rest to the U column
+  vector<double> v(rows, 0);
+  vector<int> nonZeros;
+  auto pivot = [&](const int &r, const int &c) {
+    double pivotValue{v[r]};
+    upperStart[r] = int(upperIndex.size());
+    for (int i : nonZeros)
+    {
+      if (i == r or fabs(v[i]) <= 1e-12)
+        continue;
+      if (newBasis[i] < 0)
+      {
+        lowerIndex.push_back(i);
+        lowerValue.push_back(v[i] / pivotValue);
+      }
+      else
+      {
+        upperIndex.push_back(i);
+        upperValue.push_back(v[i]);
+        upperRowColumns[i].push_back(r);
+      }
+    }
+    upperEnd[r] = int(upperIndex.size());
+    if (lowerStart.back() != int(lowerIndex.size()))
+    {
+      lowerRow.push_back(r);
+      lowerStart.push_back(int(lowerIndex.size()));
+    }
+    upperDiagonal[r] = pivotValue;
+    pivotPosition[r] = int(pivotOrder.size());
+    pivotOrder.push_back(r);
+
+    newBasis[r] = structural[c];
+    active[c] = 0;
+    for (int k{start[structural[c]]}; k < start[structural[c] + 1]; k++)
+    {
+      if (newBasis[index[k]] < 0 and --rowCount[index[k]] == 1)
+        rowQueue.push_back(index[k]);
+    }
+    for (int k{rowStart[r]}; k < rowStart[r + 1]; k++)
+    {
+      int other{position[columnIndex[k]]};
+      if (other >= 0 and active[other] and --columnCount[other] == 1)
+        columnQueue.push_back(other);
+    }
+  };
+  auto scatter = [&](const int &c) {
+    nonZeros.clear();
+    for (int k{start[structural[c]]}; k < start[structural[c] + 1]; k++)
+    {
+      v[index[k]] = coefficient[k];
+      nonZeros.push_back(index[k]);
+    }
+  };
+  auto clear = [&]() {
+    for (int i : nonZeros)
+      v[i] = 0;
+  };
+
+  // Singletons: the entries of these columns are never touched by the L etas created before them
+  while (!rowQueue.empty() or !columnQueue.empty())
+  {
+    int r{-1}, c{-1};
+    if (!columnQueue.empty())
+    {
+      c = columnQueue.back();
+      columnQueue.pop_back();
+      if (!active[c] or columnCount[c] > 1)
+        continue;
+      for (int k{start[structural[c]]}; k < start[structural[c] + 1] and r < 0; k++)
+      {
+        if (newBasis[index[k]] < 0)
+          r = index[k];
+      }
+      if (r < 0)
+      {
+        active[c] = 0;
+        setNonbasic(structural[c]);
+        continue;
+      }
+    }
+    else
+    {
+      r = rowQueue.back();
+      rowQueue.pop_back();
+      if (newBasis[r] >= 0 or rowCount[r] != 1)
+        continue;
+      for (int k{rowStart[r]}; k < rowStart[r + 1] and c < 0; k++)
+      {
+        int candidate{position[columnIndex[k]]};
+        if (candidate >= 0 and active[candidate])
+          c = candidate;
+      }
+      if (c < 0)
+        continue;
+    }
+
+    scatter(c);
+    if (fabs(v[r]) >= pivotTolerance)
+      pivot(r, c);
+    clear();
+  }
+
+  // Nucleus
+  for (size_t c{0}; c < structural.size(); c++)
+  {
+    if (!active[c])
+      continue;
+
+    scatter(int(c));
+    for (size_t k{0}; k < lowerRow.size(); k++)
+    {
+      double pivotValue{v[lowerRow[k]]};
+      if (pivotValue == 0)
+        continue;
+      for (int p{lowerStart[k]}; p < lowerStart[k + 1]; p++)
+      {
+        if (v[lowerIndex[p]] == 0)
+          nonZeros.push_back(lowerIndex[p]);
+        v[lowerIndex[p]] -= lowerValue[p] * pivotValue;
+      }
+    }
+    std::sort(nonZeros.begin(), nonZeros.end());
+    nonZeros.erase(unique(nonZeros.begin(), nonZeros.end()), nonZeros.end());
+
+    double largest{0};
+    for (int i : nonZeros)
+    {
+      if (newBasis[i] < 0)
+        largest = max(largest, fabs(v[i]));
+    }
+    int r{-1};
+    for (int i : nonZeros)
+    {
+      if (newBasis[i] < 0 and fabs(v[i]) >= 0.1 * largest and fabs(v[i]) >= pivotTolerance and (r < 0 or rowCount[i] < rowCount[r]))
+        r = i;
+    }
+    if (r < 0)
+    {
+      active[c] = 0;
+      setNonbasic(structural[c]);
+    }
+    else
+    {
+      pivot(r, int(c));
+    }
+    clear();
+  }
+
+  for (int r{0}; r < rows; r++)
+  {
+    if (newBasis[r] < 0)
+    {
+      newBasis[r] = columns + r;
+      state[columns + r] = BASIC;
+      pivotPosition[r] = int(pivotOrder.size());
+      pivotOrder.push_back(r);
+    }
+  }
+  basis = newBasis;
+  factored = true;
+}
+
+// x_B = -B^-1 N x_N
+void Simplex::computeBasicValues()
+{
+  vector<double> rhs(rows, 0);
+  const vector<int> &start{matrix->getColumnStart()};
+  const vector<int> &index{matrix->getRowIndex()};
+  const vector<double> &coefficient{matrix->getColumnValue()};
+
+  for (int j{0}; j < columns; j++)
+  {
+    if (state[j] == BASIC or value[j] == 0)
+      continue;
+    for (int k{start[j]}; k < start[j + 1]; k++)
+    {
+      rhs[index[k]] -= coefficient[k] * value[j];
+    }
+  }
+  for (int r{0}; r < rows; r++)
+  {
+    if (state[columns + r] != BASIC)
+      rhs[r] -= value[columns + r];
+  }
+  ftran(rhs);
+  for (int r{0}; r < rows; r++)
+  {
+    value[basis[r]] = rhs[r];
+  }
+}
+
+bool Simplex::isFeasible() const
+{
+  for (int r{0}; r < rows; r++)
+  {
+    int j{basis[r]};
+    if (value[j] < lower[j] - feasibilityTolerance or value[j] > upper[j] + feasibilityTolerance)
+      return false;
+  }
+  return true;
+}
+
+// Runs phase 1 (drive the basic variables inside their bounds) or phase 2 (maximize the objective) to completion
+Simplex::Status Simplex::run(const bool &phaseOne)
+{
+  long limit{iterations + 20L * (rows + columns) + 1000};
+  int degenerate{0};
+
+  while (true)
+  {
+    if (iterations >= limit)
+      return ITERATION_LIMIT;
+    if (updates >= refactorInterval)
+    {
+      refactor();
+      computeBasicValues();
+    }
+
+    bool infeasible{false};
+    dual.assign(rows, 0);
+    for (int r{0}; r < rows; r++)
+    {
+      int j{basis[r]};
+      if (!phaseOne)
+        dual[r] = cost[j];
+      else if (value[j] < lower[j] - feasibilityTolerance)
+        dual[r] = 1, infeasible = true;
+      else if (value[j] > upper[j] + feasibilityTolerance)
+        dual[r] = -1, infeasible = true;
+    }
+    if (phaseOne and !infeasible)
+      return OPTIMAL;
+    btran(dual);
+
+    // Pricing: Dantzig's largest reduced cost, Bland's smallest index while stalled on a degenerate vertex
+    bool bland{degenerate > degenerateLimit};
+    int entering{-1};
+    double best{0};
+    double sign{0};
+    for (int j{0}; j < columns + rows; j++)
+    {
+      if (state[j] == BASIC or lower[j] == upper[j])
+        continue;
+      double reduced{(phaseOne ? 0 : cost[j]) - dot(dual, j)};
+      bool up{reduced > optimalityTolerance and state[j] != UPPER};
+      bool down{reduced < -optimalityTolerance and state[j] != LOWER};
+      if ((up or down) and fabs(reduced) > best)
+      {
+        entering = j;
+        best = fabs(reduced);
+        sign = up ? 1 : -1;
+        if (bland)
+          break;
+      }
+    }
+    if (entering < 0)
+      return phaseOne ? INFEASIBLE : OPTIMAL;
+
+    column(entering, direction);
+    ftran(direction, &spike);
+
+    // Harris ratio test: the largest step allowed with relaxed bounds, then the largest pivot within that step
+    double step{sign > 0 ? upper[entering] - value[entering] : value[entering] - lower[entering]};
+    for (int r{0}; r < rows; r++)
+    {
+      double alpha{sign * direction[r]};
+      if (fabs(alpha) < pivotTolerance)
+        continue;
+      int j{basis[r]};
+      double limit{HUGE_VAL};
+      if (alpha > 0)
+      {
+        if (value[j] > upper[j] + feasibilityTolerance)
+          limit = (value[j] - upper[j]) / alpha;
+        else if (value[j] >= lower[j] - feasibilityTolerance)
+          limit = (value[j] - lower[j] + feasibilityTolerance) / alpha;
+      }
+      else
+      {
+        if (value[j] < lower[j] - feasibilityTolerance)
+          limit = (value[j] - lower[j]) / alpha;
+        else if (value[j] <= upper[j] + feasibilityTolerance)
+          limit = (value[j] - upper[j] - feasibilityTolerance) / alpha;
+      }
+      step = min(step, limit);
+    }
+    if (step == HUGE_VAL)
+      return UNBOUNDED;
+
+    int leaving{-1};
+    double leavingBound{0};
+    double leavingStep{0};
+    for (int r{0}; r < rows; r++)
+    {
+      double alpha{sign * direction[r]};
+      if (fabs(alpha) < pivotTolerance)
+        continue;
+      int j{basis[r]};
+      double bound;
+      if (alpha > 0 and value[j] > upper[j] + feasibilityTolerance)
+        bound = upper[j];
+      else if (alpha > 0 and value[j] >= lower[j] - feasibilityTolerance)
+        bound = lower[j];
+      else if (alpha < 0 and value[j] < lower[j] - feasibilityTolerance)
+        bound = lower[j];
+      else if (alpha < 0 and value[j] <= upper[j] + feasibilityTolerance)
+        bound = upper[j];
+      else
+        continue;
+      double limit{max(0.0, (value[j] - bound) / alpha)};
+      if (limit > step)
+        continue;
+      if (leaving < 0 or (bland ? j < basis[leaving] : fabs(alpha) > fabs(sign * direction[leaving])))
+      {
+        leaving = r;
+        leavingBound = bound;
+        leavingStep = limit;
+      }
+    }
+
+    double theta{leaving < 0 ? step : leavingStep};
+    degenerate = theta < 1e-12 ? degenerate + 1 : 0;
+    iterations++;
+
+    for (int r{0}; r < rows; r++)
+    {
+      if (direction[r] != 0)
+        value[basis[r]] -= theta * sign * direction[r];
+    }
+    value[entering] += sign * theta;
+
+    if (leaving < 0)
+    {
+      state[entering] = sign > 0 ? UPPER : LOWER;
+      value[entering] = sign > 0 ? upper[entering] : lower[entering];
+      continue;
+    }
+
+    int j{basis[leaving]};
+    value[j] = leavingBound;
+    state[j] = leavingBound == lower[j] ? LOWER : UPPER;
+    basis[leaving] = entering;
+    state[entering] = BASIC;
+    if (!update(leaving))
+    {
+      refactor();
+      computeBasicValues();
+    }
+  }
+}
+
+int Simplex::getColumns() const
+{
+  return columns;
+}
+
+double Simplex::getLower(const int &j) const
+{
+  return lower[j];
+}
+
+double Simplex::getUpper(const int &j) const
+{
+  return upper[j];
+}
+
+void Simplex::setBounds(const int &j, const double &l, const double &u)
+{
+  lower[j] = l;
+  upper[j] = u;
+  if (state[j] != BASIC)
+    setNonbasic(j);
+}
+
+// l <= S_i x <= u, kept as the bounds -u <= a_i <= -l of the row's artificial
+void Simplex::setRowBounds(const int &i, const double &l, const double &u)
+{
+  setBounds(columns + i, -u, -l);
+}
+
+void Simplex::setObjective(const vector<double> &e)
+{
+  for (int j{0}; j < columns; j++)
+  {
+    cost[j] = j < int(e.size()) ? e[j] : 0;
+  }
+}
+
+// Back to the artificial basis with every structural variable nonbasic
+void Simplex::reset()
+{
+  basis.resize(rows);
+  for (int r{0}; r < rows; r++)
+  {
+    basis[r] = columns + r;
+    state[columns + r] = BASIC;
+  }
+  for (int j{0}; j < columns; j++)
+  {
+    setNonbasic(j);
+  }
+  factored = false;
+  cold = true;
+}
+
+Simplex::Status Simplex::solve()
+{
+  if (cold)
+  {
+    crash();
+    cold = false;
+    factored = false;
+  }
+
+  for (int attempt{0}; attempt < 3; attempt++)
+  {
+    if (!factored or attempt > 0)
+      refactor();
+    computeBasicValues();
+
+    if ((status = run(true)) != OPTIMAL)
+      break;
+    if ((status = run(false)) != OPTIMAL)
+      break;
+
+    // Accumulated rounding can leave the basis slightly infeasible once the values are recomputed
+    computeBasicValues();
+    if (isFeasible())
+      break;
+  }
+
+  objectiveValue = 0;
+  for (int j{0}; j < columns; j++)
+  {
+    objectiveValue += cost[j] * value[j];
+  }
+  return status;
+}
+
+Simplex::Status Simplex::getStatus() const
+{
+  return status;
+}
+
+double Simplex::getObjectiveValue() const
+{
+  return objectiveValue;
+}
+
+double Simplex::getValue(const int &j) const
+{
+  return value[j];
+}
+
+vector<double> Simplex::getValues() const
+{
+  return vector<double>(value.begin(), value.begin() + columns);
+}
+
+long Simplex::getIterations() const
+{
+  return iterations;
+}
+
+string Simplex::toString(const Status &e)
+{
+  static const char *names[4] = {"optimo", "infactible", "no acotado", "limite de iteraciones"};
+  return names[e];
+}
+
+//* -------- ------- ------ ----- Balance de Flujos ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Flux balance analysis: maximizes the model objective over S v = 0 with the reaction limits as bounds
+class FluxBalance
+{
+private:
+  const Model &model;
+  StoichiometricMatrix matrix;
+  Simplex simplex;
+  vector<double> objective;
+  double seconds;
+
+  FluxBalance(const FluxBalance &) = delete;
+  FluxBalance &operator=(const FluxBalance &) = delete;
+
+public:
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  explicit FluxBalance(const Model &);
+
+  static vector<double> parseObjective(const Model &, const StoichiometricMatrix &);
+
+  Simplex::Status solve();
+
+  const StoichiometricMatrix &getMatrix() const;
+  Simplex &getSimplex();
+  const vector<double> &getObjective() const;
+  double getObjectiveValue() const;
+  vector<double> getFlux() const;
+  double getSeconds() const;
+  double getResidual() const;
+
+  string toString() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+FluxBalance::FluxBalance(const Model &e) : model(e), matrix(e.getStoichiometricMatrix()), simplex(matrix), seconds(0)
+{
+  objective = parseObjective(model, matrix);
+  simplex.setObjective(objective);
+  for (int j{0}; j < matrix.getColumns(); j++)
+  {
+    Reaction &r{*matrix.getReaction(j)->getDataPtr()};
+    simplex.setBounds(j, r.getLowerLimit(), r.getHigherLimit());
+  }
+}
+
+// "coef reaction + coef reaction ..." as written by the SBML reader, a bare reaction name counts with coefficient 1
+vector<double> FluxBalance::parseObjective(const Model &model, const StoichiometricMatrix &matrix)
+{
+  unordered_map<Node<Reaction> *, int> columnOf;
+  vector<double> result(matrix.getColumns(), 0);
+  istringstream terms(model.getObjetiveExpression());
+  string term;
+  bool found{false};
+
+  for (int j{0}; j < matrix.getColumns(); j++)
+  {
+    columnOf.emplace(matrix.getReaction(j), j);
+  }
+
+  while (getline(terms, term, '+'))
+  {
+    istringstream words(term);
+    string first, second;
+    words >> first >> second;
+    if (first.empty())
+      continue;
+
+    char *end{nullptr};
+    double coefficient{strtod(first.c_str(), &end)};
+    if (second.empty() or *end != '\0')
+    {
+      second = first;
+      coefficient = 1;
+    }
+
+    Node<Reaction> *reaction{model.findReaction(second)};
+    if (reaction == nullptr)
+    {
+      throw Exception("Reaccion del objetivo no encontrada: " + second);
+    }
+    result[columnOf[reaction]] += coefficient;
+    found = true;
+  }
+
+  if (!found)
+  {
+    throw Exception("El modelo no tiene objetivo");
+  }
+  return result;
+}
+
+Simplex::Status FluxBalance::solve()
+{
+  auto start{chrono::steady_clock::now()};
+  Simplex::Status status{simplex.solve()};
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  return status;
+}
+
+const StoichiometricMatrix &FluxBalance::getMatrix() const
+{
+  return matrix;
+}
+
+Simplex &FluxBalance::getSimplex()
+{
+  return simplex;
+}
+
+const vector<double> &FluxBalance::getObjective() const
+{
+  return objective;
+}
+
+double FluxBalance::getObjectiveValue() const
+{
+  return simplex.getObjectiveValue();
+}
+
+vector<double> FluxBalance::getFlux() const
+{
+  return simplex.getValues();
+}
+
+double FluxBalance::getSeconds() const
+{
+  return seconds;
+}
+
+// Largest violation of S v = 0 or of a reaction bound, used to validate a solution
+double FluxBalance::getResidual() const
+{
+  vector<double> flux{getFlux()}, balance;
+  double result{0};
+
+  matrix.multiply(flux, balance);
+  for (double e : balance)
+  {
+    result = max(result, fabs(e));
+  }
+  for (int j{0}; j < matrix.getColumns(); j++)
+  {
+    result = max(result, max(simplex.getLower(j) - flux[j], flux[j] - simplex.getUpper(j)));
+  }
+  return result;
+}
+
+string FluxBalance::toString() const
+{
+  string result{""};
+  Simplex::Status status{simplex.getStatus()};
+
+  result += "\nEstado: " + Simplex::toString(status);
+  if (status == Simplex::OPTIMAL)
+    result += "\nObjetivo: " + SbmlWriter::formatNumber(getObjectiveValue());
+  result += "\nIteraciones: " + to_string(simplex.getIterations());
+  result += "\nTiempo: " + to_string(seconds) + " s";
+  if (status == Simplex::OPTIMAL)
+    result += "\nResiduo: " + SbmlWriter::formatNumber(getResidual());
+
+  return result;
+}
+
+//* -------- ------- ------ ----- Variabilidad de Flujos ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Flux variability analysis: the minimum and maximum flux of every reaction while the objective stays within a
+// fraction of its optimum. The objective is appended to S as one more row bounded below by that fraction.
+// The 2n solves are split in fixed blocks of reactions that run on a ThreadPool. Each block starts from a copy of
+// the optimal FBA basis and warm starts every solve from the previous one. Blocks do not depend on which worker
+// runs them or in which order, so the results are the same for any number of threads
+class FluxVariability
+{
+private:
+  static const int blockSize{32};
+
+  const Model &model;
+  StoichiometricMatrix matrix;
+  Simplex simplex;
+  vector<double> objective;
+  double fraction;
+  double optimum;
+  vector<double> minimum;
+  vector<double> maximum;
+  long iterations;
+  int threads;
+  double seconds;
+
+  FluxVariability(const FluxVariability &) = delete;
+  FluxVariability &operator=(const FluxVariability &) = delete;
+
+  static StoichiometricMatrix build(const Model &);
+  static double toFlux(const Simplex &, const int &, const double &);
+
+public:
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  explicit FluxVariability(const Model &, const double & = 1);
+
+  void solve(ThreadPool &);
+
+  int getColumns() const;
+  Node<Reaction> *getReaction(const int &) const;
+  double getOptimum() const;
+  double getMinimum(const int &) const;
+  double getMaximum(const int &) const;
+  long getIterations() const;
+  double getSeconds() const;
+
+  string toString() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+FluxVariability::FluxVariability(const Model &e, const double &f) : model(e), matrix(build(e)), simplex(matrix), fraction(f), optimum(0), iterations(0), threads(0), seconds(0)
+{
+  if (fraction < 0 or fraction > 1)
+  {
+    throw Exception("Fraccion del optimo fuera de [0, 1]: " + SbmlWriter::formatNumber(fraction));
+  }
+  objective = FluxBalance::parseObjective(model, matrix);
+  for (int j{0}; j < getColumns(); j++)
+  {
+    Reaction &r{*matrix.getReaction(j)->getDataPtr()};
+    simplex.setBounds(j, r.getLowerLimit(), r.getHigherLimit());
+  }
+}
+
+// S with the objective as its last row
+StoichiometricMatrix FluxVariability::build(const Model &model)
+{
+  StoichiometricMatrix result{model.getStoichiometricMatrix()};
+  result.addRow(FluxBalance::parseObjective(model, result));
+  return result;
+}
+
+// Flux of column j after maximizing (direction 1) or minimizing (direction -1) it, infinite when unbounded and NaN
+// when the solve failed
+double FluxVariability::toFlux(const Simplex &lp, const int &j, const double &direction)
+{
+  if (lp.getStatus() == Simplex::OPTIMAL)
+    return lp.getValue(j);
+  if (lp.getStatus() == Simplex::UNBOUNDED)
+    return direction * HUGE_VAL;
+  return NAN;
+}
+
+void FluxVariability::solve(ThreadPool &pool)
+{
+  auto start{chrono::steady_clock::now()};
+  int objectiveRow{matrix.getRows() - 1};
+
+  simplex.setRowBounds(objectiveRow, -HUGE_VAL, HUGE_VAL);
+  simplex.setObjective(objective);
+  if (simplex.solve() != Simplex::OPTIMAL)
+  {
+    throw Exception("El FBA del modelo no tiene optimo: " + Simplex::toString(simplex.getStatus()));
+  }
+  optimum = simplex.getObjectiveValue();
+  simplex.setRowBounds(objectiveRow, optimum - (1 - fraction) * fabs(optimum), HUGE_VAL);
+
+  int columns{getColumns()};
+  int blocks{(columns + blockSize - 1) / blockSize};
+  vector<Simplex> lps(pool.getThreads(), simplex);
+  vector<long> blockIterations(blocks, 0);
+
+  minimum.assign(columns, NAN);
+  maximum.assign(columns, NAN);
+  pool.run(blocks, [&](const int &block, const int &worker) {
+    Simplex &lp{lps[worker]};
+    vector<double> cost(columns, 0);
+
+    lp = simplex;
+    long first{lp.getIterations()};
+    for (int j{block * blockSize}; j < min(columns, (block + 1) * blockSize); j++)
+    {
+      cost[j] = 1;
+      lp.setObjective(cost);
+      lp.solve();
+      maximum[j] = toFlux(lp, j, 1);
+
+      cost[j] = -1;
+      lp.setObjective(cost);
+      lp.solve();
+      minimum[j] = toFlux(lp, j, -1);
+      cost[j] = 0;
+    }
+    blockIterations[block] = lp.getIterations() - first;
+  });
+
+  iterations = 0;
+  for (long e : blockIterations)
+  {
+    iterations += e;
+  }
+  threads = pool.getThreads();
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int FluxVariability::getColumns() const
+{
+  return matrix.getColumns();
+}
+
+Node<Reaction> *FluxVariability::getReaction(const int &j) const
+{
+  return matrix.getReaction(j);
+}
+
+double FluxVariability::getOptimum() const
+{
+  return optimum;
+}
+
+double FluxVariability::getMinimum(const int &j) const
+{
+  return minimum[j];
+}
+
+double FluxVariability::getMaximum(const int &j) const
+{
+  return maximum[j];
+}
+
+long FluxVariability::getIterations() const
+{
+  return iterations;
+}
+
+double FluxVariability::getSeconds() const
+{
+  return seconds;
+}
+
+string FluxVariability::toString() const
+{
+  string result{""};
+  int failed{0};
+
+  for (size_t j{0}; j < minimum.size(); j++)
+  {
+    if (std::isnan(minimum[j]) or std::isnan(maximum[j]))
+      failed++;
+  }
+
+  result += "\nOptimo: " + SbmlWriter::formatNumber(optimum);
+  result += "\nFraccion: " + SbmlWriter::formatNumber(fraction);
+  result += "\nReacciones: " + to_string(minimum.size());
+  result += "\nFallidas: " + to_string(failed);
+  result += "\nIteraciones: " + to_string(iterations);
+  result += "\nHilos: " + to_string(threads);
+  result += "\nTiempo: " + to_string(seconds) + " s";
+
+  return result;
+}
+
+//* -------- ------- ------ ----- Deleciones de Genes ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Single and double gene knockouts. A deletion turns off every reaction whose gene rule is false without the deleted
+// genes, setting its bounds to zero, and re-solves the objective.
+// All workers share the model's matrix. Each one keeps its own Simplex as a bound overlay: a deletion sets the bounds
+// of its reactions, solves, and then restores them. Like FVA, deletions run in fixed blocks that start from the
+// wild type basis, so the results do not depend on the number of threads. A deletion whose reactions carry no flux
+// in the wild type keeps its optimum and is not solved
+class Knockout
+{
+public:
+  struct Deletion
+  {
+    int first;     //gene index
+    int second;    //-1 in a single deletion
+    int reactions; //reactions turned off
+    Simplex::Status status;
+    double objective;
+  };
+
+private:
+  static const int blockSize{32};
+
+  const Model &model;
+  StoichiometricMatrix matrix;
+  Simplex simplex;
+  vector<double> objective;
+  vector<string> genes;
+  vector<vector<int>> geneReactions; //columns whose rule names each gene
+  vector<GeneRule> rules;
+  vector<double> wildFlux;
+  double wildType;
+
+  vector<Deletion> deletions;
+  long solves;
+  int threads;
+  double seconds;
+
+  Knockout(const Knockout &) = delete;
+  Knockout &operator=(const Knockout &) = delete;
+
+  void run(ThreadPool &);
+
+public:
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  explicit Knockout(const Model &);
+
+  vector<int> getAffected(const int &, const int & = -1) const;
+
+  void single(ThreadPool &);
+  void pairs(ThreadPool &);
+
+  int getGeneCount() const;
+  const string &getGene(const int &) const;
+  double getWildType() const;
+  const vector<Deletion> &getDeletions() const;
+  bool isLethal(const Deletion &) const;
+  long getSolves() const;
+  double getSeconds() const;
+
+  string toString() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Knockout::Knockout(const Model &e) : model(e), matrix(e.getStoichiometricMatrix()), simplex(matrix), wildType(0), solves(0), threads(0), seconds(0)
+{
+  unordered_map<string, int> geneIndex;
+  auto indexOf = [&](const string &name) {
+    auto found{geneIndex.emplace(name, int(genes.size()))};
+    if (found.second)
+    {
+      genes.push_back(name);
+      geneReactions.push_back(vector<int>());
+    }
+    return found.first->second;
+  };
+
+  for (Node<Gen> *aux{model.getGenList().getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    indexOf(aux->getDataPtr()->getName());
+  }
+
+  objective = FluxBalance::parseObjective(model, matrix);
+  simplex.setObjective(objective);
+  for (int j{0}; j < matrix.getColumns(); j++)
+  {
+    Reaction &r{*matrix.getReaction(j)->getDataPtr()};
+    simplex.setBounds(j, r.getLowerLimit(), r.getHigherLimit());
+
+    try
+    {
+      rules.push_back(GeneRule(r.getGenReaction()));
+    }
+    catch (GeneRule::Exception &ex)
+    {
+      throw Exception("Reaccion " + r.getName() + ": " + ex.what());
+    }
+    vector<string> names{rules.back().getGenes()};
+    std::sort(names.begin(), names.end());
+    names.erase(unique(names.begin(), names.end()), names.end());
+    for (const string &name : names)
+    {
+      geneReactions[indexOf(name)].push_back(j);
+    }
+  }
+
+  if (simplex.solve() != Simplex::OPTIMAL)
+  {
+    throw Exception("El FBA del modelo no tiene optimo: " + Simplex::toString(simplex.getStatus()));
+  }
+  wildType = simplex.getObjectiveValue();
+  wildFlux = simplex.getValues();
+}
+
+// Columns whose rule turns false once the given genes are deleted
+vector<int> Knockout::getAffected(const int &first, const int &second) const
+{
+  vector<int> result, candidates{geneReactions[first]};
+  auto active = [&](const string &name) { return name != genes[first] and (second < 0 or name != genes[second]); };
+
+  if (second >= 0)
+  {
+    candidates.insert(candidates.end(), geneReactions[second].begin(), geneReactions[second].end());
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+  }
+  for (int j : candidates)
+  {
+    if (!rules[j].evaluate(active))
+      result.push_back(j);
+  }
+  return result;
+}
+
+void Knockout::run(ThreadPool &pool)
+{
+  auto start{chrono::steady_clock::now()};
+  int blocks{int((deletions.size() + blockSize - 1) / blockSize)};
+  vector<Simplex> lps(pool.getThreads(), simplex);
+  vector<long> blockSolves(blocks, 0);
+
+  pool.run(blocks, [&](const int &block, const int &worker) {
+    Simplex &lp{lps[worker]};
+
+    lp = simplex;
+    for (size_t k{size_t(block) * blockSize}; k < min(deletions.size(), size_t(block + 1) * blockSize); k++)
+    {
+      Deletion &deletion{deletions[k]};
+      vector<int> affected{getAffected(deletion.first, deletion.second)};
+      bool carriesFlux{false};
+
+      for (int j : affected)
+      {
+        carriesFlux = carriesFlux or fabs(wildFlux[j]) > 1e-9;
+      }
+      deletion.reactions = int(affected.size());
+      deletion.status = Simplex::OPTIMAL;
+      deletion.objective = wildType;
+      if (!carriesFlux)
+        continue;
+
+      for (int j : affected)
+      {
+        lp.setBounds(j, 0, 0);
+      }
+      deletion.status = lp.solve();
+      deletion.objective = deletion.status == Simplex::OPTIMAL ? lp.getObjectiveValue() : NAN;
+      for (int j : affected)
+      {
+        Reaction &r{*matrix.getReaction(j)->getDataPtr()};
+        lp.setBounds(j, r.getLowerLimit(), r.getHigherLimit());
+      }
+      blockSolves[block]++;
+    }
+  });
+
+  solves = 0;
+  for (long e : blockSolves)
+  {
+    solves += e;
+  }
+  threads = pool.getThreads();
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void Knockout::single(ThreadPool &pool)
+{
+  deletions.clear();
+  for (int g{0}; g < getGeneCount(); g++)
+  {
+    deletions.push_back({g, -1, 0, Simplex::OPTIMAL, 0});
+  }
+  run(pool);
+}
+
+// Every unordered pair of genes that controls at least one reaction
+void Knockout::pairs(ThreadPool &pool)
+{
+  vector<int> used;
+
+  for (int g{0}; g < getGeneCount(); g++)
+  {
+    if (!geneReactions[g].empty())
+      used.push_back(g);
+  }
+  deletions.clear();
+  for (size_t a{0}; a < used.size(); a++)
+  {
+    for (size_t b{a + 1}; b < used.size(); b++)
+    {
+      deletions.push_back({used[a], used[b], 0, Simplex::OPTIMAL, 0});
+    }
+  }
+  run(pool);
+}
+
+int Knockout::getGeneCount() const
+{
+  return int(genes.size());
+}
+
+const string &Knockout::getGene(const int &g) const
+{
+  return genes[g];
+}
+
+double Knockout::getWildType() const
+{
+  return wildType;
+}
+
+const vector<Knockout::Deletion> &Knockout::getDeletions() const
+{
+  return deletions;
+}
+
+// No solution or an objective below one millionth of the wild type
+bool Knockout::isLethal(const Deletion &e) const
+{
+  return e.status != Simplex::OPTIMAL or e.objective < 1e-6 * fabs(wildType);
+}
+
+long Knockout::getSolves() const
+{
+  return solves;
+}
+
+double Knockout::getSeconds() const
+{
+  return seconds;
+}
+
+string Knockout::toString() const
+{
+  string result{""};
+  long lethal{0};
+
+  for (const Deletion &e : deletions)
+  {
+    if (isLethal(e))
+      lethal++;
+  }
+
+  result += "\nTipo silvestre: " + SbmlWriter::formatNumber(wildType);
+  result += "\nGenes: " + to_string(genes.size());
+  result += "\nDeleciones: " + to_string(deletions.size());
+  result += "\nLetales: " + to_string(lethal);
+  result += "\nResueltas: " + to_string(solves);
+  result += "\nHilos: " + to_string(threads);
+  result += "\nTiempo: " + to_string(seconds) + " s";
+  result += "\nDeleciones/s: " + to_string(seconds > 0 ? deletions.size() / seconds : 0);
+
+  return result;
+}
+
+//* -------- ------- ------ ----- Bench ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+// Built with -DBENCH_COUNT_ALLOCATIONS every heap allocation of the process goes through here so benchmarks can
+// count them; it costs an atomic add on every allocation, so normal builds leave the global operators alone
+#ifdef BENCH_COUNT_ALLOCATIONS
+static atomic<size_t> heapAllocations{0};
+
+void *operator new(size_t size)
+{
+  heapAllocations.fetch_add(1, memory_order_relaxed);
+  if (void *p = malloc(size == 0 ? 1 : size))
+    return p;
+  throw bad_alloc();
+}
+
+// Kept out of line so the compiler does not pair an inlined free with new
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void heapRelease(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p) noexcept
+{
+  heapRelease(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  heapRelease(p);
+}
+#endif
+
+class Bench
+{
+private:
+  static double seconds(const chrono::steady_clock::time_point &);
+  static string dump(List<Model> &);
+  static void fill(Model &, const int &);
+  static long residentBytes();
+
+  static string snapshot(const int &);
+  static string list(const int &);
+  static string sort(const int &);
+  template <class Allocator>
+  static string layout(const string &, const int &);
+  static string move(const int &);
+  static string matrix(const int &);
+  static string fba(const int &);
+  static string fva(const int &, const int &);
+  static string knockout(const int &, const int &);
+  static string clone(const int &, const int &);
+  static string memory(const int &);
+  static string table(const int &);
+  static string bounds(const int &);
+  static string query(const int &);
+  static string derived(const int &);
+  static string concurrent(const int &, const int &);
+  static string append(const int &, const int &);
+  static string load(const int &, const int &, const int &);
+  static string server(const int &, const int &, const int &);
+  static string journal(const int &, const int &);
+  static string recovery(const int &, const int &);
+
+public:
+  static string run(const string &, const vector<int> &);
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+double Bench::seconds(const chrono::steady_clock::time_point &start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+string Bench::dump(List<Model> &modelList)
+{
+  string result{""};
+
+  for (Node<Model> *aux{modelList.getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    const Model &m{*aux->getDataPtr()};
+    result += m.toString() + m.getReactionList().toString() + m.getMetaboliteList().toString() + m.getGenList().toString();
+  }
+  return result;
+}
+
+void Bench::fill(Model &model, const int &reactions)
+{
+  int metabolites{reactions / 2 + 1};
+  int genes{reactions / 4 + 1};
+  Node<Reaction> *lastReaction{model.getReactionList().getLast()};
+  Node<Metabolite> *lastMetabolite{model.getMetaboliteList().getLast()};
+  Node<Gen> *lastGen{model.getGenList().getLast()};
+  Reaction reaction;
+  Metabolite metabolite;
+  Gen gen;
+
+  model.setCompartments("c,e");
+  model.setObjetiveExpression("1 R_" + to_string(reactions - 1));
+
+  for (int i{0}; i < metabolites; i++)
+  {
+    metabolite.setId(i + 1);
+    metabolite.setName("M_" + to_string(i) + "_c");
+    metabolite.setChemicalForm("C6H12O6");
+    metabolite.setCompartment("c");
+    lastMetabolite = model.getMetaboliteList().insertUnchecked(metabolite, lastMetabolite);
+  }
+
+  for (int i{0}; i < genes; i++)
+  {
+    gen.setId(i + 1);
+    gen.setName("G_" + to_string(i));
+    gen.setFunctional("synthetic");
+    gen.setGenReaction("");
+    lastGen = model.getGenList().insertUnchecked(gen, lastGen);
+  }
+
+  for (int i{0}; i < reactions; i++)
+  {
+    reaction.setId(i + 1);
+    reaction.setName("R_" + to_string(i));
+    reaction.setStoichiometry(i % 3 == 0 ? Reaction::REVERSIBLE : Reaction::FORWARD);
+    reaction.setLowerLimit(i % 3 == 0 ? -1000 : 0);
+    reaction.setHigherLimit(1000);
+    reaction.setGenReaction("G_" + to_string(i % genes) + (i % 5 == 0 ? " or G_" + to_string((i + 1) % genes) : ""));
+    reaction.setParticipants({{i % metabolites + 1, -1}, {(i + 1) % metabolites + 1, 1}});
+    lastReaction = model.getReactionList().insertUnchecked(reaction, lastReaction);
+  }
+}
+
+// Resident set size of the process, 0 where /proc is not available
+long Bench::residentBytes()
+{
+#ifndef _WIN32
+  long pages{0}, resident{0};
+  ifstream statm("/proc/self/statm");
+  if (statm >> pages >> resident)
+    return resident * sysconf(_SC_PAGESIZE);
+#endif
+  return 0;
+}
+
+string Bench::snapshot(const int &reactions)
+{
+  string textFile{"bench_snapshot.txt"};
+  string binaryFile{"bench_snapshot.bin"};
+  string result{""};
+
+  {
+    List<Model> modelList;
+    Model modelAux;
+    modelAux.setName("bench");
+    modelList.insert(modelAux, nullptr);
+    fill(*modelList.getFirst()->getDataPtr(), reactions);
+
+    ofstream text(textFile, ios::binary);
+    Loader::save(modelList, text);
+    text.close();
+
+    auto start{chrono::steady_clock::now()};
+    Snapshot::save(modelList, binaryFile);
+    result += "\nGuardar snapshot: " + to_string(seconds(start)) + " s";
+
+    List<Model> textList;
+    start = chrono::steady_clock::now();
+    Loader(textList).load(textFile);
+    result += "\nCarga texto: " + to_string(seconds(start)) + " s";
+
+    Snapshot snapshot;
+    start = chrono::steady_clock::now();
+    snapshot.open(binaryFile);
+    result += "\nApertura snapshot (mmap): " + to_string(seconds(start)) + " s";
+
+    List<Model> binaryList;
+    start = chrono::steady_clock::now();
+    snapshot.load(binaryList);
+    result += "\nCarga snapshot a List<Model>: " + to_string(seconds(start)) + " s";
+
+    string expected{dump(modelList)};
+    result += "\nIda y vuelta texto: ";
+    result += dump(textList) == expected ? "OK" : "FALLO";
+    result += "\nIda y vuelta snapshot: ";
+    result += dump(binaryList) == expected ? "OK" : "FALLO";
+  }
+
+  std::remove(textFile.c_str());
+  std::remove(binaryFile.c_str());
+  return result;
+}
+
+string Bench::list(const int &maximum)
+{
+  string result{"\nElementos | insert (ns/op) | remove (ns/op)"};
+  Reaction reaction;
+
+  for (int size{1000}; size <= maximum; size *= 10)
+  {
+    List<Reaction> reactionList;
+    Node<Reaction> *last{nullptr};
+
+    auto start{chrono::steady_clock::now()};
+    for (int i{0}; i < size; i++)
+    {
+      reaction.setId(i);
+      reactionList.insert(reaction, last);
+      last = last == nullptr ? reactionList.getFirst() : last->getNext();
+    }
+    double insertTime{seconds(start)};
+
+    start = chrono::steady_clock::now();
+    while (last != nullptr)
+    {
+      Node<Reaction> *prev{last->getPrev()};
+      reactionList.remove(last);
+      last = prev;
+    }
+    double removeTime{seconds(start)};
+
+    result += "\n" + to_string(size) + " | " + to_string(insertTime * 1e9 / size) + " | " + to_string(removeTime * 1e9 / size);
+  }
+  return result;
+}
+
+string Bench::sort(const int &size)
+{
+  List<Reaction> reactionList;
+  Reaction reaction;
+  unsigned int seed{12345};
+
+  for (int i{0}; i < size; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    reaction.setId(i);
+    reaction.setName("R_" + to_string(seed % 100000));
+    reactionList.insertUnchecked(reaction, reactionList.back());
+  }
+
+  auto start{chrono::steady_clock::now()};
+  reactionList.sort();
+  double elapsed{seconds(start)};
+
+  bool sorted{true};
+  for (Node<Reaction> *aux{reactionList.getFirst()}; aux->getNext() != nullptr; aux = aux->getNext())
+  {
+    Reaction &a{aux->getData()}, &b{aux->getNext()->getData()};
+    if (a > b or (a == b and a.getId() > b.getId()) or aux->getNext()->getPrev() != aux)
+      sorted = false;
+  }
+
+  return "\nOrdenar " + to_string(size) + " nodos: " + to_string(elapsed) + " s\nOrden estable: " + (sorted ? "OK" : "FALLO");
+}
+
+template <class Allocator>
+string Bench::layout(const string &name, const int &size)
+{
+  List<Reaction, Allocator> reactionList;
+  Reaction reaction;
+  long total{0};
+
+  reaction.setName("R");
+  auto start{chrono::steady_clock::now()};
+  for (int i{0}; i < size; i++)
+  {
+    reaction.setId(i);
+    reaction.setLowerLimit(-i);
+    reaction.setHigherLimit(i);
+    reactionList.insertUnchecked(reaction, reactionList.back());
+  }
+  double build{seconds(start)};
+
+  start = chrono::steady_clock::now();
+  for (int pass{0}; pass < 10; pass++)
+  {
+    for (Node<Reaction> *aux{reactionList.getFirst()}; aux != nullptr; aux = aux->getNext())
+    {
+      total += aux->getDataPtr()->getHigherLimit() - aux->getDataPtr()->getLowerLimit();
+    }
+  }
+  double traverse{seconds(start) / 10};
+
+  return "\n" + name + " | " + to_string(reactionList.getAllocator().getAllocations()) + " | " + to_string(build) + " | " + to_string(traverse) + (total < 0 ? "!" : "");
+}
+
+string Bench::move(const int &size)
+{
+  string result{"\nInsercion | asignaciones/reaccion | tiempo (s)"};
+  string names[3] = {"copia", "movimiento", "emplace"};
+
+#ifndef BENCH_COUNT_ALLOCATIONS
+  result = "\nAsignaciones sin contar, compilar con -DBENCH_COUNT_ALLOCATIONS" + result;
+#endif
+
+  for (int mode{0}; mode < 3; mode++)
+  {
+    List<Reaction> reactionList;
+#ifdef BENCH_COUNT_ALLOCATIONS
+    size_t before{heapAllocations.load()};
+#endif
+    auto start{chrono::steady_clock::now()};
+
+    for (int i{0}; i < size; i++)
+    {
+      string name{"REACTION_WITH_A_LONG_NAME_" + to_string(i)};
+      string genes{"GENE_WITH_A_LONG_NAME_" + to_string(i) + " or GENE_B"};
+      vector<Reaction::Participant> participants{{1, -1}, {2, 1}, {3, 1}};
+
+      if (mode == 0)
+      {
+        Reaction reaction(i, name, "->", 0, 1000, genes, participants);
+        reactionList.insertUnchecked(reaction, reactionList.back());
+      }
+      else if (mode == 1)
+      {
+        Reaction reaction(i, std::move(name), "->", 0, 1000, std::move(genes), std::move(participants));
+        reactionList.insertUnchecked(std::move(reaction), reactionList.back());
+      }
+      else
+      {
+        reactionList.emplace(reactionList.back(), i, std::move(name), "->", 0, 1000, std::move(genes), std::move(participants));
+      }
+    }
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+    string allocations{to_string(double(heapAllocations.load() - before) / size)};
+#else
+    string allocations{"-"};
+#endif
+    result += "\n" + names[mode] + " | " + allocations + " | " + to_string(seconds(start));
+  }
+  return result;
+}
+
+string Bench::matrix(const int &reactions)
+{
+  Model model;
+  fill(model, reactions);
+
+  // What the participants cost when stored as concatenated Metabolite::toString() text
+  size_t textBytes{0}, participantBytes{0};
+  Node<Metabolite> *first{model.getMetaboliteList().getFirst()};
+  for (Node<Reaction> *aux{model.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    const vector<Reaction::Participant> &participants{aux->getDataPtr()->getParticipants()};
+    textBytes += participants.size() * (first->getDataPtr()->toString().size() + 1);
+    participantBytes += participants.capacity() * sizeof(Reaction::Participant);
+  }
+
+  auto start{chrono::steady_clock::now()};
+  StoichiometricMatrix matrix{model.getStoichiometricMatrix()};
+  double build{seconds(start)};
+
+  vector<double> flux(matrix.getColumns(), 1), balance;
+  start = chrono::steady_clock::now();
+  matrix.multiply(flux, balance);
+  double multiply{seconds(start)};
+
+  return "\nMatriz: " + to_string(matrix.getRows()) + " x " + to_string(matrix.getColumns()) + ", " + to_string(matrix.getNonZeros()) + " no nulos" +
+         "\nBytes por reaccion: texto " + to_string(double(textBytes) / reactions) + ", pares " + to_string(double(participantBytes) / reactions) +
+         ", matriz " + to_string(double(matrix.getBytes()) / reactions) +
+         "\nConstruccion: " + to_string(build) + " s\nS * v: " + to_string(multiply) + " s";
+}
+
+string Bench::fba(const int &reactions)
+{
+  string result{"\nValidacion:"};
+
+  // Glucose uptake capped at 10 feeds two pyruvate routes, the cheap one capped at 3, and lactate can be taken up
+  // at 4 through a reversible LDH; the optimum takes both sources: 2 * 10 + 4 = 24
+  {
+    Model model;
+    model.setObjetiveExpression("1 BIO");
+    model.addMetabolite(Metabolite(1, "glc", "C6H12O6", "c"));
+    model.addMetabolite(Metabolite(2, "pyr", "C3H4O3", "c"));
+    model.addMetabolite(Metabolite(3, "lac", "C3H6O3", "c"));
+    model.addReaction(Reaction(1, "EX_glc", "->", 0, 10, "", {{1, 1}}));
+    model.addReaction(Reaction(2, "R1", "->", 0, 1000, "", {{1, -1}, {2, 2}}));
+    model.addReaction(Reaction(3, "R3", "->", 0, 3, "", {{1, -1}, {2, 1}}));
+    model.addReaction(Reaction(4, "LDH", "<->", -5, 5, "", {{2, -1}, {3, 1}}));
+    model.addReaction(Reaction(5, "EX_lac", "<->", -4, 1000, "", {{3, -1}}));
+    model.addReaction(Reaction(6, "BIO", "->", 0, 1000, "", {{2, -1}}));
+
+    FluxBalance optimal(model);
+    bool ok{optimal.solve() == Simplex::OPTIMAL and fabs(optimal.getObjectiveValue() - 24) < 1e-6 and optimal.getResidual() < 1e-6};
+    result += "\nOptimo conocido (24): " + string(ok ? "OK" : "ERROR") + " (" + SbmlWriter::formatNumber(optimal.getObjectiveValue()) + ")";
+
+    model.editReaction(model.findReaction("BIO"), 4, "30");
+    FluxBalance infeasible(model);
+    result += "\nInfactible con BIO >= 30: " + string(infeasible.solve() == Simplex::INFEASIBLE ? "OK" : "ERROR");
+  }
+
+  Model model;
+  fill(model, reactions);
+  model.setObjetiveExpression("1 R_0 + 0.5 R_1");
+
+  auto start{chrono::steady_clock::now()};
+  FluxBalance balance(model);
+  double setup{seconds(start)};
+  balance.solve();
+
+  result += "\n\nModelo sintetico: " + to_string(balance.getMatrix().getRows()) + " x " + to_string(balance.getMatrix().getColumns());
+  result += "\nPreparacion: " + to_string(setup) + " s" + balance.toString();
+  return result;
+}
+
+string Bench::fva(const int &reactions, const int &maximumThreads)
+{
+  string result{"\nValidacion:"};
+
+  // Same model as the FBA check: at the optimum every flux is fixed, with the objective free BIO spans [0, 24]
+  // and the cheap route R3 its whole [0, 3]
+  {
+    Model model;
+    model.setObjetiveExpression("1 BIO");
+    model.addMetabolite(Metabolite(1, "glc", "C6H12O6", "c"));
+    model.addMetabolite(Metabolite(2, "pyr", "C3H4O3", "c"));
+    model.addMetabolite(Metabolite(3, "lac", "C3H6O3", "c"));
+    model.addReaction(Reaction(1, "EX_glc", "->", 0, 10, "", {{1, 1}}));
+    model.addReaction(Reaction(2, "R1", "->", 0, 1000, "", {{1, -1}, {2, 2}}));
+    model.addReaction(Reaction(3, "R3", "->", 0, 3, "", {{1, -1}, {2, 1}}));
+    model.addReaction(Reaction(4, "LDH", "<->", -5, 5, "", {{2, -1}, {3, 1}}));
+    model.addReaction(Reaction(5, "EX_lac", "<->", -4, 1000, "", {{3, -1}}));
+    model.addReaction(Reaction(6, "BIO", "->", 0, 1000, "", {{2, -1}}));
+
+    double expected[6] = {10, 10, 0, -4, -4, 24};
+    ThreadPool pool(2);
+    FluxVariability optimal(model, 1);
+    optimal.solve(pool);
+    bool ok{true};
+    for (int j{0}; j < 6; j++)
+    {
+      ok = ok and fabs(optimal.getMinimum(j) - expected[j]) < 1e-6 and fabs(optimal.getMaximum(j) - expected[j]) < 1e-6;
+    }
+    result += "\nRangos en el optimo: " + string(ok ? "OK" : "ERROR");
+
+    FluxVariability free(model, 0);
+    free.solve(pool);
+    ok = fabs(free.getMinimum(5)) < 1e-6 and fabs(free.getMaximum(5) - 24) < 1e-6 and fabs(free.getMinimum(2)) < 1e-6 and fabs(free.getMaximum(2) - 3) < 1e-6;
+    result += "\nRangos sin objetivo: " + string(ok ? "OK" : "ERROR");
+  }
+
+  Model model;
+  fill(model, reactions);
+  model.setObjetiveExpression("1 R_0 + 0.5 R_1");
+
+  FluxVariability variability(model, 0.9);
+  vector<double> minimum, maximum;
+  double serial{0};
+  bool deterministic{true};
+
+  result += "\n\nModelo sintetico: " + to_string(reactions) + " reacciones, " + to_string(2 * reactions) + " problemas";
+  result += "\nHilos | tiempo (s) | aceleracion | problemas/s | iteraciones";
+  for (int threads{1}; threads <= maximumThreads; threads = threads * 2 > maximumThreads and threads < maximumThreads ? maximumThreads : threads * 2)
+  {
+    ThreadPool pool(threads);
+    variability.solve(pool);
+
+    if (threads == 1)
+    {
+      serial = variability.getSeconds();
+      for (int j{0}; j < variability.getColumns(); j++)
+      {
+        minimum.push_back(variability.getMinimum(j));
+        maximum.push_back(variability.getMaximum(j));
+      }
+    }
+    for (int j{0}; j < variability.getColumns(); j++)
+    {
+      if (variability.getMinimum(j) != minimum[j] or variability.getMaximum(j) != maximum[j])
+        deterministic = false;
+    }
+
+    result += "\n" + to_string(threads) + " | " + to_string(variability.getSeconds()) + " | " + to_string(serial / variability.getSeconds()) + " | " +
+              to_string(2 * reactions / variability.getSeconds()) + " | " + to_string(variability.getIterations());
+  }
+  result += "\nResultados iguales con cualquier numero de hilos: " + string(deterministic ? "OK" : "ERROR");
+  return result;
+}
+
+string Bench::knockout(const int &reactions, const int &maximumThreads)
+{
+  string result{"\nValidacion:"};
+
+  // The FBA model with rules: g1 runs the glucose uptake, R1 has two isozymes and LDH needs a complex of g4 and g5.
+  // Without g1 only lactate feeds BIO (4), without LDH only glucose (20), without R1 the cheap route caps it at 3 + 4
+  {
+    Model model;
+    model.setObjetiveExpression("1 BIO");
+    model.addMetabolite(Metabolite(1, "glc", "C6H12O6", "c"));
+    model.addMetabolite(Metabolite(2, "pyr", "C3H4O3", "c"));
+    model.addMetabolite(Metabolite(3, "lac", "C3H6O3", "c"));
+    model.addReaction(Reaction(1, "EX_glc", "->", 0, 10, "g1", {{1, 1}}));
+    model.addReaction(Reaction(2, "R1", "->", 0, 1000, "g2 or g3", {{1, -1}, {2, 2}}));
+    model.addReaction(Reaction(3, "R3", "->", 0, 3, "", {{1, -1}, {2, 1}}));
+    model.addReaction(Reaction(4, "LDH", "<->", -5, 5, "g4 and g5", {{2, -1}, {3, 1}}));
+    model.addReaction(Reaction(5, "EX_lac", "<->", -4, 1000, "", {{3, -1}}));
+    model.addReaction(Reaction(6, "BIO", "->", 0, 1000, "", {{2, -1}}));
+
+    ThreadPool pool(2);
+    Knockout knockout(model);
+    knockout.single(pool);
+    double expected[5] = {4, 24, 24, 20, 20};
+    bool ok{knockout.getDeletions().size() == 5};
+    for (size_t g{0}; ok and g < 5; g++)
+    {
+      ok = knockout.getDeletions()[g].status == Simplex::OPTIMAL and fabs(knockout.getDeletions()[g].objective - expected[g]) < 1e-6;
+    }
+    result += "\nDeleciones simples: " + string(ok ? "OK" : "ERROR");
+
+    knockout.pairs(pool);
+    ok = knockout.getDeletions().size() == 10;
+    for (const Knockout::Deletion &e : knockout.getDeletions())
+    {
+      if (knockout.getGene(e.first) == "g2" and knockout.getGene(e.second) == "g3")
+        ok = ok and fabs(e.objective - 7) < 1e-6 and e.reactions == 1;
+      if (knockout.getGene(e.first) == "g1" and knockout.getGene(e.second) == "g4")
+        ok = ok and knockout.isLethal(e);
+    }
+    result += "\nDeleciones dobles: " + string(ok ? "OK" : "ERROR");
+  }
+
+  Model model;
+  fill(model, reactions);
+  model.setObjetiveExpression("1 R_0 + 0.5 R_1");
+  Knockout knockout(model);
+  vector<double> serial[2];
+  bool deterministic{true};
+
+  result += "\n\nModelo sintetico: " + to_string(reactions) + " reacciones, " + to_string(knockout.getGeneCount()) + " genes";
+  result += "\nTipo | hilos | deleciones | resueltas | tiempo (s) | deleciones/s";
+  for (int type{0}; type < 2; type++)
+  {
+    for (int threads{1}; threads <= maximumThreads; threads = threads * 2 > maximumThreads and threads < maximumThreads ? maximumThreads : threads * 2)
+    {
+      ThreadPool pool(threads);
+      if (type == 0)
+        knockout.single(pool);
+      else
+        knockout.pairs(pool);
+
+      const vector<Knockout::Deletion> &deletions{knockout.getDeletions()};
+      for (size_t k{0}; k < deletions.size(); k++)
+      {
+        if (threads == 1)
+          serial[type].push_back(deletions[k].objective);
+        else if (!(deletions[k].objective == serial[type][k] or (std::isnan(deletions[k].objective) and std::isnan(serial[type][k]))))
+          deterministic = false;
+      }
+
+      result += "\n" + string(type == 0 ? "simple" : "doble") + " | " + to_string(threads) + " | " + to_string(deletions.size()) + " | " + to_string(knockout.getSolves()) + " | " +
+                to_string(knockout.getSeconds()) + " | " + to_string(deletions.size() / knockout.getSeconds());
+    }
+  }
+  result += "\nResultados iguales con cualquier numero de hilos: " + string(deterministic ? "OK" : "ERROR");
+  return result;
+}
+
+string Bench::clone(const int &reactions, const int &clones)
+{
+  string result{""};
+  Model model;
+  const Model &original{model}; //reads through a const model do not unshare its lists
+  fill(model, reactions);
+  string expected{original.getReactionList().toString()};
+
+  long before{residentBytes()};
+  auto start{chrono::steady_clock::now()};
+  List<Reaction> deep(model.getReactionList());
+  List<Metabolite> deepMetabolites(model.getMetaboliteList());
+  List<Gen> deepGens(model.getGenList());
+  double deepTime{seconds(start)};
+  long deepBytes{residentBytes() - before};
+
+  vector<Model> scenarios;
+  scenarios.reserve(clones);
+  before = residentBytes();
+  start = chrono::steady_clock::now();
+  for (int i{0}; i < clones; i++)
+  {
+    scenarios.push_back(model);
+    scenarios.back().setName("escenario_" + to_string(i));
+  }
+  double cloneTime{seconds(start)};
+  long cloneBytes{residentBytes() - before};
+
+  // Every scenario closes a different reaction: only its reaction list gets copied
+  before = residentBytes();
+  start = chrono::steady_clock::now();
+  for (int i{0}; i < clones; i++)
+  {
+    scenarios[i].editReaction(scenarios[i].findReaction("R_" + to_string(i % reactions)), 5, "0");
+  }
+  double editTime{seconds(start)};
+  long editBytes{residentBytes() - before};
+
+  bool ok{original.getReactionList().toString() == expected};
+  for (int i{0}; i < clones; i++)
+  {
+    const Model &scenario{scenarios[i]};
+    ok = ok and scenario.findReaction("R_" + to_string(i % reactions))->getDataPtr()->getHigherLimit() == 0 and scenario.getMetaboliteList().getFirst() == original.getMetaboliteList().getFirst();
+  }
+
+  result += "\nModelo: " + to_string(reactions) + " reacciones, " + to_string(clones) + " clones";
+  result += "\nOperacion | tiempo por modelo (s) | memoria residente por modelo (bytes)";
+  result += "\ncopia profunda | " + to_string(deepTime) + " | " + to_string(deepBytes);
+  result += "\nclon | " + to_string(cloneTime / clones) + " | " + to_string(cloneBytes / clones);
+  result += "\nclon + editar una reaccion | " + to_string(editTime / clones) + " | " + to_string(editBytes / clones);
+  result += "\nOriginal intacto y metabolitos compartidos: " + string(ok ? "OK" : "ERROR");
+  return result;
+}
+
+// Field storage of every entity with plain std::string members (the previous layout) against symbol handles
+string Bench::memory(const int &reactions)
+{
+  struct StringReaction
+  {
+    int id;
+    string name;
+    string stoichiometry;
+    int lowerLimit;
+    int higherLimit;
+    string genReaction;
+    vector<Reaction::Participant> participants;
+  };
+  struct StringEntity
+  {
+    int id;
+    string name;
+    string first;
+    string second;
+  };
+
+  // Heap buffer of a std::string, short texts are kept inside the object
+  auto heap{[](const string &e) -> size_t
+            { return e.size() > string().capacity() ? e.size() + 1 : 0; }};
+
+  string result{""};
+  size_t tableBefore{SymbolTable::global().getBytes()};
+  uint32_t symbolsBefore{SymbolTable::global().size()};
+  Model model;
+  fill(model, reactions);
+  size_t tableBytes{SymbolTable::global().getBytes() - tableBefore};
+
+  size_t reactionBytes[2]{0, 0}, metaboliteBytes[2]{0, 0}, genBytes[2]{0, 0};
+  long fields{0};
+
+  for (Node<Reaction> *aux{model.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    const Reaction &e{*aux->getDataPtr()};
+    reactionBytes[0] += sizeof(StringReaction) + heap(e.getName()) + heap(e.getEstequiometria()) + heap(e.getGenReaction());
+    reactionBytes[1] += sizeof(Reaction);
+    fields += 3;
+  }
+  for (Node<Metabolite> *aux{model.getMetaboliteList().getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    const Metabolite &e{*aux->getDataPtr()};
+    metaboliteBytes[0] += sizeof(StringEntity) + heap(e.getName()) + heap(e.getChemicalForm()) + heap(e.getCompartment());
+    metaboliteBytes[1] += sizeof(Metabolite);
+    fields += 3;
+  }
+  for (Node<Gen> *aux{model.getGenList().getFirst()}; aux != nullptr; aux = aux->getNext())
+  {
+    const Gen &e{*aux->getDataPtr()};
+    genBytes[0] += sizeof(StringEntity) + heap(e.getName()) + heap(e.getFunctional()) + heap(e.getGenReaction());
+    genBytes[1] += sizeof(Gen);
+    fields += 3;
+  }
+
+  size_t before{reactionBytes[0] + metaboliteBytes[0] + genBytes[0]};
+  size_t after{reactionBytes[1] + metaboliteBytes[1] + genBytes[1] + tableBytes};
+
+  result += "\nModelo: " + to_string(reactions) + " reacciones, " + to_string(fields) + " campos de texto, " + to_string(SymbolTable::global().size() - symbolsBefore) + " simbolos nuevos";
+  result += "\nEntidad | sizeof antes | sizeof ahora | bytes antes | bytes ahora";
+  result += "\nReaccion | " + to_string(sizeof(StringReaction)) + " | " + to_string(sizeof(Reaction)) + " | " + to_string(reactionBytes[0]) + " | " + to_string(reactionBytes[1]);
+  result += "\nMetabolito | " + to_string(sizeof(StringEntity)) + " | " + to_string(sizeof(Metabolite)) + " | " + to_string(metaboliteBytes[0]) + " | " + to_string(metaboliteBytes[1]);
+  result += "\nGen | " + to_string(sizeof(StringEntity)) + " | " + to_string(sizeof(Gen)) + " | " + to_string(genBytes[0]) + " | " + to_string(genBytes[1]);
+  result += "\nTabla de simbolos | - | - | 0 | " + to_string(tableBytes);
+  result += "\nTotal | - | - | " + to_string(before) + " | " + to_string(after) + " (" + to_string(100.0 * after / before) + "%)";
+  return result;
+}
+
+// Bound and stoichiometry scans over the linked list against the column store, plus a CRUD round trip
+string Bench::table(const int &rows)
+{
+  string result{""};
+  const int repeats{10};
+
+  {
+    Model model;
+    fill(model, 100);
+    ReactionTable table(model.getReactionList());
+
+    model.editReaction(model.findReaction("R_5"), 5, "0");
+    table.edit(table.find("R_5"), 5, "0");
+    model.removeReaction(model.findReaction("R_0"));
+    table.remove(table.find("R_0"));
+    model.addReaction(Reaction(1000, "R_nueva", "<-", -10, 0, "G_1", {{1, 1}}));
+    table.add(Reaction(1000, "R_nueva", "<-", -10, 0, "G_1", {{1, 1}}));
+
+    List<Reaction> view;
+    table.toList(view);
+    result += "\nValidacion CRUD y vista List: " + string(view.toString() == model.getReactionList().toString() and table.find("R_0") == -1 ? "OK" : "ERROR");
+  }
+
+  Model model;
+  fill(model, rows);
+  const List<Reaction> &list{model.getReactionList()};
+
+  auto start{chrono::steady_clock::now()};
+  ReactionTable table(list);
+  result += "\nConstruir tabla de " + to_string(rows) + " filas: " + to_string(seconds(start)) + " s";
+  result += "\nRecorrido | lista (s) | tabla (s) | aceleracion | resultado";
+
+  // Every scan runs against both stores; the result column is the count, and both must agree
+  auto compare{[&](const string &name, const auto &matches, const auto &scan)
+               {
+                 int expected{0}, found{0};
+                 double listTime{0}, tableTime{0};
+
+                 // Timed one pass at a time so the clock calls keep the compiler from merging repeated scans
+                 for (int r{0}; r < repeats; r++)
+                 {
+                   auto start{chrono::steady_clock::now()};
+                   expected = 0;
+                   for (Node<Reaction> *aux{list.getFirst()}; aux != nullptr; aux = aux->getNext())
+                     expected += matches(*aux->getDataPtr()) ? 1 : 0;
+                   listTime += seconds(start) / repeats;
+
+                   start = chrono::steady_clock::now();
+                   found = scan();
+                   tableTime += seconds(start) / repeats;
+                 }
+
+                 result += "\n" + name + " | " + to_string(listTime) + " | " + to_string(tableTime) + " | " + to_string(listTime / tableTime) + " | " + to_string(found) + (found == expected ? " OK" : " ERROR, esperado " + to_string(expected));
+               }};
+
+  compare("limites invertidos", [](const Reaction &e)
+          { return e.getLowerLimit() > e.getHigherLimit(); },
+          [&]()
+          { return table.countInverted(); });
+  compare("limites en [0, 1000]", [](const Reaction &e)
+          { return e.getLowerLimit() >= 0 and e.getHigherLimit() <= 1000; },
+          [&]()
+          { return table.countWithin(0, 1000); });
+  compare("reversibles", [](const Reaction &e)
+          { return e.getStoichiometry() == Reaction::REVERSIBLE; },
+          [&]()
+          { return table.countStoichiometry(Reaction::REVERSIBLE); });
+  return result;
+}
+
+// Vector bound kernels against their scalar versions on synthetic bound columns
+string Bench::bounds(const int &rows)
+{
+  string result{""};
+  const int repeats{10};
+
+  vector<int> lower(rows), higher(rows);
+  vector<Reaction::Stoichiometry> stoichiometries(rows);
+  unsigned seed{12345};
+  auto next{[&seed](const int &range)
+            { seed = seed * 1103515245u + 12345u; return int((seed >> 8) % unsigned(range)); }};
+
+  for (int i{0}; i < rows; i++)
+  {
+    lower[i] = next(1401) - 1200;
+    higher[i] = next(1401) - 200;
+    stoichiometries[i] = Reaction::Stoichiometry(next(3));
+  }
+
+  {
+    Model model;
+    fill(model, 100);
+    ReactionTable table(model.getReactionList());
+    table.edit(table.find("R_7"), 4, "2000");
+    table.edit(table.find("R_43"), 5, "-5");
+    vector<int> inverted{table.findInverted()};
+    result += "\nValidacion limites invertidos: " + string(inverted == vector<int>{8, 44} ? "OK" : "ERROR");
+  }
+
+  result += "\nInstrucciones: " + string(BoundKernels::getInstructionSet());
+  result += "\nKernel | escalar (s) | vectorial (s) | aceleracion | resultados iguales";
+
+  // Each pass starts from fresh copies of the columns, copying is not timed
+  auto compare{[&](const string &name, const auto &scalar, const auto &vectorized)
+               {
+                 double scalarTime{0}, vectorTime{0};
+                 bool same{true};
+
+                 for (int r{0}; r < repeats; r++)
+                 {
+                   vector<int> l1(lower), h1(higher), l2(lower), h2(higher);
+
+                   auto start{chrono::steady_clock::now()};
+                   size_t expected{scalar(l1, h1)};
+                   scalarTime += seconds(start) / repeats;
+
+                   start = chrono::steady_clock::now();
+                   size_t found{vectorized(l2, h2)};
+                   vectorTime += seconds(start) / repeats;
+
+                   same = same and found == expected and l1 == l2 and h1 == h2;
+                 }
+                 result += "\n" + name + " | " + to_string(scalarTime) + " | " + to_string(vectorTime) + " | " + to_string(scalarTime / vectorTime) + " | " + (same ? "OK" : "ERROR");
+               }};
+
+  vector<int> found(rows);
+  compare("limites invertidos", [&](vector<int> &l, vector<int> &h)
+          { return BoundKernels::findInvertedScalar(l.data(), h.data(), rows, found.data()); },
+          [&](vector<int> &l, vector<int> &h)
+          { return BoundKernels::findInverted(l.data(), h.data(), rows, found.data()); });
+  compare("acotar a [-1000, 1000]", [&](vector<int> &l, vector<int> &h)
+          { BoundKernels::clampScalar(l.data(), rows, -1000, 1000); BoundKernels::clampScalar(h.data(), rows, -1000, 1000); return size_t(0); },
+          [&](vector<int> &l, vector<int> &h)
+          { BoundKernels::clamp(l.data(), rows, -1000, 1000); BoundKernels::clamp(h.data(), rows, -1000, 1000); return size_t(0); });
+  compare("aplicar estequiometria", [&](vector<int> &l, vector<int> &h)
+          { BoundKernels::applyStoichiometryScalar(stoichiometries.data(), l.data(), h.data(), rows); return size_t(0); },
+          [&](vector<int> &l, vector<int> &h)
+          { BoundKernels::applyStoichiometry(stoichiometries.data(), l.data(), h.data(), rows); return size_t(0); });
+  compare("escalar x2.5", [&](vector<int> &l, vector<int> &h)
+          { BoundKernels::scaleScalar(l.data(), rows, 2.5); BoundKernels::scaleScalar(h.data(), rows, 2.5); return size_t(0); },
+          [&](vector<int> &l, vector<int> &h)
+          { BoundKernels::scale(l.data(), rows, 2.5); BoundKernels::scale(h.data(), rows, 2.5); return size_t(0); });
+  compare("limites abiertos (1000)", [&](vector<int> &l, vector<int> &h)
+          { return BoundKernels::countOpenScalar(l.data(), h.data(), rows, 1000); },
+          [&](vector<int> &l, vector<int> &h)
+          { return BoundKernels::countOpen(l.data(), h.data(), rows, 1000); });
+  return result;
+}
+
+// Query latency through the secondary indexes against a walk over the list, and the cost of keeping them current
+string Bench::query(const int &reactions)
+{
+  string result{""};
+  const int repeats{20};
+  const string compartments[4]{"c", "e", "p", "m"};
+  const string formulas[5]{"C6H12O6", "C3H4O3", "C3H6O3", "C3H7NO2", "H2O"};
+  const string functions[6]{"hexokinase", "pyruvate kinase", "lactate dehydrogenase", "transporter", "synthase", "phosphatase"};
+
+  Model model;
+  fill(model, reactions);
+
+  int i{0};
+  for (Node<Metabolite> *aux{model.getMetaboliteList().getFirst()}; aux != nullptr; aux = aux->getNext(), i++)
+  {
+    aux->getDataPtr()->setCompartment(compartments[i % 4]);
+    aux->getDataPtr()->setChemicalForm(formulas[i % 5]);
+  }
+  i = 0;
+  for (Node<Gen> *aux{model.getGenList().getFirst()}; aux != nullptr; aux = aux->getNext(), i++)
+    aux->getDataPtr()->setFunctional(functions[i % 6] + " " + to_string(i % 500));
+  i = 0;
+  for (Node<Reaction> *aux{model.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext(), i++)
+  {
+    if (i % 50 == 0)
+      model.getReactionList().rename(aux, "EX_" + to_string(i));
+  }
+
+  const Model &view{model};
+  auto start{chrono::steady_clock::now()};
+  const Query &query{view.getQuery()};
+  double buildTime{seconds(start)};
+  result += "\nModelo: " + to_string(reactions) + " reacciones, " + to_string(model.getMetaboliteList().size()) + " metabolitos, " + to_string(model.getGenList().size()) + " genes";
+  result += "\nConstruir indices: " + to_string(buildTime) + " s";
+  result += "\nConsulta | resultados | indice (ms) | recorrido (ms) | aceleracion | iguales";
+
+  // Both sides are sorted by position before comparing, the indexes return entities in no particular order
+  auto compare{[&](const string &name, const auto &list, const auto &indexed, const auto &matches)
+               {
+                 auto found{indexed()};
+                 double indexTime{0}, scanTime{0};
+                 decltype(found) expected;
+
+                 for (int r{0}; r < repeats; r++)
+                 {
+                   auto start{chrono::steady_clock::now()};
+                   found = indexed();
+                   indexTime += seconds(start) * 1000 / repeats;
+
+                   start = chrono::steady_clock::now();
+                   expected.clear();
+                   for (auto aux{list.getFirst()}; aux != nullptr; aux = aux->getNext())
+                   {
+                     if (matches(*aux->getDataPtr()))
+                       expected.push_back(aux);
+                   }
+                   scanTime += seconds(start) * 1000 / repeats;
+                 }
+
+                 std::sort(found.begin(), found.end());
+                 std::sort(expected.begin(), expected.end());
+                 result += "\n" + name + " | " + to_string(found.size()) + " | " + to_string(indexTime) + " | " + to_string(scanTime) + " | " + to_string(scanTime / indexTime) + " | " +
+                           (found == expected ? "OK" : "ERROR");
+               }};
+
+  const List<Reaction> &reactionList{view.getReactionList()};
+  const List<Metabolite> &metaboliteList{view.getMetaboliteList()};
+  const List<Gen> &genList{view.getGenList()};
+
+  compare("metabolitos en compartimiento e", metaboliteList, [&]()
+          { return query.getCompartments().equal("e"); },
+          [](const Metabolite &e)
+          { return e.getCompartment() == "e"; });
+  compare("metabolitos con formula C3H7NO2", metaboliteList, [&]()
+          { return query.getFormulas().equal("C3H7NO2"); },
+          [](const Metabolite &e)
+          { return e.getChemicalForm() == "C3H7NO2"; });
+  compare("reacciones con prefijo EX_1", reactionList, [&]()
+          { return query.getReactionNames().prefix("EX_1"); },
+          [](const Reaction &e)
+          { return e.getName().compare(0, 4, "EX_1") == 0; });
+  compare("metabolitos con prefijo M_123", metaboliteList, [&]()
+          { return query.getMetaboliteNames().prefix("M_123"); },
+          [](const Metabolite &e)
+          { return e.getName().compare(0, 5, "M_123") == 0; });
+  compare("genes con 'kinase 4' en funcional", genList, [&]()
+          { return query.getFunctionals().contains("kinase 4"); },
+          [](const Gen &e)
+          { return e.getFunctional().find("kinase 4") != string::npos; });
+  compare("metabolitos con '_777' en el nombre", metaboliteList, [&]()
+          { return query.getMetaboliteNames().contains("_777"); },
+          [](const Metabolite &e)
+          { return e.getName().find("_777") != string::npos; });
+
+  // Edits through Model update the indexes in place instead of rebuilding them
+  const int edits{1000};
+  vector<Node<Metabolite> *> targets;
+  for (Node<Metabolite> *aux{model.getMetaboliteList().getFirst()}; aux != nullptr and int(targets.size()) < edits; aux = aux->getNext())
+    targets.push_back(aux);
+
+  start = chrono::steady_clock::now();
+  for (int k{0}; k < int(targets.size()); k++)
+    model.editMetabolite(targets[k], 4, "x");
+  double editTime{seconds(start)};
+
+  // A rebuild would show up as a first lookup about as slow as the initial build
+  start = chrono::steady_clock::now();
+  size_t moved{view.getQuery().getCompartments().equal("x").size()};
+  double lookup{seconds(start)};
+  result += "\nEditar compartimiento con indices al dia: " + to_string(editTime / targets.size() * 1e6) + " us por edicion, reconstruir: " + to_string(buildTime * 1e6) + " us";
+  result += "\nIndices al dia tras " + to_string(targets.size()) + " ediciones sin reconstruir: " + string(moved == targets.size() and lookup < buildTime / 10 ? "OK" : "ERROR");
+  return result;
+}
+
+// Counts, dead ends and compartments kept up by the list listeners against building them again after every edit
+string Bench::derived(const int &reactions)
+{
+  string result{""};
+  const int edits{min(2000, reactions / 2)};
+  const string compartments[3]{"c", "e", "p"};
+
+  Model model;
+  const Model &view{model};
+  fill(model, reactions);
+
+  auto start{chrono::steady_clock::now()};
+  view.getDerivedData();
+  double buildTime{seconds(start)};
+  start = chrono::steady_clock::now();
+  view.getStoichiometricMatrix();
+  double matrixTime{seconds(start)};
+
+  vector<Node<Reaction> *> reactionTargets;
+  vector<Node<Metabolite> *> metaboliteTargets;
+  for (Node<Reaction> *aux{model.getReactionList().getFirst()}; aux != nullptr and int(reactionTargets.size()) < edits; aux = aux->getNext())
+    reactionTargets.push_back(aux);
+  for (Node<Metabolite> *aux{model.getMetaboliteList().getFirst()}; aux != nullptr and int(metaboliteTargets.size()) < edits; aux = aux->getNext())
+    metaboliteTargets.push_back(aux);
+
+  // Bounds, compartments, new reactions and removals, reading the figures after each edit
+  long seen{0};
+  start = chrono::steady_clock::now();
+  for (int k{0}; k < edits; k++)
+  {
+    switch (k % 4)
+    {
+    case 0:
+      model.editReaction(reactionTargets[k], 5, "0");
+      break;
+    case 1:
+      model.editMetabolite(metaboliteTargets[k], 4, compartments[k % 3]);
+      break;
+    case 2:
+      model.addReaction(Reaction(reactions + k + 1, "N_" + to_string(k), "->", 0, 1000, "", {{k % 7 + 1, -1}, {reactions + k, 1}}));
+      break;
+    default:
+      model.removeReaction(reactionTargets[k]);
+      break;
+    }
+    seen += view.getDerivedData().getDeadEnds().size() + view.getDerivedData().getCompartmentCount("e");
+  }
+  double editTime{seconds(start)};
+
+  // Reactions appended at the tail only add columns, the matrix is not built again
+  view.getStoichiometricMatrix();
+  start = chrono::steady_clock::now();
+  for (int k{0}; k < edits; k++)
+    model.addReaction(Reaction(reactions + edits + k + 1, "A_" + to_string(k), "<->", -1000, 1000, "", {{k % 5 + 1, -1}, {k % 11 + 1, 2}}));
+  StoichiometricMatrix appended{view.getStoichiometricMatrix()};
+  double appendTime{seconds(start)};
+
+  DerivedData fresh;
+  fresh.build(view.getReactionList(), view.getMetaboliteList());
+  StoichiometricMatrix built;
+  built.build(view.getReactionList(), view.getMetaboliteList());
+
+  int walked{0};
+  for (Node<Reaction> *aux{view.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext())
+    walked++;
+
+  bool ok{view.getNumberOfReactions() == walked and view.getNumberOfMetabolites() == int(view.getMetaboliteList().size()) and view.getNumberOfGens() == int(view.getGenList().size())};
+  ok = ok and fresh.getDeadEnds() == view.getDerivedData().getDeadEnds() and fresh.getCompartmentCounts() == view.getDerivedData().getCompartmentCounts();
+  ok = ok and appended.getColumnStart() == built.getColumnStart() and appended.getRowIndex() == built.getRowIndex() and appended.getColumnValue() == built.getColumnValue();
+  ok = ok and appended.getRowStart() == built.getRowStart() and appended.getColumnIndex() == built.getColumnIndex() and appended.getRowValue() == built.getRowValue() and appended.getUnresolved() == built.getUnresolved();
+
+  result += "\nModelo: " + to_string(reactions) + " reacciones, " + to_string(view.getNumberOfMetabolites()) + " metabolitos, " + to_string(edits) + " ediciones";
+  result += "\nConstruir datos derivados: " + to_string(buildTime) + " s, matriz: " + to_string(matrixTime) + " s";
+  result += "\nEditar y leer con datos al dia: " + to_string(editTime / edits * 1e6) + " us por edicion, reconstruir: " + to_string(buildTime * 1e6) + " us";
+  result += "\nAgregar " + to_string(edits) + " reacciones y leer la matriz: " + to_string(appendTime) + " s, reconstruir: " + to_string(matrixTime) + " s";
+  result += "\nMetabolitos sin salida: " + to_string(fresh.getDeadEnds().size()) + " (lecturas: " + to_string(seen) + ")";
+  result += "\nConteos, metabolitos sin salida, compartimientos y matriz iguales a reconstruirlos: " + string(ok ? "OK" : "ERROR");
+  return result;
+}
+
+// Threads sharing one model list. The stress pass adds, edits and removes reactions through the model locks while
+// readers check that counts, walks and indexes agree; the throughput pass runs one batch per thread with several
+// read ratios
+string Bench::concurrent(const int &reactions, const int &threads)
+{
+  string result{""};
+  const int models{4};
+  const int operations{20000}; //per thread and pass
+  List<Model> modelList;
+
+  modelList.setIndexed(true);
+  for (int m{0}; m < models; m++)
+  {
+    Model model;
+    model.setName("M" + to_string(m));
+    fill(model, reactions);
+    modelList.insertUnchecked(model, modelList.back());
+  }
+  vector<Model *> catalog;
+  for (Node<Model> *aux{modelList.getFirst()}; aux != nullptr; aux = aux->getNext())
+    catalog.push_back(aux->getDataPtr());
+
+  ThreadPool pool(threads);
+  atomic<long> reads{0}, writes{0}, mismatches{0};
+
+  auto start{chrono::steady_clock::now()};
+  pool.run(pool.getThreads(), [&](const int &task, const int &)
+           {
+             for (int i{0}; i < operations / 4; i++)
+             {
+               Model &model{*catalog[(task + i / 4) % models]}; //the reaction added at i is removed at i + 2
+               string name{"T_" + to_string(task) + "_" + to_string(i)};
+
+               if (i % 4 == 0)
+               {
+                 unique_lock<shared_mutex> guard(model.getMutex());
+                 model.addReaction(Reaction(reactions + 1, name, "->", 0, 10, "", {{i % 7 + 1, -1}, {i % 11 + 1, 1}}));
+                 model.editReaction(model.findReaction("R_" + to_string(i % reactions)), 5, to_string(i % 1000));
+                 writes++;
+               }
+               else if (i % 4 == 2)
+               {
+                 unique_lock<shared_mutex> guard(model.getMutex());
+                 model.removeReaction(model.findReaction("T_" + to_string(task) + "_" + to_string(i - 2)));
+                 writes++;
+               }
+               else
+               {
+                 shared_lock<shared_mutex> guard(model.getMutex());
+                 const Model &view{model};
+                 int walked{0}, added{0};
+                 for (Node<Reaction> *aux{view.getReactionList().getFirst()}; aux != nullptr; aux = aux->getNext())
+                 {
+                   walked++;
+                   added += aux->getDataPtr()->getName()[0] == 'T';
+                 }
+                 if (walked != view.getNumberOfReactions() or int(view.getQuery().getReactionNames().prefix("T_").size()) != added or
+                     view.getDerivedData().getDeadEnds().size() > size_t(view.getNumberOfMetabolites()))
+                   mismatches++;
+                 reads++;
+               }
+             }
+           });
+  double stressTime{seconds(start)};
+
+  bool ok{mismatches == 0};
+  for (const Model *e : catalog)
+  {
+    DerivedData fresh;
+    fresh.build(e->getReactionList(), e->getMetaboliteList());
+    ok = ok and e->getNumberOfReactions() == reactions and e->getQuery().getReactionNames().prefix("T_").empty() and fresh.getDeadEnds() == e->getDerivedData().getDeadEnds();
+  }
+
+  result += "\nModelos: " + to_string(models) + " de " + to_string(reactions) + " reacciones, hilos: " + to_string(pool.getThreads());
+  result += "\nPrueba de estres: " + to_string(reads) + " lecturas, " + to_string(writes) + " escrituras en " + to_string(stressTime) + " s";
+  result += "\nLecturas consistentes y modelos iguales al final: " + string(ok ? "OK" : "ERROR");
+  result += "\nLecturas (%) | hilos | operaciones/s";
+
+  // Every operation looks the model up under the shared list lock, then reads or edits one reaction of it
+  for (int ratio : {100, 90, 50})
+  {
+    for (int used : {1, pool.getThreads()})
+    {
+      atomic<long> failures{0};
+      start = chrono::steady_clock::now();
+      pool.run(used, [&](const int &task, const int &)
+               {
+                 for (int i{0}; i < operations; i++)
+                 {
+                   long hash{long(task) * 7919 + long(i) * 104729};
+                   string reaction{"R_" + to_string(hash % reactions)};
+                   shared_lock<shared_mutex> catalogGuard(modelList.getMutex());
+                   Model &model{*modelList.searchByName("M" + to_string(hash % models))->getDataPtr()};
+
+                   if (hash % 100 < ratio)
+                   {
+                     shared_lock<shared_mutex> guard(model.getMutex());
+                     Node<Reaction> *found{static_cast<const Model &>(model).findReaction(reaction)};
+                     if (found == nullptr or found->getDataPtr()->getHigherLimit() < 0)
+                       failures++;
+                   }
+                   else
+                   {
+                     unique_lock<shared_mutex> guard(model.getMutex());
+                     model.editReaction(model.findReaction(reaction), 5, to_string(hash % 1000));
+                   }
+                 }
+               });
+      double elapsed{seconds(start)};
+      result += "\n" + to_string(ratio) + " | " + to_string(used) + " | " + to_string(used * operations / elapsed) + (failures > 0 ? " (" + to_string(failures) + " errores)" : "");
+    }
+  }
+  return result;
+}
+
+// Appends from several threads into the lock free AppendList against a List guarded by a mutex, then the append
+// list is moved into a List and every element has to be there once
+string Bench::append(const int &elements, const int &maximumThreads)
+{
+  string result{"\nHilos | lista sin bloqueo (elementos/s) | List con mutex (elementos/s) | aceleracion | completa"};
+
+  for (int threads{1}; threads <= maximumThreads; threads *= 2)
+  {
+    ThreadPool pool(threads);
+    int each{elements / threads};
+    int total{each * threads};
+    AppendList<Reaction> concurrent;
+    List<Reaction> guarded;
+    mutex lock;
+
+    auto start{chrono::steady_clock::now()};
+    pool.run(threads, [&](const int &task, const int &)
+             {
+               Reaction reaction(0, "R", "->", 0, 1000, "", {{1, -1}, {2, 1}});
+               for (int i{0}; i < each; i++)
+               {
+                 reaction.setId(task * each + i);
+                 concurrent.append(reaction);
+               }
+             });
+    double freeTime{seconds(start)};
+
+    start = chrono::steady_clock::now();
+    pool.run(threads, [&](const int &task, const int &)
+             {
+               Reaction reaction(0, "R", "->", 0, 1000, "", {{1, -1}, {2, 1}});
+               for (int i{0}; i < each; i++)
+               {
+                 reaction.setId(task * each + i);
+                 lock_guard<mutex> guard(lock);
+                 guarded.insertUnchecked(reaction, guarded.back());
+               }
+             });
+    double lockedTime{seconds(start)};
+
+    List<Reaction> moved;
+    concurrent.moveTo(moved);
+    vector<char> seen(total, 0);
+    bool ok{int(moved.size()) == total and concurrent.size() == 0};
+    for (Node<Reaction> *aux{moved.getFirst()}; ok and aux != nullptr; aux = aux->getNext())
+    {
+      int id{aux->getDataPtr()->getId()};
+      ok = id >= 0 and id < total and seen[id]++ == 0;
+    }
+
+    result += "\n" + to_string(threads) + " | " + to_string(total / freeTime) + " | " + to_string(total / lockedTime) + " | " + to_string(lockedTime / freeTime) + " | " + (ok ? "OK" : "ERROR");
+  }
+  return result;
+}
+
+// A file of several models in the Loader format, loaded by the sequential Loader and by ParallelLoader with an
+// increasing number of threads; every load has to write the same file back
+string Bench::load(const int &models, const int &reactions, const int &maximumThreads)
+{
+  string result{""};
+  string fileName{"bench_load.txt"};
+  List<Model> source;
+
+  for (int m{0}; m < models; m++)
+  {
+    Model model;
+    model.setName("M" + to_string(m));
+    fill(model, reactions);
+    source.insertUnchecked(model, source.back());
+  }
+  {
+    ofstream file(fileName, ios::binary);
+    Loader::save(source, file);
+  }
+  ostringstream expected;
+  Loader::save(source, expected);
+  source.deleteAll();
+
+  List<Model> sequential;
+  auto start{chrono::steady_clock::now()};
+  Loader(sequential).load(fileName);
+  double sequentialTime{seconds(start)};
+  ostringstream written;
+  Loader::save(sequential, written);
+  sequential.deleteAll();
+
+  result += "\nArchivo: " + to_string(models) + " modelos de " + to_string(reactions) + " reacciones, " + to_string(expected.str().size() / 1048576.0) + " MB";
+  result += "\nHilos | tiempo (s) | aceleracion | igual";
+  result += "\nsecuencial | " + to_string(sequentialTime) + " | 1.000000 | " + (written.str() == expected.str() ? "OK" : "ERROR");
+
+  for (int threads{1}; threads <= maximumThreads; threads *= 2)
+  {
+    ThreadPool pool(threads);
+    List<Model> parallel;
+    start = chrono::steady_clock::now();
+    ParallelLoader loader(parallel, pool);
+    loader.load(fileName);
+    double elapsed{seconds(start)};
+
+    ostringstream output;
+    Loader::save(parallel, output);
+    result += "\n" + to_string(threads) + " | " + to_string(elapsed) + " | " + to_string(sequentialTime / elapsed) + " | " + (output.str() == expected.str() and loader.getModelCount() == models ? "OK" : "ERROR");
+  }
+
+  remove(fileName.c_str());
+  return result;
+}
+
+// Edits per second with every edit committed to the journal before it is applied. Each thread edits its own model,
+// so the commits of different threads share fsyncs; the last row writes without syncing
+string Bench::journal(const int &edits, const int &maximumThreads)
+{
+  string result{""};
+  string base{"bench_journal"};
+
+  auto measure = [&](const int &threads, const bool &syncing) {
+    List<Model> modelList;
+    Model modelAux;
+    for (int t{0}; t < threads; t++)
+    {
+      modelAux.setName("M" + to_string(t));
+      fill(*modelList.insertUnchecked(modelAux, modelList.back())->getDataPtr(), 1000);
+    }
+
+    std::remove((base + ".wal").c_str());
+    Journal journal(modelList);
+    journal.open(base);
+    journal.recover([](const Journal::Record &) {});
+    journal.setSync(syncing);
+    Model::addRecorder(&Journal::record, &journal);
+
+    vector<thread> workers;
+    auto start{chrono::steady_clock::now()};
+    for (int t{0}; t < threads; t++)
+    {
+      workers.emplace_back([&, t]() {
+        Model &model{*modelList.searchByName("M" + to_string(t))->getDataPtr()};
+        for (int i{t}; i < edits; i += threads)
+          model.editReaction(model.findReaction("R_" + to_string(i % 1000)), 5, to_string(i));
+      });
+    }
+    for (thread &e : workers)
+      e.join();
+    double elapsed{seconds(start)};
+
+    Model::removeRecorder(&journal);
+    uint64_t syncs{journal.getSyncs()};
+    result += "\n" + to_string(threads) + " | " + (syncing ? "si" : "no") + " | " + to_string(edits / elapsed) + " | " + to_string(syncs) + " | " + to_string(double(edits) / max<uint64_t>(syncs, 1));
+  };
+
+  result += "\nHilos | fsync | ediciones/seg | escrituras | ediciones por escritura";
+  for (int threads{1}; threads <= maximumThreads; threads *= 2)
+    measure(threads, true);
+  measure(maximumThreads, false);
+
+  std::remove((base + ".wal").c_str());
+  return result;
+}
+
+// Crash test: a child process edits a model through the journal, checkpointing as the log grows, and reports every
+// edit once it is committed; it is killed at a random point and a torn record is added to its log, as a crash in the
+// middle of a write would leave it. Recovery has to hold every reported edit and cut the torn record
+string Bench::recovery(const int &reactions, const int &milliseconds)
+{
+#ifdef _WIN32
+  return "\nNo disponible en esta plataforma";
+#else
+  string result{""};
+  string base{"bench_recovery"};
+  const long first{1000000};
+  int channel[2];
+
+  std::remove((base + ".wal").c_str());
+  if (pipe(channel) < 0)
+    return "\nNo se pudo crear el canal";
+
+  pid_t child{fork()};
+  if (child < 0)
+    return "\nNo se pudo crear el proceso";
+  if (child == 0)
+  {
+    ::close(channel[0]);
+    try
+    {
+      List<Model> modelList;
+      Model modelAux;
+      modelAux.setName("M");
+      fill(*modelList.insertUnchecked(modelAux, nullptr)->getDataPtr(), reactions);
+
+      Journal journal(modelList);
+      journal.open(base);
+      journal.recover([](const Journal::Record &) {});
+      journal.checkpoint();
+      journal.setCheckpointBytes(64 << 10);
+      Model::addRecorder(&Journal::record, &journal);
+
+      Model &model{*modelList.getFirst()->getDataPtr()};
+      for (long i{1};; i++)
+      {
+        model.editReaction(model.findReaction("R_" + to_string(i % 100)), 5, to_string(first + i));
+        if (::write(channel[1], &i, sizeof(i)) != sizeof(i))
+          break;
+        if (journal.isFull())
+          journal.checkpoint();
+      }
+    }
+    catch (std::exception &ex)
+    {
+      cerr << ex.what() << endl;
+    }
+    _exit(1);
+  }
+  ::close(channel[1]);
+
+  long acknowledged{0}, received;
+  auto start{chrono::steady_clock::now()};
+  int deadline{milliseconds / 2 + int(chrono::steady_clock::now().time_since_epoch().count() % (milliseconds / 2 + 1))};
+  while (seconds(start) * 1000 < deadline and read(channel[0], &received, sizeof(received)) == sizeof(received))
+    acknowledged = received;
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+  while (read(channel[0], &received, sizeof(received)) == sizeof(received))
+    acknowledged = received;
+  ::close(channel[0]);
+
+  {
+    ofstream torn(base + ".wal", ios::binary | ios::app);
+    torn << "512 0badc0de\nE1:M1:1";
+  }
+
+  List<Model> modelList;
+  Journal journal(modelList);
+  start = chrono::steady_clock::now();
+  journal.open(base);
+  long records{journal.recover([&modelList](const Journal::Record &record) { Journal::apply(modelList, record); })};
+  double elapsed{seconds(start)};
+
+  // Reaction R_k has to hold its last reported edit or a later one of its own
+  bool complete{modelList.getFirst() != nullptr};
+  for (int k{0}; complete and k < 100; k++)
+  {
+    Node<Reaction> *position{modelList.getFirst()->getDataPtr()->findReaction("R_" + to_string(k))};
+    long expected{acknowledged - (acknowledged - k + 100) % 100};
+    long found{position == nullptr ? 0 : position->getDataPtr()->getHigherLimit() - first};
+    complete = position != nullptr and (expected <= 0 ? found == 1000 - first or (found > 0 and found % 100 == k) : found >= expected and found % 100 == k);
+  }
+
+  result += "\nEdiciones confirmadas antes de matar el proceso: " + to_string(acknowledged);
+  result += "\nCheckpoints: " + to_string(journal.getGeneration());
+  result += "\nRecuperacion: " + to_string(records) + " registros del log en " + to_string(elapsed) + " s, " + to_string(journal.getTruncated()) + " bytes cortados";
+  result += "\nEdiciones confirmadas presentes: ";
+  result += complete and journal.getTruncated() > 0 ? "OK" : "FALLO";
+
+  for (const string &e : {base + ".wal", base + ".wal.tmp"})
+    std::remove(e.c_str());
+  for (uint64_t g{journal.getGeneration()}; g > 0 and g + 2 > journal.getGeneration(); g--)
+    std::remove((base + "." + to_string(g) + ".snap").c_str());
+  return result;
+#endif
+}
+
+string Bench::run(const string &name, const vector<int> &args)
+{
+  if (name == "snapshot")
+    return snapshot(args.empty() ? 100000 : args[0]);
+  if (name == "list")
+    return list(args.empty() ? 1000000 : args[0]);
+  if (name == "sort")
+    return sort(args.empty() ? 1000000 : args[0]);
+  if (name == "alloc")
+  {
+    int size{args.empty() ? 1000000 : args[0]};
+    return "\nDistribucion | asignaciones | construir (s) | recorrer (s)" + layout<NodeHeap<Reaction>>("nodo + dato", size) + layout<NodePool<Reaction>>("pool, dato en nodo", size);
+  }
+  if (name == "move")
+    return move(args.empty() ? 100000 : args[0]);
+  if (name == "matrix")
+    return matrix(args.empty() ? 100000 : args[0]);
+  if (name == "fba")
+    return fba(args.empty() ? 10000 : args[0]);
+  if (name == "fva")
+    return fva(args.empty() ? 2000 : args[0], args.size() < 2 ? ThreadPool::hardwareThreads() : args[1]);
+  if (name == "knockout")
+    return knockout(args.empty() ? 500 : args[0], args.size() < 2 ? ThreadPool::hardwareThreads() : args[1]);
+  if (name == "clone")
+    return clone(args.empty() ? 50000 : args[0], args.size() < 2 ? 100 : args[1]);
+  if (name == "memory")
+    return memory(args.empty() ? 100000 : args[0]);
+  if (name == "table")
+    return table(args.empty() ? 1000000 : args[0]);
+  if (name == "bounds")
+    return bounds(args.empty() ? 1000000 : args[0]);
+  if (name == "query")
+    return query(args.empty() ? 200000 : args[0]);
+  if (name == "derived")
+    return derived(args.empty() ? 200000 : args[0]);
+  if (name == "concurrent")
+    return concurrent(args.empty() ? 20000 : args[0], args.size() < 2 ? max(4, ThreadPool::hardwareThreads()) : args[1]);
+  if (name == "append")
+    return append(args.empty() ? 1000000 : args[0], args.size() < 2 ? 64 : args[1]);
+  if (name == "load")
+    return load(args.empty() ? 32 : args[0], args.size() < 2 ? 20000 : args[1], args.size() < 3 ? max(4, ThreadPool::hardwareThreads()) : args[2]);
+  if (name == "journal")
+    return journal(args.empty() ? 2000 : args[0], args.size() < 2 ? 16 : args[1]);
+  if (name == "recovery")
+    return recovery(args.empty() ? 1000 : args[0], args.size() < 2 ? 400 : args[1]);
+  if (name == "server")
+    return server(args.empty() ? 20000 : args[0], args.size() < 2 ? 8 : args[1], args.size() < 3 ? 5000 : args[2]);
+  return "Benchmarks: snapshot [reacciones], list [elementos], sort [elementos], alloc [elementos], move [reacciones], matrix [reacciones], fba [reacciones], fva [reacciones] [hilos], "
+         "knockout [reacciones] [hilos], clone [reacciones] [clones], memory [reacciones], table [filas], bounds [filas], query [reacciones], derived [reacciones], concurrent [reacciones] [hilos], append [elementos] [hilos], load [modelos] [reacciones] [hilos], server [reacciones] [conexiones] [peticiones], journal [ediciones] [hilos], recovery [reacciones] [ms]";
+}
+
+//* -------- ------- ------ ----- Batch ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+class Batch
+{
+private:
+  List<Model> &modelList;
+  Node<Model> *current;
+  uint64_t catalogVersion; //of modelList when current was last found in it
+  Journal *journal;
+  unique_ptr<Journal> ownedJournal; //opened with -j
+  bool quiet;
+  long operations;
+  long failures;
+  double seconds;
+
+  static vector<string> split(const string &, const char &);
+  static string trim(const string &);
+  static int toInt(const string &);
+  static double toDouble(const string &);
+  static int toEntity(const string &);
+  static int toField(const int &, const string &);
+
+  Node<Model> *findModel(const string &);
+  Model &currentModel();
+
+  string add(const int &, const vector<string> &);
+  string list(const int &);
+  string search(const int &, const string &);
+  string edit(const int &, const vector<string> &);
+  string remove(const int &, const string &);
+  string sort(const int &);
+  string query(const int &, const vector<string> &);
+  void replay(const Journal::Record &);
+
+  template <class T>
+  static vector<string> match(const FieldIndex<T> &, const string &, const string &);
+
+public:
+  class Exception : public std::exception
+  {
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  Batch(List<Model> &);
+
+  void setQuiet(const bool &);
+  void setJournal(Journal *); //shared by every batch on the list
+  long recover(Journal &); //replays the journal through this batch and starts recording to it
+
+  string execute(const string &);
+  void run(istream &);
+  int run(int argc, char const *argv[]);
+
+  string report() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Batch::Batch(List<Model> &e) : modelList(e), current(nullptr), catalogVersion(0), journal(nullptr), quiet(false), operations(0), failures(0), seconds(0) {}
+
+vector<string> Batch::split(const string &line, const char &separator)
+{
+  vector<string> result;
+  string::size_type begin{0}, end;
+
+  while ((end = line.find(separator, begin)) != string::npos)
+  {
+    result.push_back(trim(line.substr(begin, end - begin)));
+    begin = end + 1;
+  }
+  result.push_back(trim(line.substr(begin)));
+
+  return result;
+}
+
+string Batch::trim(const string &e)
+{
+  string::size_type begin{e.find_first_not_of(" \t\r\n")};
+  if (begin == string::npos)
+    return "";
+  return e.substr(begin, e.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+int Batch::toInt(const string &e)
+{
+  size_t used{0};
+  int result{0};
+
+  try
+  {
+    result = stoi(e, &used);
+  }
+  catch (std::exception &)
+  {
+    used = 0;
+  }
+
+  if (used == 0 or used != e.size())
+  {
+    throw Exception("Entero invalido: " + e);
+  }
+  return result;
+}
+
+double Batch::toDouble(const string &e)
+{
+  const char *begin{e.c_str()};
+  char *end{nullptr};
+  double result{strtod(begin, &end)};
+
+  if (end == begin or *end != '\0')
+  {
+    throw Exception("Numero invalido: " + e);
+  }
+  return result;
+}
+
+int Batch::toEntity(const string &e)
+{
+  if (e == "model")
+    return 0;
+  if (e == "reaction")
+    return 1;
+  if (e == "metabolite")
+    return 2;
+  if (e == "gen")
+    return 3;
+  throw Exception("Tipo desconocido: " + e);
+}
+
+int Batch::toField(const int &entity, const string &e)
+{
+  static const char *fields[4][5] = {{"name", "objective", "compartments", "", ""},
+                                     {"id", "name", "stoichiometry", "lower", "upper"},
+                                     {"id", "name", "formula", "compartment", ""},
+                                     {"id", "name", "functional", "", ""}};
+
+  for (int i{0}; i < 5; i++)
+  {
+    if (e == fields[entity][i])
+      return i + 1;
+  }
+  throw Exception("Campo desconocido: " + e);
+}
+
+Node<Model> *Batch::findModel(const string &e)
+{
+  return modelList.searchByName(e);
+}
+
+Model &Batch::currentModel()
+{
+  if (current == nullptr)
+  {
+    throw Exception("Ningun modelo seleccionado, use <modelo>");
+  }
+
+  // Another batch on the same list may have removed it; the walk only runs after the list of models changed
+  if (modelList.getVersion() != catalogVersion)
+  {
+    Node<Model> *aux{modelList.getFirst()};
+    while (aux != nullptr and aux != current)
+      aux = aux->getNext();
+    if (aux == nullptr)
+    {
+      current = nullptr;
+      throw Exception("El modelo actual fue eliminado");
+    }
+    catalogVersion = modelList.getVersion();
+  }
+  return *current->getDataPtr();
+}
+
+string Batch::add(const int &entity, const vector<string> &args)
+{
+  static const size_t minimum[4] = {1, 5, 2, 2};
+
+  if (args.size() < minimum[entity])
+  {
+    throw Exception("Faltan campos");
+  }
+
+  if (entity == 0)
+  {
+    Model modelAux;
+    modelAux.setName(args[0]);
+    modelAux.setObjetiveExpression(args.size() > 1 ? args[1] : "");
+    modelAux.setCompartments(args.size() > 2 ? args[2] : "");
+    current = modelList.insertUnchecked(modelAux, modelList.back());
+    return current->getDataPtr()->toString();
+  }
+
+  Model &model{currentModel()};
+
+  if (entity == 1)
+  {
+    Reaction reactionAux;
+    Node<Gen> *auxNodeGen{nullptr};
+    Node<Metabolite> *auxNodeMetabolite{nullptr};
+
+    reactionAux.setId(toInt(args[0]));
+    reactionAux.setName(args[1]);
+    reactionAux.setStoichiometry(args[2]);
+    reactionAux.setLowerLimit(toInt(args[3]));
+    reactionAux.setHigherLimit(toInt(args[4]));
+
+    if (args.size() > 6 and !args[6].empty())
+    {
+      for (const string &item : split(args[6], ','))
+      {
+        size_t colon{item.rfind(':')};
+        string name{item.substr(0, colon)};
+        if ((auxNodeMetabolite = model.findMetabolite(name)) == nullptr)
+        {
+          throw Exception("Metabolito no encontrado: " + name);
+        }
+        reactionAux.addParticipant(auxNodeMetabolite->getDataPtr()->getId(), colon == string::npos ? 1 : toDouble(item.substr(colon + 1)));
+      }
+    }
+
+    // The gene field is a rule such as "g1 or (g2 and g3)"; every gene in it must exist and lists the reaction
+    if (args.size() > 5 and !args[5].empty())
+    {
+      vector<Node<Gen> *> genes;
+      try
+      {
+        for (const string &name : GeneRule(args[5]).getGenes())
+        {
+          if ((auxNodeGen = model.findGen(name)) == nullptr)
+          {
+            throw Exception("Gen no encontrado: " + name);
+          }
+          genes.push_back(auxNodeGen);
+        }
+      }
+      catch (GeneRule::Exception &ex)
+      {
+        throw Exception(ex.what());
+      }
+      reactionAux.setGenReaction(args[5]);
+      for (Node<Gen> *e : genes)
+      {
+        Gen &gen{*e->getDataPtr()};
+        gen.setGenReaction(gen.getGenReaction().empty() ? args[1] : gen.getGenReaction() + "," + args[1]);
+      }
+    }
+
+    return model.addReaction(std::move(reactionAux))->getDataPtr()->toString();
+  }
+  else if (entity == 2)
+  {
+    Metabolite metaboliteAux;
+    metaboliteAux.setId(toInt(args[0]));
+    metaboliteAux.setName(args[1]);
+    metaboliteAux.setChemicalForm(args.size() > 2 ? args[2] : "");
+    metaboliteAux.setCompartment(args.size() > 3 ? args[3] : "");
+    return model.addMetabolite(std::move(metaboliteAux))->getDataPtr()->toString();
+  }
+  else
+  {
+    Gen genAux;
+    genAux.setId(toInt(args[0]));
+    genAux.setName(args[1]);
+    genAux.setFunctional(args.size() > 2 ? args[2] : "");
+    return model.addGen(std::move(genAux))->getDataPtr()->toString();
+  }
+}
+
+string Batch::list(const int &entity)
+{
+  if (entity == 0)
+    return modelList.toString();
+  const Model &model{currentModel()}; //reading does not unshare the lists of a clone
+  if (entity == 1)
+    return model.getReactionList().toString();
+  if (entity == 2)
+    return model.getMetaboliteList().toString();
+  return model.getGenList().toString();
+}
+
+string Batch::search(const int &entity, const string &name)
+{
+  void *found{nullptr};
+  string result{""};
+
+  if (entity == 0)
+  {
+    Node<Model> *auxNodeModel{findModel(name)};
+    if (auxNodeModel != nullptr)
+      result = auxNodeModel->getDataPtr()->toString();
+    found = auxNodeModel;
+  }
+  else if (entity == 1)
+  {
+    const Model &model{currentModel()};
+    Node<Reaction> *auxNodeReaction{model.findReaction(name)};
+    if (auxNodeReaction != nullptr)
+      result = auxNodeReaction->getDataPtr()->toString();
+    found = auxNodeReaction;
+  }
+  else if (entity == 2)
+  {
+    const Model &model{currentModel()};
+    Node<Metabolite> *auxNodeMetabolite{model.findMetabolite(name)};
+    if (auxNodeMetabolite != nullptr)
+      result = auxNodeMetabolite->getDataPtr()->toString();
+    found = auxNodeMetabolite;
+  }
+  else
+  {
+    const Model &model{currentModel()};
+    Node<Gen> *auxNodeGen{model.findGen(name)};
+    if (auxNodeGen != nullptr)
+      result = auxNodeGen->getDataPtr()->toString();
+    found = auxNodeGen;
+  }
+
+  if (found == nullptr)
+  {
+    throw Exception("No encontrado: " + name);
+  }
+  return result;
+}
+
+string Batch::edit(const int &entity, const vector<string> &args)
+{
+  if (args.size() < 3)
+  {
+    throw Exception("Se esperaba <nombre>|<campo>|<valor>");
+  }
+
+  int option{toField(entity, args[1])};
+
+  if (entity == 0)
+  {
+    Node<Model> *auxNodeModel{findModel(args[0])};
+    if (auxNodeModel == nullptr)
+      throw Exception("Modelo no encontrado: " + args[0]);
+    auxNodeModel->getDataPtr()->record(0, "", option, args[2]);
+    if (option == 1)
+      modelList.rename(auxNodeModel, args[2]);
+    else if (option == 2)
+      auxNodeModel->getDataPtr()->setObjetiveExpression(args[2]);
+    else
+      auxNodeModel->getDataPtr()->setCompartments(args[2]);
+    return auxNodeModel->getDataPtr()->toString();
+  }
+
+  Model &model{currentModel()};
+
+  if (option == 1 or (entity == 1 and (option == 4 or option == 5)))
+  {
+    toInt(args[2]);
+  }
+
+  if (entity == 1)
+  {
+    Node<Reaction> *auxNodeReaction{model.findReaction(args[0])};
+    if (auxNodeReaction == nullptr)
+      throw Exception("Reaccion no encontrada: " + args[0]);
+    model.editReaction(auxNodeReaction, option, args[2]);
+    return auxNodeReaction->getDataPtr()->toString();
+  }
+  else if (entity == 2)
+  {
+    Node<Metabolite> *auxNodeMetabolite{model.findMetabolite(args[0])};
+    if (auxNodeMetabolite == nullptr)
+      throw Exception("Metabolito no encontrado: " + args[0]);
+    model.editMetabolite(auxNodeMetabolite, option, args[2]);
+    return auxNodeMetabolite->getDataPtr()->toString();
+  }
+  else
+  {
+    Node<Gen> *auxNodeGen{model.findGen(args[0])};
+    if (auxNodeGen == nullptr)
+      throw Exception("Gen no encontrado: " + args[0]);
+    model.editGen(auxNodeGen, option, args[2]);
+    return auxNodeGen->getDataPtr()->toString();
+  }
+}
+
+string Batch::remove(const int &entity, const string &name)
+{
+  if (entity == 0)
+  {
+    Node<Model> *auxNodeModel{findModel(name)};
+    if (auxNodeModel == nullptr)
+      throw Exception("Modelo no encontrado: " + name);
+    if (auxNodeModel == current)
+      current = nullptr;
+    modelList.remove(auxNodeModel);
+  }
+  else if (entity == 1)
+  {
+    Node<Reaction> *auxNodeReaction{currentModel().findReaction(name)};
+    if (auxNodeReaction == nullptr)
+      throw Exception("Reaccion no encontrada: " + name);
+    currentModel().removeReaction(auxNodeReaction);
+  }
+  else if (entity == 2)
+  {
+    Node<Metabolite> *auxNodeMetabolite{currentModel().findMetabolite(name)};
+    if (auxNodeMetabolite == nullptr)
+      throw Exception("Metabolito no encontrado: " + name);
+    currentModel().removeMetabolite(auxNodeMetabolite);
+  }
+  else
+  {
+    Node<Gen> *auxNodeGen{currentModel().findGen(name)};
+    if (auxNodeGen == nullptr)
+      throw Exception("Gen no encontrado: " + name);
+    currentModel().removeGen(auxNodeGen);
+  }
+  return "Elemento eliminado";
+}
+
+string Batch::sort(const int &entity)
+{
+  if (entity == 0)
+    modelList.sort();
+  else if (entity == 1)
+    currentModel().sortReactions();
+  else if (entity == 2)
+    currentModel().sortMetabolites();
+  else
+    currentModel().sortGens();
+  return "Elementos ordenados";
+}
+
+// "=" exact, "^" prefix, "~" substring; names come back sorted since the indexes keep no order
+template <class T>
+vector<string> Batch::match(const FieldIndex<T> &index, const string &op, const string &text)
+{
+  vector<Node<T> *> found;
+
+  if (op == "=")
+    found = index.equal(text);
+  else if (op == "^")
+    found = index.prefix(text);
+  else if (op == "~")
+    found = index.contains(text);
+  else
+    throw Exception("Operador desconocido: " + op + " (use =, ^ o ~)");
+
+  vector<string> result;
+  result.reserve(found.size());
+  for (Node<T> *e : found)
+    result.push_back(e->getDataPtr()->getName());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+string Batch::query(const int &entity, const vector<string> &fields)
+{
+  if (fields.size() != 3)
+  {
+    throw Exception("Se esperaba <campo>|<operador>|<texto>");
+  }
+
+  const Query &query{static_cast<const Model &>(currentModel()).getQuery()};
+  const string &field{fields[0]};
+  vector<string> names;
+
+  if (entity == 1 and field == "name")
+    names = match(query.getReactionNames(), fields[1], fields[2]);
+  else if (entity == 2 and field == "name")
+    names = match(query.getMetaboliteNames(), fields[1], fields[2]);
+  else if (entity == 2 and field == "compartment")
+    names = match(query.getCompartments(), fields[1], fields[2]);
+  else if (entity == 2 and field == "formula")
+    names = match(query.getFormulas(), fields[1], fields[2]);
+  else if (entity == 3 and field == "name")
+    names = match(query.getGenNames(), fields[1], fields[2]);
+  else if (entity == 3 and field == "functional")
+    names = match(query.getFunctionals(), fields[1], fields[2]);
+  else
+    throw Exception("Campo sin indice: " + field);
+
+  string result{"Resultados: " + to_string(names.size())};
+  for (const string &e : names)
+    result += "\n" + e;
+  return result;
+}
+
+void Batch::setQuiet(const bool &e)
+{
+  quiet = e;
+}
+
+void Batch::setJournal(Journal *e)
+{
+  journal = e;
+}
+
+// Commands run with the model they ran on selected; the other records go to the model itself, as they were recorded
+void Batch::replay(const Journal::Record &record)
+{
+  if (record.kind != 'C')
+  {
+    Journal::apply(modelList, record);
+    return;
+  }
+  current = record.model.empty() ? nullptr : findModel(record.model);
+  if (!record.model.empty() and current == nullptr)
+    throw Exception("Modelo no encontrado: " + record.model);
+  execute(record.value);
+}
+
+long Batch::recover(Journal &e)
+{
+  long before{operations};
+  journal = nullptr;
+  long records{e.recover([this](const Journal::Record &record) { replay(record); })};
+  current = nullptr;
+  operations = before;
+  journal = &e;
+  Model::removeRecorder(&e);
+  Model::addRecorder(&Journal::record, &e);
+  return records;
+}
+
+string Batch::execute(const string &line)
+{
+  string command{trim(line)};
+
+  if (command.empty() or command[0] == '#')
+    return "";
+
+  string::size_type space{command.find_first_of(" \t")};
+  string verb{command.substr(0, space)};
+  string rest{space == string::npos ? "" : trim(command.substr(space))};
+  string first{rest.substr(0, rest.find_first_of(" \t"))};
+  string result;
+
+  // Batches sharing a model list run concurrently. Whatever changes the list of models or reads all of them holds
+  // it exclusively; the rest shares it and locks the current model, shared to read and exclusive to change it
+  bool entityVerb{verb == "add" or verb == "list" or verb == "search" or verb == "edit" or verb == "remove" or verb == "sort" or verb == "query"};
+  bool entityPart{entityVerb and (first == "reaction" or first == "metabolite" or first == "gen")};
+  bool compact{journal != nullptr and journal->isFull()};
+  bool catalogWrite{compact or verb == "clone" or verb == "load" or verb == "save" or verb == "restore" or verb == "import" or (entityVerb and first == "model")};
+  bool modelWrite{(entityPart and verb != "list" and verb != "search" and verb != "query") or (verb == "bounds" and !first.empty() and !isdigit(static_cast<unsigned char>(first[0])))};
+  bool modelRead{!modelWrite and (entityPart or verb == "matrix" or verb == "summary" or verb == "fba" or verb == "fva" or verb == "knockout" or verb == "bounds" or verb == "export")};
+
+  shared_lock<shared_mutex> catalogShared(modelList.getMutex(), defer_lock);
+  unique_lock<shared_mutex> catalogUnique(modelList.getMutex(), defer_lock);
+  shared_lock<shared_mutex> modelShared;
+  unique_lock<shared_mutex> modelUnique;
+  if (catalogWrite)
+    catalogUnique.lock();
+  else
+    catalogShared.lock();
+  if (modelWrite)
+    modelUnique = unique_lock<shared_mutex>(currentModel().getMutex());
+  else if (modelRead)
+    modelShared = shared_lock<shared_mutex>(currentModel().getMutex());
+
+  // Edits record themselves through the model. Other changes are recorded as the command with the model it ran on,
+  // once they succeeded; loads are too big for the log and checkpoint instead
+  if (compact)
+    journal->checkpoint();
+  bool logged{journal != nullptr and (verb == "add" or verb == "remove" or verb == "sort" or verb == "clone" or (verb == "bounds" and modelWrite))};
+  string context{logged and (entityPart or verb == "clone" or verb == "bounds") ? currentModel().getName() : ""};
+
+  if (verb == "use")
+  {
+    if ((current = findModel(rest)) == nullptr)
     {
-      stringMetabolites += "\n" + auxNodeMetabolite->getDataPtr()->toString();
+      throw Exception("Modelo no encontrado: " + rest);
     }
-    cout << "\n1. Ingresar otro\n";
-    cout << "2. Crear metabolito\n";
-    cout << "3. Salir\n";
-    cin >> intAux;
-    if (intAux == 2) {
-      insertMetabolite();
-      stringMetabolites += "\n" + metaboliteList.getLast()->getDataPtr()->toString();
+    result = "Modelo actual: " + rest;
+  }
+  else if (verb == "clone")
+  {
+    if (rest.empty())
+      throw Exception("Falta el nombre del clon");
+    if (findModel(rest) != nullptr)
+      throw Exception("Ya existe el modelo: " + rest);
+    Model clone{currentModel()};
+    clone.setName(rest);
+    current = modelList.insertUnchecked(clone, modelList.back());
+    result = "Modelo actual: " + rest;
+  }
+  else if (verb == "matrix")
+  {
+    auto start{chrono::steady_clock::now()};
+    StoichiometricMatrix matrix{currentModel().getStoichiometricMatrix()};
+    result = "Matriz estequiometrica: " + to_string(matrix.getRows()) + " x " + to_string(matrix.getColumns()) + ", " + to_string(matrix.getNonZeros()) + " no nulos, " +
+             to_string(matrix.getBytes()) + " bytes, " + to_string(matrix.getUnresolved()) + " sin resolver, " +
+             to_string(chrono::duration<double>(chrono::steady_clock::now() - start).count()) + " s";
+  }
+  else if (verb == "summary")
+  {
+    const Model &model{currentModel()};
+    const DerivedData &derived{model.getDerivedData()};
+    const set<int> &deadEnds{derived.getDeadEnds()};
+
+    result = "Reacciones: " + to_string(model.getNumberOfReactions()) + ", metabolitos: " + to_string(model.getNumberOfMetabolites()) + ", genes: " + to_string(model.getNumberOfGens());
+    result += "\nMetabolitos por compartimiento:";
+    for (const pair<string, int> &e : derived.getCompartmentCounts())
+      result += " " + (e.first.empty() ? string("(ninguno)") : e.first) + " " + to_string(e.second);
+    result += "\nMetabolitos sin salida: " + to_string(deadEnds.size());
+    for (auto i{deadEnds.begin()}; i != deadEnds.end(); ++i)
+      result += (i == deadEnds.begin() ? ", ids: " : " ") + to_string(*i);
+  }
+  else if (verb == "fba")
+  {
+    FluxBalance fba(currentModel());
+    fba.solve();
+    result = fba.toString();
+    if (fba.getSimplex().getStatus() == Simplex::OPTIMAL)
+    {
+      vector<double> flux{fba.getFlux()};
+      for (int j{0}; j < fba.getMatrix().getColumns(); j++)
+      {
+        if (fabs(flux[j]) > 1e-9)
+          result += "\n" + fba.getMatrix().getReaction(j)->getDataPtr()->getName() + ": " + SbmlWriter::formatNumber(flux[j]);
+      }
+    }
+  }
+  else if (verb == "fva")
+  {
+    vector<string> words{split(rest, ' ')};
+    double fraction{words[0].empty() ? 1 : toDouble(words[0])};
+    ThreadPool pool(words.size() < 2 ? 0 : toInt(words[1]));
+    FluxVariability fva(currentModel(), fraction);
+    fva.solve(pool);
+    result = fva.toString();
+    for (int j{0}; j < fva.getColumns(); j++)
+    {
+      result += "\n" + fva.getReaction(j)->getDataPtr()->getName() + ": " + SbmlWriter::formatNumber(fva.getMinimum(j)) + " " + SbmlWriter::formatNumber(fva.getMaximum(j));
+    }
+  }
+  else if (verb == "knockout")
+  {
+    vector<string> words{split(rest, ' ')};
+    if (words[0] != "simple" and words[0] != "doble")
+      throw Exception("Uso: knockout simple|doble [hilos]");
+    ThreadPool pool(words.size() < 2 ? 0 : toInt(words[1]));
+    Knockout knockout(currentModel());
+    if (words[0] == "simple")
+      knockout.single(pool);
+    else
+      knockout.pairs(pool);
+    result = knockout.toString();
+    for (const Knockout::Deletion &e : knockout.getDeletions())
+    {
+      if (e.status == Simplex::OPTIMAL and fabs(e.objective - knockout.getWildType()) <= 1e-9 * max(1.0, fabs(knockout.getWildType())))
+        continue;
+      result += "\n" + knockout.getGene(e.first) + (e.second < 0 ? "" : " " + knockout.getGene(e.second)) + ": " +
+                (e.status == Simplex::OPTIMAL ? SbmlWriter::formatNumber(e.objective) : Simplex::toString(e.status)) + (knockout.isLethal(e) ? " (letal)" : "");
     }
-  } while ((intAux != 3 or stringMetabolites == "") or (intAux == 3 and stringMetabolites == ""));
+  }
+  else if (verb == "bounds")
+  {
+    vector<string> words{split(rest, ' ')};
+    ReactionTable table(static_cast<const Model &>(currentModel()).getReactionList());
 
-  reactionAux.setMetabolites(stringMetabolites);
+    if (words[0].empty() or isdigit(static_cast<unsigned char>(words[0][0])))
+    {
+      vector<int> inverted{table.findInverted()};
+      result = "Limites invertidos: " + to_string(inverted.size());
+      for (size_t i{0}; i < inverted.size(); i++)
+        result += (i == 0 ? ", ids: " : " ") + to_string(inverted[i]);
+      result += "\nLimites abiertos: " + to_string(table.countOpen(words[0].empty() ? 1000 : toInt(words[0])));
+    }
+    else
+    {
+      if (words[0] == "clamp" and words.size() == 3)
+        table.clamp(toInt(words[1]), toInt(words[2]));
+      else if (words[0] == "scale" and words.size() == 2)
+        table.scale(toDouble(words[1]));
+      else if (words[0] == "orient" and words.size() == 1)
+        table.applyStoichiometry();
+      else
+        throw Exception("Uso: bounds [infinito] | clamp <min> <max> | scale <factor> | orient");
 
-  try
+      table.writeBounds(currentModel().getReactionList());
+      result = "Reacciones actualizadas: " + to_string(table.size());
+    }
+  }
+  else if (verb == "load")
   {
-    reactionList.insert(reactionAux, reactionList.getLast());
-    numberOfReactions++;
-    return reactionList.getLast();
+    ThreadPool pool;
+    ParallelLoader loader(modelList, pool);
+    loader.load(rest);
+    current = modelList.getLast();
+    operations += loader.getRecords();
+    if (journal != nullptr)
+      journal->checkpoint();
+    return "Registros cargados: " + to_string(loader.getRecords());
   }
-  catch (List<Reaction>::Exception ex)
+  else if (verb == "save")
   {
-    ex.what();
-    return nullptr;
+    Snapshot::save(modelList, rest);
+    result = "Snapshot guardado: " + rest;
   }
-}
+  else if (verb == "restore")
+  {
+    Snapshot snapshot;
+    auto start{chrono::steady_clock::now()};
+    snapshot.open(rest);
+    snapshot.load(modelList);
+    current = modelList.getLast();
+    result = "Snapshot cargado: " + to_string(snapshot.getModelCount()) + " modelos en " + to_string(chrono::duration<double>(chrono::steady_clock::now() - start).count()) + " s";
+  }
+  else if (verb == "bench")
+  {
+    vector<string> words{split(rest, ' ')};
+    vector<int> args;
+    for (size_t i{1}; i < words.size(); i++)
+    {
+      args.push_back(toInt(words[i]));
+    }
+    result = Bench::run(words[0], args);
+  }
+  else if (verb == "import" or verb == "export")
+  {
+    auto start{chrono::steady_clock::now()};
+    double megabytes;
 
-void Model::insertMetabolite()
-{
-  cout << "Id: ";
-  cin >> intAux;
-  metaboliteAux.setId(intAux);
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  metaboliteAux.setName(stringAux);
-  cout << "Formula quimica: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  metaboliteAux.setChemicalForm(stringAux);
-  cout << "Compartimiento: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  metaboliteAux.setCompartment(stringAux);
+    if (verb == "import")
+    {
+      ifstream file(rest, ios::binary);
+      if (!file)
+        throw Exception("No se pudo abrir " + rest);
+      Node<Model> *before{modelList.getLast()};
+      megabytes = SbmlReader(modelList).read(file) / 1048576.0;
+      if (modelList.getLast() == before)
+        throw Exception("No se encontro un modelo SBML en " + rest);
+      current = modelList.getLast();
+    }
+    else
+    {
+      const Model &model{currentModel()};
+      ofstream file(rest, ios::binary);
+      if (!file)
+        throw Exception("No se pudo crear " + rest);
+      SbmlWriter(file).write(model);
+      megabytes = file.tellp() / 1048576.0;
+    }
 
-  try
-  {
-    metaboliteList.insert(metaboliteAux, metaboliteList.getLast());
-    numberOfMetabolites++;
+    double elapsed{chrono::duration<double>(chrono::steady_clock::now() - start).count()};
+    result = (verb == "import" ? "Importado: " : "Exportado: ") + to_string(megabytes) + " MB en " + to_string(elapsed) + " s (" + to_string(elapsed > 0 ? megabytes / elapsed : 0.0) + " MB/s)";
   }
-  catch (List<Metabolite>::Exception ex)
+  else
   {
-    ex.what();
+    space = rest.find_first_of(" \t");
+    int entity{toEntity(rest.substr(0, space))};
+    string args{space == string::npos ? "" : trim(rest.substr(space))};
+
+    if (verb == "add")
+      result = add(entity, split(args, '|'));
+    else if (verb == "list")
+      result = list(entity);
+    else if (verb == "search")
+      result = search(entity, args);
+    else if (verb == "edit")
+      result = edit(entity, split(args, '|'));
+    else if (verb == "remove")
+      result = remove(entity, args);
+    else if (verb == "sort")
+      result = sort(entity);
+    else if (verb == "query")
+      result = query(entity, split(args, '|'));
+    else
+      throw Exception("Comando desconocido: " + verb);
   }
+
+  if (journal != nullptr and (verb == "restore" or verb == "import"))
+    journal->checkpoint();
+  else if (logged)
+    journal->log(Journal::Record{'C', context, 0, "", 0, command});
+
+  operations++;
+  return result;
 }
 
-Node<Gen> *Model::insertGen()
+void Batch::run(istream &input)
 {
-  cout << "Id: ";
-  cin >> intAux;
-  genAux.setId(intAux);
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  genAux.setName(stringAux);
-  cout << "Funcional: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  genAux.setFunctional(stringAux);
+  string line;
+  string result;
+  long lineNumber{0};
+  auto start{chrono::steady_clock::now()};
 
-  try
+  while (getline(input, line))
   {
-    genList.insert(genAux, genList.getLast());
-    return genList.getLast();
+    lineNumber++;
+    try
+    {
+      result = execute(line);
+      if (!quiet and !result.empty())
+      {
+        cout << result << endl;
+      }
+    }
+    catch (std::exception &ex)
+    {
+      failures++;
+      cerr << "Linea " << lineNumber << ": " << ex.what() << endl;
+    }
   }
-  catch (List<Reaction>::Exception ex)
+
+  seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int Batch::run(int argc, char const *argv[])
+{
+  for (int i{1}; i < argc; i++)
   {
-    ex.what();
-    return nullptr;
+    string flag{argv[i]};
+
+    if (flag == "-q")
+    {
+      setQuiet(true);
+    }
+    else if (flag == "-f" and i + 1 < argc)
+    {
+      string fileName{argv[++i]};
+      if (fileName == "-")
+      {
+        run(cin);
+        continue;
+      }
+      ifstream file(fileName);
+      if (!file)
+      {
+        cerr << "No se pudo abrir " << fileName << endl;
+        return 1;
+      }
+      run(file);
+    }
+    else if (flag == "-e" and i + 1 < argc)
+    {
+      istringstream commands(argv[++i]);
+      run(commands);
+    }
+    else if (flag == "-j" and i + 1 < argc and ownedJournal == nullptr)
+    {
+      try
+      {
+        ownedJournal.reset(new Journal(modelList));
+        ownedJournal->open(argv[++i]);
+        long records{recover(*ownedJournal)};
+        if (!quiet)
+          cout << "Bitacora: " << records << " registros recuperados, " << ownedJournal->getFailures() << " fallidos, " << ownedJournal->getTruncated() << " bytes cortados" << endl;
+        if (ownedJournal->getFailures() > 0)
+          cerr << ownedJournal->getFailure() << endl;
+      }
+      catch (std::exception &ex)
+      {
+        cerr << ex.what() << endl;
+        return 1;
+      }
+    }
+    else
+    {
+      cerr << "Uso: " << argv[0] << " [-q] [-j <bitacora>] [-f <archivo|->] [-e <comando>]...\n";
+      return 1;
+    }
+  }
+
+  // A clean exit leaves everything in the checkpoint and an empty log
+  if (ownedJournal != nullptr)
+  {
+    unique_lock<shared_mutex> guard(modelList.getMutex());
+    try
+    {
+      ownedJournal->checkpoint();
+    }
+    catch (Journal::Exception &ex)
+    {
+      cerr << ex.what() << endl;
+      failures++;
+    }
   }
+
+  cout << report();
+  return failures == 0 ? 0 : 1;
 }
 
-void Model::editReaction()
+string Batch::report() const
 {
-  Node<Reaction> *auxNodeReaction{nullptr};
-  auxNodeReaction = searchReaction();
-  if (auxNodeReaction == nullptr)
-    return;
+  string result{""};
+  result += "\nOperaciones: " + to_string(operations);
+  result += "\nErrores: " + to_string(failures);
+  result += "\nTiempo: " + to_string(seconds) + " s";
+  result += "\nOperaciones/seg: " + to_string(seconds > 0 ? operations / seconds : 0.0);
+  return result + '\n';
+}
 
-  cout << "\nEditar:\n";
-  cout << "1.Id\n";
-  cout << "2.Nombre\n";
-  cout << "3.Estequiometria\n";
-  cout << "4.Limite inferior\n";
-  cout << "5.Limite superior\n";
+//* -------- ------- ------ ----- Servidor ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
 
-  int option{0};
-  cin >> option;
+// Keeps the models resident and answers Batch commands over TCP ("[host:]puerto") or a Unix socket ("unix:<ruta>").
+// Every line is one request and gets "OK <n>" followed by the n lines of its result, or "ERR <mensaje>". Each
+// connection has its own Batch, so "use" only changes the model of that connection. Requests may be pipelined: the
+// responses to everything read in one pass go back in a single write, after one journal commit for all of their
+// changes made once Batch let go of its locks. One thread serves every connection with epoll, Batch takes the locks
+// of what it touches
 
-  switch (option)
+// -------- ------- ------ ----- Definition ----- ------ ------- --------
+class Server
+{
+private:
+  struct Connection
   {
-  case 1:
-  cout << "Id: ";
-  cin >> intAux;
-  auxNodeReaction->getDataPtr()->setId(intAux);
-    break;
-  case 2:
-  cout << "Nombre: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  auxNodeReaction->getDataPtr()->setName(stringAux);
-    break;
-  case 3:
-  cout << "Estequiometria: \n";
-  cout << "1. ->\n";
-  cout << "2. <-\n";
-  cout << "3. <->\n";
-  cin >> intAux;
-  if (intAux == 1)
+    int fd;
+    Batch batch;
+    string input;
+    string output;
+    size_t sent;
+    uint32_t events;
+    bool closing;
+
+    Connection(const int &, List<Model> &, Journal *);
+  };
+
+  static const size_t maximumLine{1 << 20};
+  static const size_t maximumPending{4 << 20}; //unsent bytes before the connection stops being read
+  static const set<string> verbs; //what clients may run, nothing that touches files or runs benches
+
+  List<Model> &modelList;
+  Journal *journal;
+  int listener;
+  int poll;
+  int wake;
+  string path;
+  long connections;
+  long requests;
+  unordered_map<int, unique_ptr<Connection>> clients;
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+  void accept();
+  void receive(Connection &);
+  void respond(Connection &, const string &);
+  void flush(Connection &);
+  void watch(Connection &);
+  void close(Connection &);
+
+#ifdef __linux__
+  static socklen_t resolve(const string &, sockaddr_storage &);
+#endif
+
+public:
+  class Exception : public std::exception
   {
-    stringAux = "->";
-  }
-  else if (intAux == 2)
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  Server(List<Model> &, Journal * = nullptr); //changes are recorded to the journal when there is one
+  ~Server();
+
+  void open(const string &);
+  void run();
+  void stop(); //from any thread
+
+  long getConnections() const;
+  long getRequests() const;
+
+  static int connectTo(const string &);
+};
+
+// Opens connections to a server and sends a mix of commands, a window of them at a time on each connection, timing
+// every request from the write of its window to the end of its response
+class LoadGenerator
+{
+private:
+  string address;
+  int connections;
+  long requests; //per connection
+  int depth;
+  vector<double> latencies;
+  long errors;
+  double seconds;
+
+  void session(const int &, const vector<string> &, const vector<string> &, vector<double> &, long &) const;
+
+public:
+  class Exception : public std::exception
   {
-    stringAux = "<-";
-  }
-  else
+  private:
+    std::string msg;
+
+  public:
+    explicit Exception(const char *message) : msg(message) {}
+
+    explicit Exception(const std::string &message) : msg(message) {}
+
+    virtual ~Exception() throw() {}
+
+    virtual const char *what() const throw()
+    {
+      return msg.c_str();
+    }
+  };
+
+  LoadGenerator(const string &, const int &, const long &, const int &);
+
+  void run(const vector<string> &, const vector<string> &); //setup sent once per connection, then the mix
+
+  double getPercentile(const double &) const;
+  double getRequestsPerSecond() const;
+  long getErrors() const;
+
+  string toString() const;
+};
+
+// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+
+Server::Connection::Connection(const int &e, List<Model> &modelList, Journal *journal) : fd(e), batch(modelList), sent(0), events(0), closing(false)
+{
+  batch.setJournal(journal);
+}
+
+Server::Server(List<Model> &e, Journal *j) : modelList(e), journal(j), listener(-1), poll(-1), wake(-1), path(""), connections(0), requests(0) {}
+
+long Server::getConnections() const
+{
+  return connections;
+}
+
+long Server::getRequests() const
+{
+  return requests;
+}
+
+const set<string> Server::verbs{"use", "list", "search", "add", "edit", "remove", "sort", "query", "matrix", "summary", "fba", "fva", "knockout", "bounds"};
+
+void Server::respond(Connection &connection, const string &line)
+{
+  try
   {
-    stringAux = "<->";
+    string::size_type start{line.find_first_not_of(" \t\r")};
+    string verb{start == string::npos ? "" : line.substr(start, line.find_first_of(" \t\r", start) - start)};
+    if (!verb.empty() and verb[0] != '#' and verbs.count(verb) == 0)
+      throw Exception("Comando no permitido: " + verb);
+
+    string result{connection.batch.execute(line)};
+    if (result.empty())
+    {
+      connection.output += "OK 0\n";
+    }
+    else
+    {
+      connection.output += "OK " + to_string(count(result.begin(), result.end(), '\n') + 1) + "\n" + result + "\n";
+    }
   }
-  auxNodeReaction->getDataPtr()->setStoichiometry(stringAux);
-    break;
-  case 4:
-  cout << "Limite inferior: ";
-  cin >> intAux;
-  auxNodeReaction->getDataPtr()->setLowerLimit(intAux);
-    break;
-  case 5:
-  cout << "Limite superior: ";
-  cin >> intAux;
-  auxNodeReaction->getDataPtr()->setHigherLimit(intAux);
-    break;
-  default:
-    break;
+  catch (std::exception &ex)
+  {
+    string message{ex.what()};
+    replace(message.begin(), message.end(), '\n', ' ');
+    connection.output += "ERR " + message + "\n";
   }
+  requests++;
 }
 
-void Model::editMetabolite()
-{
-  Node<Metabolite> *auxNodeMetabolite{nullptr};
-  auxNodeMetabolite = searchMetabolite();
-  if (auxNodeMetabolite == nullptr)
-    return;
+#ifdef __linux__
 
-  cout << "\nEditar:\n";
-  cout << "1.Id\n";
-  cout << "2.Nombre\n";
-  cout << "3.Formula quimica\n";
-  cout << "4.Compartimento\n";
+Server::~Server()
+{
+  for (pair<const int, unique_ptr<Connection>> &e : clients)
+    ::close(e.first);
+  clients.clear();
+  if (listener >= 0)
+    ::close(listener);
+  if (poll >= 0)
+    ::close(poll);
+  if (wake >= 0)
+    ::close(wake);
+  if (!path.empty())
+    unlink(path.c_str());
+}
 
-  int option{0};
-  cin >> option;
+// Fills the address of "unix:<ruta>", "host:puerto" or "puerto"; the host is numeric IPv4 or localhost
+socklen_t Server::resolve(const string &address, sockaddr_storage &storage)
+{
+  memset(&storage, 0, sizeof(storage));
 
-  switch (option)
+  if (address.compare(0, 5, "unix:") == 0)
   {
-  case 1:
-    cout << "Id: ";
-    cin >> intAux;
-    auxNodeMetabolite->getDataPtr()->setId(intAux);
-    break;
-  case 2:
-    cout << "Nombre: ";
-    cin.ignore();
-    getline(cin, stringAux);
-    auxNodeMetabolite->getDataPtr()->setName(stringAux);
-    break;
-  case 3:
-    cout << "Formula quimica: ";
-    cin.ignore();
-    getline(cin, stringAux);
-    auxNodeMetabolite->getDataPtr()->setChemicalForm(stringAux);
-    break;
-  case 4:
-    cout << "Compartimiento: ";
-    cin.ignore();
-    getline(cin, stringAux);
-    auxNodeMetabolite->getDataPtr()->setCompartment(stringAux);
-    break;
-  default:
-    break;
+    sockaddr_un &unixAddress{*reinterpret_cast<sockaddr_un *>(&storage)};
+    string file{address.substr(5)};
+    if (file.empty() or file.size() >= sizeof(unixAddress.sun_path))
+      throw Exception("Ruta de socket invalida: " + file);
+    unixAddress.sun_family = AF_UNIX;
+    memcpy(unixAddress.sun_path, file.c_str(), file.size() + 1);
+    return sizeof(sockaddr_un);
   }
+
+  sockaddr_in &inetAddress{*reinterpret_cast<sockaddr_in *>(&storage)};
+  string::size_type colon{address.rfind(':')};
+  string host{colon == string::npos ? "127.0.0.1" : address.substr(0, colon)};
+  string port{colon == string::npos ? address : address.substr(colon + 1)};
+  char *end{nullptr};
+  long number{strtol(port.c_str(), &end, 10)};
+
+  if (port.empty() or *end != '\0' or number < 0 or number > 65535)
+    throw Exception("Puerto invalido: " + port);
+  if (host.empty() or host == "localhost")
+    host = "127.0.0.1";
+  inetAddress.sin_family = AF_INET;
+  inetAddress.sin_port = htons(uint16_t(number));
+  if (inet_pton(AF_INET, host.c_str(), &inetAddress.sin_addr) != 1)
+    throw Exception("Direccion invalida: " + host);
+  return sizeof(sockaddr_in);
 }
 
-void Model::editGen()
+void Server::open(const string &address)
 {
-  Node<Gen> *auxNodeGen{nullptr};
-  auxNodeGen = searchGen();
-  if (auxNodeGen == nullptr)
-    return;
+  sockaddr_storage storage;
+  socklen_t length{resolve(address, storage)};
+  int yes{1};
 
-  cout << "\nEditar:\n";
-  cout << "1.Id\n";
-  cout << "2.Nombre\n";
-  cout << "3.Funcional\n";
+  if (listener >= 0)
+    throw Exception("El servidor ya esta abierto");
 
-  int option{0};
-  cin >> option;
+  listener = socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listener < 0)
+    throw Exception("No se pudo crear el socket: " + string(strerror(errno)));
 
-  switch (option)
+  if (storage.ss_family == AF_UNIX)
   {
-  case 1:
-    cout << "Id: ";
-    cin >> intAux;
-    auxNodeGen->getDataPtr()->setId(intAux);
-    break;
-  case 2:
-    cout << "Nombre: ";
-    cin.ignore();
-    getline(cin, stringAux);
-    auxNodeGen->getDataPtr()->setName(stringAux);
-    break;
-  case 3:
-    cout << "Funcional: ";
-    cin.ignore();
-    getline(cin, stringAux);
-    auxNodeGen->getDataPtr()->setFunctional(stringAux);
-    break;
-  default:
-    break;
+    path = reinterpret_cast<sockaddr_un *>(&storage)->sun_path;
+    unlink(path.c_str());
   }
+  else
+  {
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  }
+
+  if (bind(listener, reinterpret_cast<sockaddr *>(&storage), length) < 0 or listen(listener, SOMAXCONN) < 0)
+    throw Exception("No se pudo escuchar en " + address + ": " + strerror(errno));
+
+  poll = epoll_create1(EPOLL_CLOEXEC);
+  wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (poll < 0 or wake < 0)
+    throw Exception("No se pudo crear epoll: " + string(strerror(errno)));
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = listener;
+  epoll_ctl(poll, EPOLL_CTL_ADD, listener, &event);
+  event.data.fd = wake;
+  epoll_ctl(poll, EPOLL_CTL_ADD, wake, &event);
 }
 
-void Model::chooseList()
+void Server::stop()
 {
-  int objectOption{0};
-  int option{0};
-  string stringAux{""};
-  Node<Reaction> *auxNodeReaction{nullptr};
-  Node<Metabolite> *auxNodeMetabolite{nullptr};
-  Node<Gen> *auxNodeGen{nullptr};
+  uint64_t one{1};
+  if (wake >= 0 and write(wake, &one, sizeof(one)) < 0)
+    return;
+}
 
-  do
+void Server::run()
+{
+  epoll_event events[64];
+
+  if (poll < 0)
+    throw Exception("El servidor no esta abierto");
+
+  for (;;)
   {
-    cout << "\n0.Salir\n";
-    cout << "\n1.Reacciones\n";
-    cout << "\n2.Metabolitos\n";
-    cout << "\n3.Genes\n";
-    cin >> objectOption;
+    int ready{epoll_wait(poll, events, 64, -1)};
+    if (ready < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      throw Exception("epoll: " + string(strerror(errno)));
+    }
 
-    do
+    for (int i{0}; i < ready; i++)
     {
-      option = optionList();
+      int fd{events[i].data.fd};
 
-      switch (option)
+      if (fd == wake)
+        return;
+      if (fd == listener)
       {
-      case 1:
-        cout << "\n1.-------- ------- ------ ----- Agregar ----- ------ ------- -------- \n";
-        if (objectOption == 1 or objectOption == 3)
-        {
-          stringAux = "";
-          cout << "\nGen\n\n";
-          auxNodeGen = insertGen();
-          stringAux += auxNodeGen->getDataPtr()->getName();
-          cout << "\nReaccion\n\n";
-          auxNodeReaction = insertReaction();
-          stringAux += "-" + auxNodeReaction->getDataPtr()->getName();
-          auxNodeReaction->getDataPtr()->setGenReaction(stringAux);
-          auxNodeGen->getDataPtr()->setGenReaction(stringAux);
-        }
-        else
-        {
-          insertMetabolite();
-        }
-        break;
-      case 2:
-        cout << "\n2.-------- ------- ------ ----- Acceder ----- ------ ------- --------\n";
-        cout << "\nExistentes: \n";
-        if (objectOption == 1)
-        {
-          cout << reactionList.toString() << endl;
-        }
-        else if (objectOption == 2)
-        {
-          cout << metaboliteList.toString() << endl;
-        }
-        else
-        {
-          cout << genList.toString() << endl;
-        }
-        break;
-      case 3:
-        cout << "\n3.-------- ------- ------ ----- Buscar ----- ------ ------- -------- \n";
-        if (objectOption == 1)
-        {
-          auxNodeReaction = searchReaction();
-          if (auxNodeReaction != nullptr)
-          {
-            cout << "\nDato encontrado: " << auxNodeReaction << endl;
-            cout << auxNodeReaction->getDataPtr()->toString() << endl;
-          }
-        }
-        else if (objectOption == 2)
-        {
-          auxNodeMetabolite = searchMetabolite();
-          if (auxNodeMetabolite != nullptr)
-          {
-            cout << "\nDato encontrado: " << auxNodeMetabolite << endl;
-            cout << auxNodeMetabolite->getDataPtr()->toString() << endl;
-          }
-        }
-        else
-        {
-          auxNodeGen = searchGen();
-          if (auxNodeGen != nullptr)
-          {
-            cout << "\nDato encontrado: " << auxNodeGen << endl;
-            cout << auxNodeGen->getDataPtr()->toString() << endl;
-          }
-        }
-        break;
-      case 4:
-        cout << "\n4.-------- ------- ------ ----- Editar ----- ------ ------- -------- \n";
-        if (objectOption == 1)
-        {
-          editReaction();
-        }
-        else if (objectOption == 2)
-        {
-          editMetabolite();
-        }
-        else
-        {
-          editGen();
-        }
-        break;
-      case 5:
-        cout << "\n5.-------- ------- ------ ----- Eliminar ----- ------ ------- -------- \n";
-        try
-        {
-          if (objectOption == 1)
-          {
-            auxNodeReaction = searchReaction();
-            reactionList.remove(auxNodeReaction);
-          }
-          else if (objectOption == 2)
-          {
-            auxNodeMetabolite = searchMetabolite();
-            metaboliteList.remove(auxNodeMetabolite);
-          }
-          else
-          {
-            auxNodeGen = searchGen();
-            genList.remove(auxNodeGen);
-          }
-          cout << "\nElemento eliminado\n";
-        }
-        catch (List<Model>::Exception ex)
-        {
-          ex.what();
-        }
-        break;
-      case 6:
-        cout << "\n6.-------- ------- ------ ----- Ordenar ----- ------ ------- --------\n";
-        if (objectOption == 1)
-        {
-          reactionList.bubbleSort();
-        }
-        else if (objectOption == 2)
-        {
-          metaboliteList.bubbleSort();
-        }
-        else
-        {
-          genList.bubbleSort();
-        }
-        cout << "\nElementos ordenados\n";
-        break;
-      default:
-        break;
+        accept();
+        continue;
       }
-    } while (option != 0);
-  } while (objectOption != 0);
+
+      auto found{clients.find(fd)};
+      if (found == clients.end())
+        continue;
+      Connection &connection{*found->second};
+
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        receive(connection);
+      if (clients.count(fd) != 0 and (events[i].events & EPOLLOUT))
+        flush(connection);
+    }
+  }
 }
 
-bool Model::operator==(const Model &e) const
+void Server::accept()
 {
-  return name == e.name;
+  int fd;
+  int yes{1};
+
+  while ((fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+  {
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)); //fails harmlessly on Unix sockets
+    Connection &connection{*(clients[fd] = unique_ptr<Connection>(new Connection(fd, modelList, journal)))};
+    connections++;
+    watch(connection);
+  }
 }
 
-bool Model::operator>(const Model &e) const
+// Reads everything available and answers every complete line; what is left waits for the rest of its line
+void Server::receive(Connection &connection)
 {
-  return name > e.name;
-}
+  char buffer[65536];
+  ssize_t bytes;
+  bool ended{false};
+
+  while ((bytes = read(connection.fd, buffer, sizeof(buffer))) != 0)
+  {
+    if (bytes < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      ended = errno != EAGAIN and errno != EWOULDBLOCK;
+      break;
+    }
+    connection.input.append(buffer, size_t(bytes));
+    if (connection.output.size() - connection.sent >= maximumPending)
+      break;
+  }
+  ended = ended or bytes == 0;
+
+  string::size_type begin{0}, end;
+  size_t mark{connection.output.size()};
+  long answered{0};
+  bool quit{false};
+  if (journal != nullptr)
+    journal->beginGroup();
+  while (!connection.closing and (end = connection.input.find('\n', begin)) != string::npos)
+  {
+    string line{connection.input, begin, end - begin};
+    begin = end + 1;
+    if (!line.empty() and line.back() == '\r')
+      line.pop_back();
+    if (line == "quit")
+    {
+      connection.closing = quit = true;
+    }
+    else
+    {
+      respond(connection, line);
+      answered++;
+    }
+  }
+  connection.input.erase(0, begin);
+
+  // Nothing of the pass is acknowledged unless its changes are on disk
+  if (journal != nullptr)
+  {
+    try
+    {
+      journal->commit(journal->endGroup());
+    }
+    catch (std::exception &ex)
+    {
+      string message{ex.what()};
+      replace(message.begin(), message.end(), '\n', ' ');
+      connection.output.erase(mark);
+      for (long i{0}; i < answered; i++)
+        connection.output += "ERR " + message + "\n";
+    }
+  }
+  if (quit)
+    connection.output += "OK 0\n";
+
+  if (connection.input.size() > maximumLine)
+  {
+    connection.output += "ERR Linea demasiado larga\n";
+    connection.closing = true;
+  }
+  if (ended)
+    connection.closing = true;
 
-//* -------- ------- ------ ----- Interface ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
+  flush(connection);
+}
 
-// -------- ------- ------ ----- Definition ----- ------ ------- --------
-class Interface
+void Server::flush(Connection &connection)
 {
-private:
-  int option;
-  Model modelAux;
+  while (connection.sent < connection.output.size())
+  {
+    ssize_t bytes{send(connection.fd, connection.output.data() + connection.sent, connection.output.size() - connection.sent, MSG_NOSIGNAL)};
+    if (bytes < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN or errno == EWOULDBLOCK)
+        break;
+      close(connection);
+      return;
+    }
+    connection.sent += size_t(bytes);
+  }
 
-  Node<Model> *search(List<Model> &);
-  void userInterface(List<Model> &);
-  int optionList();
-  void addModel(List<Model> &);
+  if (connection.sent == connection.output.size())
+  {
+    connection.output.clear();
+    connection.sent = 0;
+    if (connection.closing)
+    {
+      close(connection);
+      return;
+    }
+  }
+  watch(connection);
+}
 
-public:
-  Interface(List<Model> &);
-};
+// Reads while the backlog of responses is small and the connection is open, waits for writing while there is one
+void Server::watch(Connection &connection)
+{
+  size_t pending{connection.output.size() - connection.sent};
+  uint32_t wanted{(connection.closing or pending >= maximumPending ? 0u : uint32_t(EPOLLIN)) | (pending > 0 ? uint32_t(EPOLLOUT) : 0u)};
+  epoll_event event{};
 
-// -------- ------- ------ ----- Implementation ----- ------ ------- --------
+  if (wanted == connection.events and connection.events != 0)
+    return;
+  event.events = wanted;
+  event.data.fd = connection.fd;
+  epoll_ctl(poll, connection.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, connection.fd, &event);
+  connection.events = wanted == 0 ? uint32_t(EPOLLHUP) : wanted; //registered either way, EPOLLHUP is always reported
+}
 
-Interface::Interface(List<Model> &modelList)
+void Server::close(Connection &connection)
 {
-  userInterface(modelList);
+  int fd{connection.fd};
+  epoll_ctl(poll, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  clients.erase(fd);
 }
 
-int Interface::optionList()
+int Server::connectTo(const string &address)
 {
-  int option{0};
-  cout << "\n-------- ------- ------ ----- Modelo Metabolico ----- ------ ------- --------\n";
-  cout << "\n0.Salir\n";
-  cout << "1.Agregar\n";
-  cout << "2.Acceder\n";
-  cout << "3.Buscar\n";
-  cout << "4.Editar\n";
-  cout << "5.Eliminar\n";
-  cout << "6.Ordenar\n";
-  cin >> option;
-  return option;
+  sockaddr_storage storage;
+  socklen_t length{resolve(address, storage)};
+  int yes{1};
+  int fd{socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+
+  if (fd < 0)
+    throw Exception("No se pudo crear el socket: " + string(strerror(errno)));
+  if (connect(fd, reinterpret_cast<sockaddr *>(&storage), length) < 0)
+  {
+    string message{strerror(errno)};
+    ::close(fd);
+    throw Exception("No se pudo conectar a " + address + ": " + message);
+  }
+  if (storage.ss_family == AF_INET)
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+  return fd;
 }
 
-void Interface::addModel(List<Model> &modelList)
-{
-  string stringAux{""};
+#else
 
-  cin.ignore();
-  cout << "\nNombre: ";
-  getline(cin, stringAux);
-  modelAux.setName(stringAux);
+Server::~Server() {}
 
-  // cout << "Agregar Metabolito: ";
-  // cout << "Agregar Reaccion: ";
+void Server::open(const string &)
+{
+  throw Exception("Servidor no disponible en esta plataforma");
+}
 
-  cout << "Expresion Objetivo: ";
-  getline(cin, stringAux);
-  modelAux.setObjetiveExpression(stringAux);
+void Server::run() {}
 
-  cout << "Compartimientos: ";
-  getline(cin, stringAux);
-  modelAux.setCompartments(stringAux);
+void Server::stop() {}
 
-  modelList.insert(modelAux, modelList.getLast()); //insercion despues del punto de interes
+int Server::connectTo(const string &)
+{
+  throw Exception("Servidor no disponible en esta plataforma");
+}
 
-  // cout << modelList.getLast();
+#endif
 
-  // modelList.getLast()->getDataPtr()->setMemoryDirection(modelList.getFirst());
-}
+LoadGenerator::LoadGenerator(const string &e, const int &c, const long &r, const int &d)
+    : address(e), connections(max(1, c)), requests(max(1L, r)), depth(max(1, d)), errors(0), seconds(0) {}
 
-Node<Model> *Interface::search(List<Model> &modelList)
+// One connection: the setup commands one by one, then windows of depth requests written at once
+void LoadGenerator::session(const int &number, const vector<string> &setup, const vector<string> &commands, vector<double> &times, long &failed) const
 {
-  string stringAux{""};
-  Node<Model> *auxNodeModel{nullptr};
-  cout << "Nombre del Modelo: ";
-  cin.ignore();
-  getline(cin, stringAux);
-  modelAux.setName(stringAux);
-  auxNodeModel = modelList.binarySearch(modelAux);
-  if (auxNodeModel == nullptr)
-  {
-    cout << "\nModelo no encontrado...\n";
-  }
-  return auxNodeModel;
-}
+#ifdef __linux__
+  int fd{Server::connectTo(address)};
+  string buffer;
+  string::size_type scanned{0};
+  char chunk[65536];
+
+  // Next line of the response stream, reading more when needed
+  auto nextLine{[&]() {
+    string::size_type end;
+    while ((end = buffer.find('\n', scanned)) == string::npos)
+    {
+      scanned = buffer.size();
+      ssize_t bytes{read(fd, chunk, sizeof(chunk))};
+      if (bytes < 0 and errno == EINTR)
+        continue;
+      if (bytes <= 0)
+        throw Exception("El servidor cerro la conexion");
+      buffer.append(chunk, size_t(bytes));
+    }
+    string line{buffer.substr(0, end)};
+    buffer.erase(0, end + 1);
+    scanned = 0;
+    return line;
+  }};
+
+  // Reads one response, true if it was OK
+  auto response{[&]() {
+    string header{nextLine()};
+    if (header.compare(0, 3, "OK ") != 0)
+      return false;
+    for (long lines{atol(header.c_str() + 3)}; lines > 0; lines--)
+      nextLine();
+    return true;
+  }};
+
+  auto send{[&](const string &text) {
+    for (size_t sent{0}; sent < text.size();)
+    {
+      ssize_t bytes{::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL)};
+      if (bytes < 0 and errno == EINTR)
+        continue;
+      if (bytes < 0)
+        throw Exception("Error al enviar: " + string(strerror(errno)));
+      sent += size_t(bytes);
+    }
+  }};
 
-void Interface::userInterface(List<Model> &modelList)
-{
-  string stringAux{""};
-  Node<Model> *auxNodeModel;
-  cout << "Modelos metabolicos: \n";
-  do
+  try
   {
-    option = optionList();
-    switch (option)
+    for (const string &e : setup)
     {
-    case 1:
-      cout << "\n1.-------- ------- ------ ----- Agregar ----- ------ ------- -------- \n";
-      addModel(modelList);
-      break;
-    case 2:
-      cout << "\n2.-------- ------- ------ ----- Acceder ----- ------ ------- --------\n";
-      cout << "\nModelos Metabolicos Existentes: \n";
-      cout << modelList.toString() << endl;
-      auxNodeModel = search(modelList);
-      if (auxNodeModel != nullptr)
+      send(e + "\n");
+      if (!response())
+        throw Exception("Fallo la preparacion: " + e);
+    }
+
+    times.reserve(size_t(requests));
+    size_t next{size_t(number) % commands.size()};
+    for (long done{0}; done < requests;)
+    {
+      long window{min(long(depth), requests - done)};
+      string text;
+      for (long k{0}; k < window; k++)
       {
-        cout << "\nAcceso correcto: \n";
-        auxNodeModel->getDataPtr()->chooseList();
+        text += commands[next] + "\n";
+        next = next + 1 == commands.size() ? 0 : next + 1;
       }
-      break;
-    case 3:
-      cout << "\n3.-------- ------- ------ ----- Buscar ----- ------ ------- -------- \n";
-      auxNodeModel = search(modelList);
-      if (auxNodeModel != nullptr)
+
+      auto start{chrono::steady_clock::now()};
+      send(text);
+      for (long k{0}; k < window; k++)
       {
-        cout << "\nDato encontrado: " << auxNodeModel << endl;
-        cout << auxNodeModel->getDataPtr()->toString() << endl;
+        if (!response())
+          failed++;
+        times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
       }
-      break;
-    case 4:
-      cout << "\n4.-------- ------- ------ ----- Editar ----- ------ ------- -------- \n";
-      auxNodeModel = search(modelList);
-      cout << "\n4.Editar: \n";
-      cout << "1.Nombre\n";
-      cout << "2.Expresion Objetivo: \n";
-      cout << "3.Compartimentos \n";
-      cin >> option;
+      done += window;
+    }
+    send("quit\n");
+    response();
+  }
+  catch (...)
+  {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+#else
+  (void)number, (void)setup, (void)commands, (void)times, (void)failed;
+  throw Exception("Cliente no disponible en esta plataforma");
+#endif
+}
 
-      cout << "\nNuevo: ";
-      cin.ignore();
-      getline(cin, stringAux);
+void LoadGenerator::run(const vector<string> &setup, const vector<string> &commands)
+{
+  vector<vector<double>> times(connections);
+  vector<long> failed(connections, 0);
+  vector<string> problems(connections);
+  vector<thread> threads;
 
-      if (option == 1)
-      {
-        auxNodeModel->getDataPtr()->setName(stringAux);
-      }
-      else if (option == 2)
-      {
-        auxNodeModel->getDataPtr()->setObjetiveExpression(stringAux);
-      }
-      else
-      {
-        auxNodeModel->getDataPtr()->setCompartments(stringAux);
-      }
+  if (commands.empty())
+    throw Exception("No hay comandos para enviar");
 
-      break;
-    case 5:
-      cout << "\n5.-------- ------- ------ ----- Eliminar ----- ------ ------- -------- \n";
-      auxNodeModel = search(modelList);
+  auto start{chrono::steady_clock::now()};
+  for (int c{0}; c < connections; c++)
+  {
+    threads.emplace_back([&, c]() {
       try
       {
-        modelList.remove(auxNodeModel);
-        cout << "\nElemento eliminado\n";
+        session(c, setup, commands, times[c], failed[c]);
       }
-      catch (List<Model>::Exception ex)
+      catch (std::exception &ex)
       {
-        ex.what();
+        problems[c] = ex.what();
       }
-      break;
-    case 6:
-      cout << "\n6.-------- ------- ------ ----- Ordenar ----- ------ ------- --------\n";
-      modelList.bubbleSort();
-      cout << "\nElementos ordenados\n";
-      break;
-    default:
-      break;
+    });
+  }
+  for (thread &e : threads)
+    e.join();
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  for (const string &e : problems)
+  {
+    if (!e.empty())
+      throw Exception(e);
+  }
+
+  latencies.clear();
+  errors = 0;
+  for (int c{0}; c < connections; c++)
+  {
+    latencies.insert(latencies.end(), times[c].begin(), times[c].end());
+    errors += failed[c];
+  }
+  std::sort(latencies.begin(), latencies.end());
+}
+
+// Nearest rank over the sorted latencies, in seconds
+double LoadGenerator::getPercentile(const double &percent) const
+{
+  if (latencies.empty())
+    return 0;
+  size_t rank{size_t(ceil(percent / 100 * latencies.size()))};
+  return latencies[rank == 0 ? 0 : min(rank, latencies.size()) - 1];
+}
+
+double LoadGenerator::getRequestsPerSecond() const
+{
+  return seconds > 0 ? latencies.size() / seconds : 0.0;
+}
+
+long LoadGenerator::getErrors() const
+{
+  return errors;
+}
+
+string LoadGenerator::toString() const
+{
+  string result{""};
+  result += "\nConexiones: " + to_string(connections) + ", peticiones por conexion: " + to_string(requests) + ", profundidad: " + to_string(depth);
+  result += "\nPeticiones: " + to_string(latencies.size()) + ", errores: " + to_string(errors);
+  result += "\nTiempo: " + to_string(seconds) + " s";
+  result += "\nPeticiones/seg: " + to_string(getRequestsPerSecond());
+  result += "\nLatencia p50: " + to_string(getPercentile(50) * 1e6) + " us, p99: " + to_string(getPercentile(99) * 1e6) + " us";
+  return result;
+}
+
+// A server on a Unix socket in this process over one filled model, loaded with a read-mostly mix at growing depths
+string Bench::server(const int &reactions, const int &connections, const int &requests)
+{
+  string result{""};
+  string address{"unix:bench_server.sock"};
+  List<Model> modelList;
+  Model modelAux;
+
+  modelAux.setName("bench");
+  modelList.insert(modelAux, nullptr);
+  fill(*modelList.getFirst()->getDataPtr(), reactions);
+
+  vector<string> commands;
+  for (int i{0}; i < 16; i++)
+  {
+    string name{"R_" + to_string(i * 7919 % reactions)};
+    commands.push_back("search reaction " + name);
+    commands.push_back("query reaction name|^|R_" + to_string(i * 7 % reactions) + "99");
+    commands.push_back("search gen G_" + to_string(i * 31 % (reactions / 4 + 1)));
+    if (i % 4 == 0)
+      commands.push_back("edit reaction " + name + "|upper|" + to_string(900 + i));
+  }
+
+  Server server(modelList);
+  server.open(address);
+  thread serving(&Server::run, &server);
+
+  try
+  {
+    result += "\nProfundidad | peticiones/seg | p50 (us) | p99 (us) | errores";
+    for (int depth{1}; depth <= 64; depth *= 4)
+    {
+      LoadGenerator generator(address, connections, requests, depth);
+      generator.run({"use bench"}, commands);
+      result += "\n" + to_string(depth) + " | " + to_string(generator.getRequestsPerSecond()) + " | " + to_string(generator.getPercentile(50) * 1e6) + " | " +
+                to_string(generator.getPercentile(99) * 1e6) + " | " + to_string(generator.getErrors());
     }
-  } while (option != 0);
+  }
+  catch (...)
+  {
+    server.stop();
+    serving.join();
+    throw;
+  }
+  server.stop();
+  serving.join();
+
+  result += "\nConexiones atendidas: " + to_string(server.getConnections()) + ", peticiones: " + to_string(server.getRequests());
+  return result;
 }
 
 //* -------- ------- ------ ----- Main ----- ------ ------- ---------------- ------- ------ -----  ----- ------ ------- --------
@@ -1693,6 +13010,122 @@ void Interface::userInterface(List<Model> &modelList)
 int main(int argc, char const *argv[])
 {
   List<Model> modelList;
+  modelList.setIndexed(true);
+
+  string mode{argc > 1 ? argv[1] : ""};
+
+  // -c <direccion> <archivo> [conexiones] [peticiones] [profundidad]: load generator with the commands of the file
+  if (mode == "-c")
+  {
+    vector<string> commands;
+    string line;
+    ifstream file(argc > 3 ? argv[3] : "");
+    while (getline(file, line))
+    {
+      if (!line.empty() and line[0] != '#')
+        commands.push_back(line);
+    }
+    if (argc < 4 or commands.empty())
+    {
+      cerr << "Uso: " << argv[0] << " -c <direccion> <archivo> [conexiones] [peticiones] [profundidad]\n";
+      return 1;
+    }
+    try
+    {
+      LoadGenerator generator(argv[2], argc > 4 ? atoi(argv[4]) : 8, argc > 5 ? atol(argv[5]) : 10000, argc > 6 ? atoi(argv[6]) : 1);
+      generator.run({}, commands);
+      cout << generator.toString() << endl;
+      return generator.getErrors() == 0 ? 0 : 1;
+    }
+    catch (std::exception &ex)
+    {
+      cerr << ex.what() << endl;
+      return 1;
+    }
+  }
+
+  if (argc > 1 and mode != "-s")
+  {
+    Batch batch(modelList);
+    return batch.run(argc, argv);
+  }
+
+  // Changes are kept in data.wal on top of the last checkpoint; data.txt is only read until there is a checkpoint
+  Journal journal(modelList);
+  bool journaled{true};
+  try
+  {
+    journal.open("data");
+  }
+  catch (Journal::Exception &ex)
+  {
+    cerr << ex.what() << endl;
+    journaled = false;
+  }
+
+  if (!journal.hasCheckpoint() and ifstream("data.txt"))
+  {
+    try
+    {
+      ThreadPool pool;
+      ParallelLoader(modelList, pool).load("data.txt");
+    }
+    catch (Loader::Exception &ex)
+    {
+      cerr << ex.what() << endl;
+    }
+  }
+
+  if (journaled)
+  {
+    try
+    {
+      Batch(modelList).recover(journal);
+      if (journal.getFailures() > 0)
+        cerr << journal.getFailure() << endl;
+    }
+    catch (std::exception &ex)
+    {
+      cerr << ex.what() << endl;
+      return 1;
+    }
+  }
+
+  // -s <direccion>: serves the models of data.txt and whatever the clients load, until the process is stopped
+  if (mode == "-s")
+  {
+    if (argc != 3)
+    {
+      cerr << "Uso: " << argv[0] << " -s <[host:]puerto|unix:ruta>\n";
+      return 1;
+    }
+    try
+    {
+      Server server(modelList, journaled ? &journal : nullptr);
+      server.open(argv[2]);
+      cerr << "Escuchando en " << argv[2] << endl;
+      server.run();
+    }
+    catch (std::exception &ex)
+    {
+      cerr << ex.what() << endl;
+      return 1;
+    }
+    return 0;
+  }
+
   Interface myInterface(modelList);
+  if (journaled)
+  {
+    try
+    {
+      journal.checkpoint();
+    }
+    catch (std::exception &ex)
+    {
+      cerr << ex.what() << endl;
+      return 1;
+    }
+  }
   return 0;
 }